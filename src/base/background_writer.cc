@@ -0,0 +1,125 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "background_writer.h"
+#include "exceptions.h"
+#include <cstdio>
+
+
+BackgroundWriter::BackgroundWriter()
+{
+    mStarted = false;
+    mBusy    = false;
+    mQuit    = false;
+    mAppend  = false;
+    mData    = 0;
+    mSize    = 0;
+    pthread_mutex_init(&mMutex, 0);
+    pthread_cond_init(&mCond, 0);
+}
+
+
+BackgroundWriter::~BackgroundWriter()
+{
+    if ( mStarted )
+    {
+        pthread_mutex_lock(&mMutex);
+        mQuit = true;
+        pthread_cond_broadcast(&mCond);
+        pthread_mutex_unlock(&mMutex);
+        pthread_join(mThread, 0);
+    }
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+
+std::string BackgroundWriter::save() const
+{
+    FILE * f = fopen(mPath.c_str(), mAppend ? "ab" : "wb");
+    
+    if ( !f )
+        return "output file `"+mPath+"' could not be opened";
+    
+    std::string err;
+    if ( mSize != fwrite(mData, 1, mSize, f) )
+        err = "failed to write output file `"+mPath+"'";
+    
+    if ( fclose(f) && err.empty() )
+        err = "failed to close output file `"+mPath+"'";
+    
+    return err;
+}
+
+
+/**
+ The pending buffer is always written before the thread terminates
+ */
+void* BackgroundWriter::work(void * arg)
+{
+    BackgroundWriter * w = static_cast<BackgroundWriter*>(arg);
+    
+    pthread_mutex_lock(&w->mMutex);
+    while ( 1 )
+    {
+        while ( !w->mBusy  &&  !w->mQuit )
+            pthread_cond_wait(&w->mCond, &w->mMutex);
+        
+        if ( !w->mBusy )
+            break;
+        
+        // the buffer is not modified by other threads while mBusy is true:
+        pthread_mutex_unlock(&w->mMutex);
+        std::string err = w->save();
+        free(w->mData);
+        pthread_mutex_lock(&w->mMutex);
+        
+        w->mData = 0;
+        w->mSize = 0;
+        if ( err.size() )
+            w->mError = err;
+        w->mBusy = false;
+        pthread_cond_broadcast(&w->mCond);
+    }
+    pthread_mutex_unlock(&w->mMutex);
+    return 0;
+}
+
+
+void BackgroundWriter::write(std::string const& path, bool append, char * data, size_t size)
+{
+    if ( !mStarted )
+    {
+        if ( pthread_create(&mThread, 0, &work, this) )
+        {
+            free(data);
+            throw InvalidIO("failed to create the thread writing `"+path+"'");
+        }
+        mStarted = true;
+    }
+    
+    pthread_mutex_lock(&mMutex);
+    while ( mBusy )
+        pthread_cond_wait(&mCond, &mMutex);
+    mPath   = path;
+    mAppend = append;
+    mData   = data;
+    mSize   = size;
+    mBusy   = true;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+}
+
+
+void BackgroundWriter::wait()
+{
+    pthread_mutex_lock(&mMutex);
+    while ( mBusy )
+        pthread_cond_wait(&mCond, &mMutex);
+    std::string err = mError;
+    mError.clear();
+    pthread_mutex_unlock(&mMutex);
+    
+    if ( err.size() )
+        throw InvalidIO(err);
+}
+
@@ -0,0 +1,88 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef BACKGROUND_WRITER_H
+#define BACKGROUND_WRITER_H
+
+#include <pthread.h>
+#include <cstdlib>
+#include <string>
+
+
+/// Writes memory buffers to files, from a separate thread
+/**
+ write() hands over a buffer to the thread, which opens the file, writes the buffer
+ and closes the file, while the calling thread continues its work.
+ 
+ Only one buffer can be pending: if the thread is still busy with the previous buffer,
+ write() waits for its completion. Thus at most two buffers are held in memory:
+ the one being written, and the one being prepared by the calling thread.
+ The buffers are written in the order in which they were given.
+ 
+ The thread is created by the first call to write(), and terminated by the destructor,
+ after it has written the pending buffer.
+ */
+class BackgroundWriter
+{
+    /// the writing thread
+    pthread_t       mThread;
+    
+    /// true if the thread was created
+    bool            mStarted;
+    
+    /// mutex guarding the variables below
+    pthread_mutex_t mMutex;
+    
+    /// condition used to signal a change of `mBusy` or `mQuit`
+    pthread_cond_t  mCond;
+    
+    /// true while a buffer is pending
+    bool            mBusy;
+    
+    /// true if the thread should terminate
+    bool            mQuit;
+    
+    /// name of the file for the pending buffer
+    std::string     mPath;
+    
+    /// if true, the pending buffer is appended to the file
+    bool            mAppend;
+    
+    /// pending buffer
+    char          * mData;
+    
+    /// size of pending buffer
+    size_t          mSize;
+    
+    /// description of the last error
+    std::string     mError;
+    
+    /// loop executed by the thread
+    static void*    work(void*);
+    
+    /// write the pending buffer to file, returning an error message
+    std::string     save() const;
+    
+    /// Disabled copy constructor
+    BackgroundWriter(BackgroundWriter const&);
+    
+    /// Disabled copy assignment
+    BackgroundWriter& operator=(BackgroundWriter const&);
+    
+public:
+    
+    /// constructor, which does not create the thread
+    BackgroundWriter();
+    
+    /// write pending buffer and terminate the thread
+    ~BackgroundWriter();
+    
+    /// write `size` bytes of `data` to file `path`; `data` should be allocated with malloc() and is released with free()
+    void write(std::string const& path, bool append, char * data, size_t size);
+    
+    /// wait until the pending buffer is written, and throw InvalidIO if an error occured
+    void wait();
+};
+
+
+#endif
+
@@ -0,0 +1,71 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "column_table.h"
+
+
+ColumnTable::Column& ColumnTable::makeColumn(std::string const& name, char type)
+{
+    Column col;
+    col.name = name.substr(0, 255);
+    col.type = type;
+    columns.push_back(col);
+    return columns.back();
+}
+
+
+unsigned ColumnTable::addColumn(std::string const& name, char type)
+{
+    makeColumn(name, type);
+    return columns.size() - 1;
+}
+
+
+void ColumnTable::prependColumn(std::string const& name, int32_t val)
+{
+    const size_t cnt = nbRows();
+    makeColumn(name, INT32).ints.assign(cnt, val);
+    // move the new column in first position:
+    for ( size_t i = columns.size()-1; i > 0; --i )
+        columns[i].swap(columns[i-1]);
+}
+
+
+int ColumnTable::write(std::ostream& out) const
+{
+    const uint64_t cnt = nbRows();
+
+    for ( size_t i = 0; i < columns.size(); ++i )
+    {
+        if ( columns[i].size() != cnt )
+            return 1;
+    }
+
+    // format the schema:
+    std::string schema;
+    for ( size_t i = 0; i < columns.size(); ++i )
+    {
+        schema.push_back(columns[i].type);
+        schema.push_back((char)columns[i].name.size());
+        schema.append(columns[i].name);
+    }
+    schema.resize(( schema.size() + 7 ) & ~7, '\0');
+
+    const uint32_t head[3] = { 0x01020304, (uint32_t)columns.size(), (uint32_t)schema.size() };
+    out.write("ctab", 4);
+    out.write(reinterpret_cast<const char*>(head), 3*sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(&cnt), sizeof(uint64_t));
+    out.write(schema.data(), schema.size());
+
+    for ( size_t i = 0; i < columns.size(); ++i )
+    {
+        Column const& col = columns[i];
+        if ( cnt == 0 )
+            continue;
+        if ( col.type == INT32 )
+            out.write(reinterpret_cast<const char*>(&col.ints[0]), cnt*sizeof(int32_t));
+        else
+            out.write(reinterpret_cast<const char*>(&col.reals[0]), cnt*sizeof(double));
+    }
+    return 0;
+}
+
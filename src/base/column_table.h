@@ -0,0 +1,91 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef COLUMN_TABLE_H
+#define COLUMN_TABLE_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <stdint.h>
+
+
+/// A table of typed columns, that can be written in binary format
+/**
+ Values are added column by column, and all columns should have the same number
+ of rows when the table is written. Each call to write() produces one 'batch':
+ - 4 bytes "ctab",
+ - uint32: 0x01020304, to identify the endianess,
+ - uint32: number of columns,
+ - uint32: size in bytes of the schema that follows,
+ - uint64: number of rows,
+ - the schema: for each column, a type code ('i' = int32, 'd' = float64),
+   the length of the name on one byte, and the name, padded with zeros to 8 bytes,
+ - the values of each column, one column after the other.
+ .
+
+ A file can contain any number of batches, which may have different columns.
+ Each column is written with a single call, and can be read directly,
+ for example with numpy.frombuffer().
+ */
+class ColumnTable
+{
+public:
+
+    /// type codes of the columns
+    enum Type { INT32 = 'i', FLOAT64 = 'd' };
+
+private:
+
+    /// a column of values
+    struct Column
+    {
+        std::string          name;
+        char                 type;
+        std::vector<int32_t> ints;
+        std::vector<double>  reals;
+
+        size_t size() const { return type == INT32 ? ints.size() : reals.size(); }
+        
+        void   swap(Column& c) { name.swap(c.name); std::swap(type, c.type); ints.swap(c.ints); reals.swap(c.reals); }
+    };
+
+    /// all columns
+    std::vector<Column> columns;
+
+    /// make a new column
+    Column&  makeColumn(std::string const& name, char type);
+
+public:
+
+    /// constructor
+    ColumnTable() {}
+
+    /// remove all columns
+    void     clear() { columns.clear(); }
+
+    /// number of columns
+    unsigned nbColumns() const { return columns.size(); }
+
+    /// number of rows, which is given by the first column
+    size_t   nbRows() const { return columns.empty() ? 0 : columns[0].size(); }
+
+    /// add a column of given type, returning its index
+    unsigned addColumn(std::string const& name, char type);
+
+    /// add a column before the others, with `nbRows()` copies of `val`
+    void     prependColumn(std::string const& name, int32_t val);
+
+    /// add value at the end of integer column `c`
+    void     addInt(unsigned c, long val)    { columns[c].ints.push_back(val); }
+
+    /// add value at the end of floating-point column `c`
+    void     addReal(unsigned c, double val) { columns[c].reals.push_back(val); }
+
+    /// write the table as one batch; returns 1 if the columns do not have the same size
+    int      write(std::ostream&) const;
+};
+
+
+#endif
+
@@ -0,0 +1,67 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "frame_digest.h"
+
+
+/**
+ A keyframe is needed if the file is new or different from the previous one,
+ or if `period` frames were written since the last keyframe.
+ */
+bool FrameDigest::start(std::string const& file, bool append, unsigned period)
+{
+    ++stamp;
+    
+    if ( !append || file != path || count == 0 || count >= period )
+    {
+        records.clear();
+        path = file;
+        count = 1;
+        return true;
+    }
+    
+    ++count;
+    return false;
+}
+
+
+bool FrameDigest::update(char tag, unsigned long num, const void * data, size_t size)
+{
+    uint64_t h = hash(data, size);
+    Record & rec = records[Key(tag, num)];
+    
+    // a new Record has stamp == 0, and will be different:
+    bool res = ( rec.stamp == 0 || rec.digest != h );
+    rec.digest = h;
+    rec.stamp  = stamp;
+    return res;
+}
+
+
+void FrameDigest::purge(std::vector<Key>& list)
+{
+    RecordMap::iterator i = records.begin();
+    while ( i != records.end() )
+    {
+        if ( i->second.stamp != stamp )
+        {
+            list.push_back(i->first);
+            records.erase(i++);
+        }
+        else
+            ++i;
+    }
+}
+
+
+uint64_t FrameDigest::hash(const void * data, size_t size)
+{
+    const unsigned char * c = static_cast<const unsigned char*>(data);
+    uint64_t h = 14695981039346656037ULL;
+    for ( size_t i = 0; i < size; ++i )
+    {
+        h ^= c[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
@@ -0,0 +1,76 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef FRAME_DIGEST_H
+#define FRAME_DIGEST_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+
+/// Digests of the objects written in the last frame of a trajectory
+/**
+ An object is identified by its class tag and serial number,
+ and its digest is a 64-bit hash of the bytes that were written for it.
+ Comparing digests indicates which objects have changed since the previous frame,
+ such that a frame may only contain these objects (see Simul::writeObjects).
+
+ A complete frame (a 'keyframe') is written periodically,
+ and always at the start of a new file.
+ */
+class FrameDigest
+{
+public:
+
+    /// identifies an object: class tag and serial number
+    typedef std::pair<char, unsigned long> Key;
+
+private:
+
+    /// digest recorded for an object, and index of the frame where it was seen
+    struct Record
+    {
+        uint64_t digest;
+        unsigned stamp;
+    };
+
+    /// type of the map of records
+    typedef std::map<Key, Record> RecordMap;
+
+    /// digests of all objects
+    RecordMap   records;
+
+    /// file to which the frames are written
+    std::string path;
+
+    /// number of frames written since the last keyframe, including it
+    unsigned    count;
+
+    /// index of the current frame
+    unsigned    stamp;
+
+public:
+
+    /// constructor
+    FrameDigest() : count(0), stamp(0) {}
+
+    /// forget all objects, such that the next frame will be a keyframe
+    void clear() { records.clear(); path.clear(); count = 0; }
+
+    /// start a new frame written to `file`; returns true if this must be a keyframe
+    bool start(std::string const& file, bool append, unsigned period);
+
+    /// record object; returns true if `data` differs from the previous frame
+    bool update(char tag, unsigned long num, const void * data, size_t size);
+
+    /// remove the objects that were not updated in the current frame, adding them to `list`
+    void purge(std::vector<Key>& list);
+
+    /// FNV-1a hash of `size` bytes
+    static uint64_t hash(const void * data, size_t size);
+};
+
+
+#endif
+
@@ -0,0 +1,238 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "frame_index.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstdlib>
+#include <cstring>
+
+/// signature at the start of the index file
+const static char INDEX_MAGIC[] = "cmoindex";
+
+/// version of the index format
+const static uint32_t INDEX_VERSION = 2;
+
+/// value used to check the endianess of the index file
+const static uint32_t INDEX_ENDIAN = 0x01020304;
+
+
+static void writeHeader(FILE* f)
+{
+    fwrite(INDEX_MAGIC, 1, 8, f);
+    fwrite(&INDEX_VERSION, sizeof(uint32_t), 1, f);
+    fwrite(&INDEX_ENDIAN, sizeof(uint32_t), 1, f);
+}
+
+
+/// returns 0 if the header is valid
+static int readHeader(FILE* f)
+{
+    char magic[8];
+    uint32_t version = 0, endian = 0;
+
+    if ( 8 != fread(magic, 1, 8, f) || memcmp(magic, INDEX_MAGIC, 8) )
+        return 1;
+    if ( 1 != fread(&version, sizeof(uint32_t), 1, f) || version != INDEX_VERSION )
+        return 2;
+    if ( 1 != fread(&endian, sizeof(uint32_t), 1, f) || endian != INDEX_ENDIAN )
+        return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ This should be called just before the frame is appended to `file`.
+ The offset of the frame is deduced from the current size of the file.
+ If `append == false` or if the file is empty, a new index is started.
+ Otherwise the index is extended only if it already exists and is consistent
+ with the size of the trajectory file, and it is deleted otherwise,
+ since an incomplete index would not give the correct frame numbers.
+ `key` should be false if the frame only contains the differences with the previous frame.
+ */
+void FrameIndex::record(std::string const& file, bool append, unsigned skip, double time, bool key)
+{
+    std::string name = path(file);
+    struct stat st;
+    off_t end = 0;
+
+    if ( append  &&  0 == stat(file.c_str(), &st) )
+        end = st.st_size;
+
+    Entry e;
+    e.offset = end + skip;
+    e.time   = time;
+    e.base   = 0;
+
+    FILE * f = 0;
+    if ( end == 0 )
+    {
+        f = fopen(name.c_str(), "wb");
+        if ( !f )
+            return;
+        writeHeader(f);
+    }
+    else
+    {
+        f = fopen(name.c_str(), "r+b");
+        if ( !f )
+            return;
+
+        // check the header and the last entry:
+        Entry last;
+        bool valid = ( 0 == readHeader(f) );
+        if ( valid && 0 == fseeko(f, -(off_t)sizeof(Entry), SEEK_END) )
+            valid = ( 1 == fread(&last, sizeof(Entry), 1, f) && last.offset < (uint64_t)end );
+        else
+            valid = false;
+
+        if ( !valid || fseeko(f, 0, SEEK_END) )
+        {
+            fclose(f);
+            remove(name.c_str());
+            return;
+        }
+        
+        // the new entry is after all the entries present in the file:
+        e.base = key ? ( ftello(f) - 16 ) / sizeof(Entry) : last.base;
+    }
+
+    fwrite(&e, sizeof(Entry), 1, f);
+    fclose(f);
+}
+
+
+int FrameIndex::load(std::string const& file)
+{
+    entries.clear();
+
+    FILE * f = fopen(path(file).c_str(), "rb");
+    if ( !f )
+        return 1;
+
+    if ( readHeader(f) )
+    {
+        fclose(f);
+        return 2;
+    }
+
+    Entry e;
+    while ( 1 == fread(&e, sizeof(Entry), 1, f) )
+        entries.push_back(e);
+
+    fclose(f);
+    return 0;
+}
+
+
+void FrameIndex::save(std::string const& file) const
+{
+    FILE * f = fopen(path(file).c_str(), "wb");
+    if ( !f )
+        return;
+
+    writeHeader(f);
+    if ( entries.size() )
+        fwrite(&entries[0], sizeof(Entry), entries.size(), f);
+    fclose(f);
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ The time of a frame is read from the line following the tag,
+ which is expected to be `#time T, ...`.
+ A frame is considered complete, unless the next line is `#delta`.
+ */
+void FrameIndex::build(FILE* file, const char tag[])
+{
+    entries.clear();
+
+    const size_t len = strlen(tag);
+    char * line = 0;
+    size_t cap = 0;
+    int header = 0;
+    uint64_t base = 0;
+
+    rewind(file);
+    while ( 1 )
+    {
+        off_t pos = ftello(file);
+        if ( getline(&line, &cap, file) < 0 )
+            break;
+
+        if ( header == 2 )
+        {
+            double t;
+            if ( 1 == sscanf(line, "#time %lf", &t) )
+                entries.back().time = t;
+            header = 1;
+        }
+        else if ( header == 1 )
+        {
+            if ( 0 == strncmp(line, "#delta", 6) )
+                entries.back().base = base;
+            else
+                base = entries.back().base;
+            header = 0;
+        }
+
+        if ( 0 == strncmp(line, tag, len) )
+        {
+            Entry e;
+            e.offset = pos;
+            e.time   = 0;
+            e.base   = entries.size();
+            entries.push_back(e);
+            header   = 2;
+        }
+    }
+    free(line);
+    clearerr(file);
+}
+
+
+/**
+ The offsets should be increasing and within the file,
+ and the first and last entries should point to lines starting with `tag`.
+ The position in the file is restored.
+ */
+int FrameIndex::check(FILE* file, const char tag[]) const
+{
+    if ( entries.empty() )
+        return 1;
+
+    const size_t len = strlen(tag);
+    off_t pos = ftello(file);
+
+    if ( fseeko(file, 0, SEEK_END) )
+        return 2;
+    uint64_t end = ftello(file);
+
+    int res = 0;
+    for ( size_t i = 1; i < entries.size(); ++i )
+    {
+        if ( entries[i].offset <= entries[i-1].offset )
+        {
+            res = 3;
+            break;
+        }
+    }
+
+    if ( res == 0 && entries.back().offset + len > end )
+        res = 4;
+
+    char * buf = new char[len];
+    for ( int k = 0; k < 2 && res == 0; ++k )
+    {
+        Entry const& e = k ? entries.back() : entries.front();
+        if ( fseeko(file, e.offset, SEEK_SET) || len != fread(buf, 1, len, file) || memcmp(buf, tag, len) )
+            res = 5;
+    }
+    delete[] buf;
+
+    clearerr(file);
+    fseeko(file, pos, SEEK_SET);
+    return res;
+}
+
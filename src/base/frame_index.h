@@ -0,0 +1,80 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef FRAME_INDEX_H
+#define FRAME_INDEX_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+/// Offsets and times of the frames in a trajectory file, stored in a sidecar file
+/**
+ The index of `objects.cmo` is stored in `objects.cmo.idx`, in binary format:
+ - a header of 16 bytes: "cmoindex", a version number and a marker of endianess,
+ - for each frame, 24 bytes: the offset of the frame tag line in the trajectory file,
+   the simulated time of the frame, and the index of the keyframe from which
+   the frame can be reconstructed, which is the frame itself for a complete frame.
+ .
+
+ The index is extended by the simulation every time a frame is written,
+ such that a given frame can be located in the trajectory with a single seek.
+ It can also be rebuilt for an existing trajectory file with build().
+
+ An index is only useful if it matches the trajectory file exactly:
+ check() should be used to verify this before the offsets are used.
+ */
+class FrameIndex
+{
+public:
+
+    /// information stored for each frame
+    struct Entry
+    {
+        uint64_t offset;  ///< position of the frame tag line, in bytes from the start of file
+        double   time;    ///< simulated time of the frame
+        uint64_t base;    ///< index of the last complete frame, up to this one
+    };
+
+private:
+
+    /// entries for all the frames
+    std::vector<Entry> entries;
+
+public:
+
+    /// constructor
+    FrameIndex() {}
+
+    /// name of the index file associated with trajectory `file`
+    static std::string path(std::string const& file) { return file + ".idx"; }
+
+    /// record a frame that is written at the end of `file`, with a frame tag at `skip` bytes after the current end
+    static void record(std::string const& file, bool append, unsigned skip, double time, bool key = true);
+
+    /// number of frames
+    size_t       size()                 const { return entries.size(); }
+
+    /// information on frame `i`
+    Entry const& operator[](size_t i)   const { return entries[i]; }
+
+    /// clear all entries
+    void         clear()                      { entries.clear(); }
+
+    /// read the index of trajectory `file`; returns 0 if successful
+    int          load(std::string const& file);
+
+    /// write the index of trajectory `file`
+    void         save(std::string const& file) const;
+
+    /// scan trajectory file, recording the lines starting with `tag`, and the time and type of each frame
+    void         build(FILE*, const char tag[]);
+
+    /// verify that the first and last entries point to lines starting with `tag`; returns 0 if valid
+    int          check(FILE*, const char tag[]) const;
+};
+
+
+#endif
+
@@ -2,6 +2,12 @@
 
 #include "iowrapper.h"
 #include "exceptions.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cmath>
 
 
 ///check the size of the type, as we rely on them to write byte-by-byte
@@ -26,6 +32,12 @@ void InputWrapper::iwConstructor()
     inFormat  = 0;
     inBinary  = 0;
     inDIM     = 3;
+    mMap      = 0;
+    mMapEnd   = 0;
+    mPtr      = 0;
+    mEof      = false;
+    inQuantum = 0;
+    inDouble  = false;
     
     if ( nonStandardTypeSizes() )
     {
@@ -35,6 +47,301 @@ void InputWrapper::iwConstructor()
 }
 
 
+int InputWrapper::open(const char* name, const char* mode)
+{
+    unmap();
+    return FileWrapper::open(name, mode);
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Memory mapped input
+
+/**
+ The input continues from the current position in the file.
+ This fails if the file is empty or cannot be mapped, for example if it is a pipe,
+ and input is then made from the file as usual.
+ */
+int InputWrapper::map()
+{
+    if ( mMap )
+        return 0;
+    
+    struct stat st;
+    if ( !mFile || fstat(fileno(mFile), &st) || st.st_size <= 0 )
+        return 1;
+    
+    off_t pos = ftello(mFile);
+    if ( pos < 0 || pos > st.st_size )
+        return 2;
+    
+    void * m = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fileno(mFile), 0);
+    if ( m == MAP_FAILED )
+        return 3;
+    
+    mMap    = static_cast<const char*>(m);
+    mMapEnd = mMap + st.st_size;
+    mPtr    = mMap + pos;
+    mEof    = false;
+    return 0;
+}
+
+
+void InputWrapper::unmap()
+{
+    if ( mMap )
+    {
+        if ( mFile )
+        {
+            fseeko(mFile, mPtr-mMap, SEEK_SET);
+            if ( mEof )
+                getc(mFile);
+        }
+        munmap(const_cast<char*>(mMap), mMapEnd-mMap);
+        mMap = 0;
+        mMapEnd = 0;
+        mPtr = 0;
+    }
+}
+
+
+/**
+ This is useful if the file is written by another process
+ */
+void InputWrapper::remap()
+{
+    struct stat st;
+    if ( !mMap || fstat(fileno(mFile), &st) || st.st_size == mMapEnd-mMap )
+        return;
+    
+    off_t pos = mPtr - mMap;
+    void * m = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fileno(mFile), 0);
+    if ( m == MAP_FAILED )
+        return;
+    
+    munmap(const_cast<char*>(mMap), mMapEnd-mMap);
+    mMap    = static_cast<const char*>(m);
+    mMapEnd = mMap + st.st_size;
+    mPtr    = mMap + ( pos < st.st_size ? pos : st.st_size );
+}
+
+
+void InputWrapper::clearerr()
+{
+    FileWrapper::clearerr();
+    if ( mMap && mEof )
+    {
+        mEof = false;
+        remap();
+    }
+}
+
+
+void InputWrapper::rewind()
+{
+    FileWrapper::rewind();
+    mPtr = mMap;
+    mEof = false;
+}
+
+
+/**
+ With mapped input, the position is converted using the file
+ */
+int InputWrapper::get_pos(fpos_t& p)
+{
+    if ( mMap )
+    {
+        if ( fseeko(mFile, mPtr-mMap, SEEK_SET) )
+            return 1;
+    }
+    return fgetpos(mFile, &p);
+}
+
+
+void InputWrapper::set_pos(const fpos_t& p)
+{
+    fsetpos(mFile, &p);
+    if ( mMap )
+    {
+        off_t pos = ftello(mFile);
+        if ( pos < 0 || pos > mMapEnd-mMap )
+            pos = mMapEnd-mMap;
+        mPtr = mMap + pos;
+        mEof = false;
+    }
+}
+
+
+void InputWrapper::get_line(std::string& line, const char sep)
+{
+    if ( !mMap )
+        return FileWrapper::get_line(line, sep);
+    
+    const char * m = (const char*)memchr(mPtr, sep, mMapEnd-mPtr);
+    if ( m )
+    {
+        line.assign(mPtr, m-mPtr);
+        mPtr = m + 1;
+    }
+    else
+    {
+        line.assign(mPtr, mMapEnd-mPtr);
+        mPtr = mMapEnd;
+        mEof = true;
+    }
+}
+
+
+void InputWrapper::skip_until(const char * str)
+{
+    if ( !mMap )
+        return FileWrapper::skip_until(str);
+    
+    const size_t len = strlen(str);
+    const char * m = mPtr;
+    while ( m + len <= mMapEnd )
+    {
+        m = (const char*)memchr(m, str[0], mMapEnd-m-len+1);
+        if ( !m )
+            break;
+        if ( 0 == memcmp(m, str, len) )
+        {
+            mPtr = m;
+            return;
+        }
+        ++m;
+    }
+    mPtr = mMapEnd;
+    mEof = true;
+}
+
+
+void InputWrapper::readBytes(void* dst, size_t n)
+{
+    if ( mMap )
+    {
+        if ( (size_t)(mMapEnd-mPtr) < n )
+        {
+            mPtr = mMapEnd;
+            mEof = true;
+            throw InvalidIO("fread failed");
+        }
+        memcpy(dst, mPtr, n);
+        mPtr += n;
+    }
+    else if ( 1 != fread(dst, n, 1, mFile) )
+        throw InvalidIO("fread failed");
+}
+
+
+/**
+ Copy the next word of the mapped region into `buf`, skipping white space
+ */
+static size_t nextWord(const char *& ptr, const char * end, bool& eof, char buf[], size_t size)
+{
+    while ( ptr < end && isspace(*ptr) )
+        ++ptr;
+    if ( ptr >= end )
+        eof = true;
+    size_t n = 0;
+    while ( ptr+n < end && n+1 < size && !isspace(ptr[n]) )
+        ++n;
+    memcpy(buf, ptr, n);
+    buf[n] = 0;
+    return n;
+}
+
+
+long InputWrapper::readTextInt(const char* what)
+{
+    long v = 0;
+    if ( mMap )
+    {
+        char buf[64], * e;
+        nextWord(mPtr, mMapEnd, mEof, buf, sizeof(buf));
+        v = strtol(buf, &e, 0);
+        if ( e == buf )
+            throw InvalidIO(std::string(what)+" failed");
+        mPtr += e - buf;
+    }
+    else
+    {
+        int u;
+        if ( 1 != fscanf(mFile, " %i", &u) )
+            throw InvalidIO(std::string(what)+" failed");
+        v = u;
+    }
+    return v;
+}
+
+
+unsigned long InputWrapper::readTextUInt(const char* what)
+{
+    unsigned long v = 0;
+    if ( mMap )
+    {
+        char buf[64], * e;
+        nextWord(mPtr, mMapEnd, mEof, buf, sizeof(buf));
+        v = strtoul(buf, &e, 10);
+        if ( e == buf )
+            throw InvalidIO(std::string(what)+" failed");
+        mPtr += e - buf;
+    }
+    else
+    {
+        unsigned u;
+        if ( 1 != fscanf(mFile, " %u", &u) )
+            throw InvalidIO(std::string(what)+" failed");
+        v = u;
+    }
+    return v;
+}
+
+
+double InputWrapper::readTextReal(const char* what)
+{
+    double v = 0;
+    if ( mMap )
+    {
+        char buf[64], * e;
+        nextWord(mPtr, mMapEnd, mEof, buf, sizeof(buf));
+        v = strtod(buf, &e);
+        if ( e == buf )
+            throw InvalidIO(std::string(what)+" failed");
+        mPtr += e - buf;
+    }
+    else
+    {
+        if ( 1 != fscanf(mFile, " %lf", &v) )
+            throw InvalidIO(std::string(what)+" failed");
+    }
+    return v;
+}
+
+
+float InputWrapper::readTextFloat(const char* what)
+{
+    float v = 0;
+    if ( mMap )
+    {
+        char buf[64], * e;
+        nextWord(mPtr, mMapEnd, mEof, buf, sizeof(buf));
+        v = strtof(buf, &e);
+        if ( e == buf )
+            throw InvalidIO(std::string(what)+" failed");
+        mPtr += e - buf;
+    }
+    else
+    {
+        if ( 1 != fscanf(mFile, " %f", &v) )
+            throw InvalidIO(std::string(what)+" failed");
+    }
+    return v;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Reading values
+
 /**
  Reads a short and compares with the native storage, to set
  inBinary=1, for same-endian or inBinary = 2, for opposite endian
@@ -58,9 +365,7 @@ int8_t InputWrapper::readInt8()
     }
     else
     {
-        int u;
-        if ( 1 != fscanf(mFile, " %i", &u) )
-            throw InvalidIO("readUInt8() failed");
+        long u = readTextInt("readInt8()");
         v = u;
         if ( v != u )
             throw InvalidIO("invalid int8_t");
@@ -75,16 +380,13 @@ int16_t InputWrapper::readInt16()
     
     if ( inBinary )
     {
-        if ( 1 != fread(&v, 2, 1, mFile) )
-            throw InvalidIO("fread failed");
+        readBytes(&v, 2);
         if ( inBinary == 2 )
             swap2(reinterpret_cast<char*>(&v));
     }
     else
     {
-        int u;
-        if ( 1 != fscanf(mFile, " %i", &u) )
-            throw InvalidIO("readInt16() failed");
+        long u = readTextInt("readInt16()");
         v = u;
         if ( v != u )
             throw InvalidIO("invalid int16_t");
@@ -99,16 +401,13 @@ int32_t InputWrapper::readInt32()
     
     if ( inBinary )
     {
-        if ( 1 != fread(&v, 4, 1, mFile) )
-            throw InvalidIO("fread failed");
+        readBytes(&v, 4);
         if ( inBinary == 2 )
             swap4(reinterpret_cast<char*>(&v));
     }
     else
     {
-        int u;
-        if ( 1 != fscanf(mFile, " %i", &u) )
-            throw InvalidIO("readInt32() failed");
+        long u = readTextInt("readInt32()");
         v = u;
         if ( v != u )
             throw InvalidIO("invalid int32_t");
@@ -127,9 +426,7 @@ uint8_t InputWrapper::readUInt8()
     }
     else
     {
-        unsigned u;
-        if ( 1 != fscanf(mFile, " %u", &u) )
-            throw InvalidIO("readUInt8() failed");
+        unsigned long u = readTextUInt("readUInt8()");
         v = u;
         if ( v != u )
             throw InvalidIO("invalid uint8_t");
@@ -144,16 +441,13 @@ uint16_t InputWrapper::readUInt16()
     
     if ( inBinary )
     {
-        if ( 1 != fread(&v, 2, 1, mFile) )
-            throw InvalidIO("fread failed");
+        readBytes(&v, 2);
         if ( inBinary == 2 )
             swap2(reinterpret_cast<char*>(&v));
     }
     else
     {
-        unsigned u;
-        if ( 1 != fscanf(mFile, " %u", &u) )
-            throw InvalidIO("readUInt16() failed");
+        unsigned long u = readTextUInt("readUInt16()");
         v = u;
         if ( v != u )
             throw InvalidIO("invalid uint16_t");
@@ -168,16 +462,13 @@ uint32_t InputWrapper::readUInt32()
     
     if ( inBinary )
     {
-        if ( 1 != fread(&v, 4, 1, mFile) )
-            throw InvalidIO("fread failed");
+        readBytes(&v, 4);
         if ( inBinary == 2 )
             swap4(reinterpret_cast<char*>(&v));
     }
     else
     {
-        unsigned u;
-        if ( 1 != fscanf(mFile, " %u", &u) )
-            throw InvalidIO("readUInt32() failed");
+        unsigned long u = readTextUInt("readUInt32()");
         v = u;
         if ( v != u )
             throw InvalidIO("invalid uint32_t");
@@ -187,21 +478,22 @@ uint32_t InputWrapper::readUInt32()
 
 
 
-float InputWrapper::readFloat()
+double InputWrapper::readFloat()
 {
+    if ( inDouble && inBinary )
+        return readDouble();
+    
     float v;
     
     if ( inBinary )
     {
-        if ( 1 != fread(&v, 4, 1, mFile) )
-            throw InvalidIO("fread failed");
+        readBytes(&v, 4);
         if ( inBinary == 2 )
             swap4(reinterpret_cast<char*>(&v));
     }
     else
     {
-        if ( 1 != fscanf(mFile, " %f", &v) )
-            throw InvalidIO("readFloat() failed");
+        v = readTextFloat("readFloat()");
     }
     return v;
 }
@@ -213,15 +505,13 @@ double InputWrapper::readDouble()
     
     if ( inBinary )
     {
-        if ( 1 != fread(&v, 8, 1, mFile) )
-            throw InvalidIO("fread failed");
+        readBytes(&v, 8);
         if ( inBinary == 2 )
             swap8(reinterpret_cast<char*>(&v));
     }
     else
     {
-        if ( 1 != fscanf(mFile, " %lf", &v) )
-            throw InvalidIO("readDouble() failed");
+        v = readTextReal("readDouble()");
     }
     return v;
 }
@@ -285,10 +575,57 @@ void InputWrapper::readFloatVector(double a[], const unsigned D)
 
 /*
  This will read n * inDIM floats, and store the n * D ones in a[].
+ With mapped binary input, the values are converted directly from the mapped pages.
  */
-void InputWrapper::readFloatVector(double a[], const unsigned n, const unsigned D)
+template < typename FLOAT >
+void InputWrapper::readFloats(FLOAT a[], const unsigned n, const unsigned D)
 {
     const size_t nd = n * inDIM;
+    const unsigned m = ( inDIM < D ? inDIM : D );
+
+    if ( inDouble && inBinary )
+    {
+        for ( unsigned u = 0; u < n; ++u )
+        {
+            unsigned d;
+            for ( d = 0; d < m; ++d )
+                a[D*u+d] = readDouble();
+            for (; d < inDIM; ++d )
+                readDouble();
+            for ( d = m; d < D; ++d )
+                a[D*u+d] = 0;
+        }
+        return;
+    }
+
+    if ( mMap && inBinary )
+    {
+        if ( (size_t)(mMapEnd-mPtr) < 4 * nd )
+        {
+            mPtr = mMapEnd;
+            mEof = true;
+            throw InvalidIO("fread failed");
+        }
+        const char * src = mPtr;
+        for ( unsigned u = 0; u < n; ++u )
+        {
+            unsigned d;
+            for ( d = 0; d < m; ++d )
+            {
+                float x;
+                memcpy(&x, src+4*d, 4);
+                if ( inBinary == 2 )
+                    swap4(reinterpret_cast<char*>(&x));
+                a[D*u+d] = x;
+            }
+            for (; d < D; ++d )
+                a[D*u+d] = 0;
+            src += 4 * inDIM;
+        }
+        mPtr = src;
+        return;
+    }
+
     float * v = new float[nd];
     
     if ( inBinary )
@@ -304,16 +641,16 @@ void InputWrapper::readFloatVector(double a[], const unsigned n, const unsigned
     }
     else
     {
-        for ( unsigned u = 0; u < nd; ++u )
-            if ( 1 != fscanf(mFile, " %f", v+u) )
-            {
-                delete[] v;
-                throw InvalidIO("readFloat() failed");
-            }
+        try {
+            for ( unsigned u = 0; u < nd; ++u )
+                v[u] = readTextFloat("readFloat()");
+        }
+        catch( Exception& ) {
+            delete[] v;
+            throw;
+        }
     }
 
-    const unsigned m = ( inDIM < D ? inDIM : D );
-    
     for ( unsigned u = 0; u < n; ++u )
     {
         unsigned d;
@@ -326,6 +663,80 @@ void InputWrapper::readFloatVector(double a[], const unsigned n, const unsigned
     delete[] v;
 }
 
+
+void InputWrapper::readFloatVector(float a[], const unsigned n, const unsigned D)
+{
+    readFloats(a, n, D);
+}
+
+
+void InputWrapper::readFloatVector(double a[], const unsigned n, const unsigned D)
+{
+    readFloats(a, n, D);
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Compressed coordinates
+
+/**
+ The value is stored in 'zigzag' format, with 7 bits per byte.
+ The highest bit of each byte indicates if more bytes follow.
+ */
+int64_t InputWrapper::readVarInt()
+{
+    uint64_t u = 0;
+    for ( unsigned s = 0; s < 64; s += 7 )
+    {
+        int c = getUL();
+        if ( c == EOF )
+            throw InvalidIO("readVarInt() failed");
+        u |= (uint64_t)( c & 127 ) << s;
+        if ( !( c & 128 ) )
+            return (int64_t)( u >> 1 ) ^ -(int64_t)( u & 1 );
+    }
+    throw InvalidIO("invalid variable length integer");
+}
+
+
+/*
+ This will read n * inDIM values, and store the n * D ones in a[].
+ The coordinates of the first vector are relative to zero, 
+ and the following ones are relative to the previous vector.
+ */
+template < typename FLOAT >
+void InputWrapper::readDeltas(FLOAT a[], const unsigned n, const unsigned D)
+{
+    if ( inDIM > 4 )
+        throw InvalidIO("unsupported dimension for compressed coordinates");
+    
+    int64_t acc[4] = { 0 };
+    
+    for ( unsigned u = 0; u < n; ++u )
+    {
+        unsigned d;
+        for ( d = 0; d < inDIM; ++d )
+        {
+            acc[d] += readVarInt();
+            if ( d < D )
+                a[D*u+d] = FLOAT( acc[d] * inQuantum );
+        }
+        for (; d < D; ++d )
+            a[D*u+d] = 0;
+    }
+}
+
+
+void InputWrapper::readDeltaVector(float a[], const unsigned n, const unsigned D)
+{
+    readDeltas(a, n, D);
+}
+
+
+void InputWrapper::readDeltaVector(double a[], const unsigned n, const unsigned D)
+{
+    readDeltas(a, n, D);
+}
+
 //============================================================================
 //=========                    OUTPUT                              ===========
 //============================================================================
@@ -335,6 +746,8 @@ OutputWrapper::OutputWrapper()
 : FileWrapper(stdout) 
 {
     mBinary = false;
+    mQuantum = 0;
+    mDouble = false;
     
     if ( nonStandardTypeSizes() )
     {
@@ -346,6 +759,8 @@ OutputWrapper::OutputWrapper()
 
 OutputWrapper::OutputWrapper(const char* name, const bool a, const bool b)
 {
+    mQuantum = 0;
+    mDouble = false;
     open(name, a, b);
     
     if ( nonStandardTypeSizes() )
@@ -356,6 +771,21 @@ OutputWrapper::OutputWrapper(const char* name, const bool a, const bool b)
 }
 
 
+OutputWrapper::OutputWrapper(FILE * f, const bool b, const char * path)
+: FileWrapper(f, path)
+{
+    mBinary = b;
+    mQuantum = 0;
+    mDouble = false;
+    
+    if ( nonStandardTypeSizes() )
+    {
+        fprintf(stderr, "Error: non-standard types in InputWrapper\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
 int OutputWrapper::open(const char* name, const bool a, const bool b)
 {
     mBinary = b;
@@ -532,11 +962,17 @@ void OutputWrapper::writeUInt32(const unsigned int n, char before)
 
 
 
-void OutputWrapper::writeFloat(const float x)
+void OutputWrapper::writeFloat(const double x)
 {
-    if ( mBinary )
+    if ( mBinary && mDouble )
+    {
+        if ( 8 != fwrite(&x, 1, 8, mFile) )
+            throw InvalidIO("writeFloat()-binary failed");
+    }
+    else if ( mBinary )
     {
-        if ( 4 != fwrite(&x, 1, 4, mFile) )
+        const float f = x;
+        if ( 4 != fwrite(&f, 1, 4, mFile) )
             throw InvalidIO("writeFloat()-binary failed");
     }
     else
@@ -611,3 +1047,53 @@ void OutputWrapper::writeSoftSpace(int N)
     }
 }
 
+
+void OutputWrapper::writeVarInt(const int64_t n)
+{
+    // 'zigzag' encoding, such that small negative values use few bytes:
+    uint64_t u = ( (uint64_t)n << 1 ) ^ (uint64_t)( n >> 63 );
+    
+    while ( u >= 128 )
+    {
+        putc_unlocked( 128 | ( u & 127 ), mFile );
+        u >>= 7;
+    }
+    if ( EOF == putc_unlocked( u, mFile ) )
+        throw InvalidIO("writeVarInt() failed");
+}
+
+
+/**
+ The coordinates are rounded to the nearest multiple of quantum(),
+ and every vector is written as the difference with the previous one,
+ which for the points of a Fiber, is usually small and takes 1 or 2 bytes.
+ */
+template < typename FLOAT >
+void OutputWrapper::writeDeltas(const FLOAT* a, const unsigned n, const unsigned D)
+{
+    assert_true( mBinary && mQuantum > 0 );
+    assert_true( D <= 4 );
+    const double iq = 1.0 / mQuantum;
+    
+    // as in InputWrapper::readDeltas(), the first vector is relative to zero:
+    int64_t acc[4] = { 0 };
+    
+    for ( unsigned i = 0; i < n * D; ++i )
+    {
+        int64_t v = (int64_t)floor( a[i] * iq + 0.5 );
+        writeVarInt( v - acc[i%D] );
+        acc[i%D] = v;
+    }
+}
+
+
+void OutputWrapper::writeDeltaVector(const float* a, const unsigned n, const unsigned D)
+{
+    writeDeltas(a, n, D);
+}
+
+
+void OutputWrapper::writeDeltaVector(const double* a, const unsigned n, const unsigned D)
+{
+    writeDeltas(a, n, D);
+}
@@ -10,6 +10,9 @@
 
 /// Input with automatic binary/text mode and byte-swapping for cross-platform compatibility
 /**
+ After map(), the file is mapped in memory and all input is made from the mapped pages,
+ bypassing the buffered C-library functions. This is used by FrameReader.
+
  @todo:
  Introduce a set of classes:
  Inputter (text, base class)
@@ -41,6 +44,47 @@ private:
         */
     int       inBinary;
     
+    /// start of the memory region where the file is mapped, or zero
+    const char * mMap;
+    
+    /// end of the mapped region
+    const char * mMapEnd;
+    
+    /// current position of input in the mapped region
+    const char * mPtr;
+    
+    /// end-of-file indicator, for mapped input
+    bool      mEof;
+    
+    /// precision of compressed coordinates, or zero if the coordinates are not compressed
+    double    inQuantum;
+    
+    /// if true, floating-point values are stored on 8 bytes in binary format
+    bool      inDouble;
+    
+    /// read `n` bytes into `dst`
+    void      readBytes(void* dst, size_t n);
+    
+    /// read an integer written in text, as with fscanf(" %i")
+    long      readTextInt(const char* what);
+    
+    /// read an unsigned integer written in text, as with fscanf(" %u")
+    unsigned long readTextUInt(const char* what);
+    
+    /// read n * inDIM floats, and store n * D values in the array
+    template < typename FLOAT >
+    void      readFloats(FLOAT*, unsigned n, unsigned D);
+
+    /// read n * inDIM compressed coordinates, and store n * D values in the array
+    template < typename FLOAT >
+    void      readDeltas(FLOAT*, unsigned n, unsigned D);
+
+    /// read a floating point value written in text, as with fscanf(" %f")
+    float     readTextFloat(const char* what);
+    
+    /// read a floating point value written in text, as with fscanf(" %lf")
+    double    readTextReal(const char* what);
+
     /// reverse order of bytes in c[2]
     /**
      Can use the Intel SIMD function _bswap() and _bswap64()
@@ -95,7 +139,68 @@ public:
     InputWrapper(const char* name, bool bin) : FileWrapper(name, bin?"rb":"r") { iwConstructor(); }
     
     /// Destructor which closes the input and output files
-    virtual   ~InputWrapper() {}
+    virtual   ~InputWrapper() { unmap(); }
+    
+    /// open a file, releasing any mapped region
+    int       open(const char* name, const char* mode);
+    
+    /// map the file in memory, such that input is made from memory; returns 0 if successful
+    int       map();
+    
+    /// release mapped region, and continue input from the file at the same position
+    void      unmap();
+    
+    /// extend the mapped region if the file has grown
+    void      remap();
+    
+    /// true if input is made from a mapped region
+    bool      mapped()           const { return mMap != 0; }
+    
+    /// true if End-Of-File
+    bool      eof()              const { return mMap ? mEof : FileWrapper::eof(); }
+    
+    /// clear End-Of-File indicator, and map the extension of the file if it has grown
+    void      clearerr();
+    
+    /// rewind file
+    void      rewind();
+    
+    /// current position in input file, relative to beggining
+    int       get_pos(fpos_t& p);
+    
+    /// set position relative to the beginning of the file
+    void      set_pos(const fpos_t& p);
+    
+    /// read a character
+    int       getUL()
+    {
+        if ( !mMap )
+            return FileWrapper::getUL();
+        if ( mPtr < mMapEnd )
+            return (unsigned char)*mPtr++;
+        mEof = true;
+        return EOF;
+    }
+    
+    /// report next character to be read
+    int       peek()
+    {
+        if ( !mMap )
+            return FileWrapper::peek();
+        if ( mPtr < mMapEnd )
+            return (unsigned char)*mPtr;
+        mEof = true;
+        return EOF;
+    }
+    
+    /// put back a character
+    void      unget(int c)       { if ( !mMap ) FileWrapper::unget(c); else if ( c != EOF && mPtr > mMap ) --mPtr; }
+    
+    /// read line, not including the separator, which is skipped
+    void      get_line(std::string& line, char sep='\n');
+    
+    /// read stream until given string is found
+    void      skip_until(const char * str);
 
     /// Sets dimentionnality of vectors
     void      inputDIM(const int d)    { inDIM = d; }
@@ -112,6 +217,18 @@ public:
     /// Automatically find in which way bytes are stored in the binary format
     void      setBinarySwap(const char[2]);
     
+    /// precision of compressed coordinates, or zero if they are not compressed
+    double    quantum()          const { return inQuantum; }
+    
+    /// set precision of compressed coordinates
+    void      quantum(double q)        { inQuantum = q; }
+    
+    /// true if floating-point values are stored on 8 bytes in binary format
+    bool      doublePrecision()  const { return inDouble; }
+    
+    /// set if floating-point values are stored on 8 bytes in binary format
+    void      doublePrecision(bool b)  { inDouble = b; }
+    
     /// Read integer on 1 byte
     int8_t    readInt8();
     /// Read integer on 2 bytes
@@ -126,8 +243,8 @@ public:
     /// Read unsigned integer on 4 bytes
     uint32_t  readUInt32();
     
-    /// Reads a float on 4 bytes
-    float     readFloat();
+    /// Reads a float on 4 bytes, or on 8 bytes if doublePrecision()
+    double    readFloat();
     /// Reads a float on 8 bytes
     double    readDouble();
     /// Reads a vector, and store in the array of size D
@@ -138,6 +255,13 @@ public:
     void      readFloatVector(float*, unsigned n, unsigned D);
     /// Reads a vector, and store in the array of size D
     void      readFloatVector(double*, unsigned n, unsigned D);
+    
+    /// Read integer written with a variable number of bytes by writeVarInt()
+    int64_t   readVarInt();
+    /// Read n vectors written by writeDeltaVector(), and store them in the array of size n*D
+    void      readDeltaVector(float*, unsigned n, unsigned D);
+    /// Read n vectors written by writeDeltaVector(), and store them in the array of size n*D
+    void      readDeltaVector(double*, unsigned n, unsigned D);
 
 };
 
@@ -153,6 +277,16 @@ private:
         
     /// Flag for binary output
     bool    mBinary;
+    
+    /// precision of compressed coordinates, or zero to disable compression
+    double  mQuantum;
+    
+    /// if true, floating-point values are written on 8 bytes in binary format
+    bool    mDouble;
+    
+    /// write n vectors of dimension D as quantized differences
+    template < typename FLOAT >
+    void    writeDeltas(const FLOAT*, unsigned n, unsigned D);
 
 public:
 
@@ -162,6 +296,9 @@ public:
     /// constructor which opens a file
     OutputWrapper(const char* name, bool a, bool b=false);
     
+    /// constructor from an already opened file, in binary mode if `b` is true
+    OutputWrapper(FILE * f, bool b, const char * path = 0);
+    
     /// Open a file. mode[1] can be 'b' to specify binary mode
     int     open(const char* name, bool a, bool b=false);
     
@@ -174,6 +311,18 @@ public:
     /// Return the current binary format
     bool    binary() const { return mBinary; }
     
+    /// Set the precision of compressed coordinates; zero disables compression
+    void    quantum(double q) { mQuantum = q; }
+    
+    /// Precision of compressed coordinates, or zero if coordinates are not compressed
+    double  quantum() const { return mQuantum; }
+    
+    /// Set to write floating-point values on 8 bytes in binary format, without rounding
+    void    doublePrecision(bool b) { mDouble = b; }
+    
+    /// True if floating-point values are written on 8 bytes in binary format
+    bool    doublePrecision() const { return mDouble; }
+    
     /// Puts a tag to specify a binary file, and the byte order 
     void    writeBinarySignature(const char[]);
         
@@ -197,17 +346,24 @@ public:
     /// Write unsigned integer on 4 bytes
     void    writeUInt32(unsigned int, char before=' ');
     
-    /// Write a float (4 bytes)
-    void    writeFloat(float);
-    /// Write n floats (4 bytes each)
+    /// Write a float (4 bytes, or 8 bytes if doublePrecision())
+    void    writeFloat(double);
+    /// Write n floats (4 bytes each, or 8 bytes if doublePrecision())
     void    writeFloatVector(const float*, unsigned n, char before=0);
-    /// Write n floats (4 bytes each)
+    /// Write n floats (4 bytes each, or 8 bytes if doublePrecision())
     void    writeFloatVector(const double*, unsigned n, char before=0);
 
     /// Write a double (8 bytes)
     void    writeDouble(double);
     /// Write n double (8 bytes each)
     void    writeDoubleVector(const double*, unsigned n, char before=0);
+    
+    /// Write integer with a variable number of bytes, in binary format only
+    void    writeVarInt(int64_t);
+    /// Write n vectors of dimension D, quantized with precision quantum(), in binary format only
+    void    writeDeltaVector(const float*, unsigned n, unsigned D);
+    /// Write n vectors of dimension D, quantized with precision quantum(), in binary format only
+    void    writeDeltaVector(const double*, unsigned n, unsigned D);
 
 };
 
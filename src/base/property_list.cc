@@ -9,6 +9,7 @@ void PropertyList::erase()
     for ( const_iterator n = vec.begin(); n != vec.end(); ++n )
         delete( *n );
     vec.clear();
+    ++stp;
 }
 
 /**
@@ -37,6 +38,7 @@ void PropertyList::deposit(Property * p, bool refuse_duplicate)
 
     vec.push_back(p);
     p->index(cnt);
+    ++stp;
 }
 
 
@@ -51,6 +53,7 @@ int PropertyList::remove(Property * p)
         if ( *n == p )
         {
             vec.erase(n);
+            ++stp;
             return idx;
         }
     }
@@ -93,6 +96,7 @@ void PropertyList::complete(SimulProp const* sp)
 {
     for ( const_iterator n = vec.begin(); n != vec.end(); ++n )
         (*n)->complete(sp, this);
+    ++stp;
 }
 
 int PropertyList::find_index(const Property * p) const
@@ -29,10 +29,13 @@ private:
     /// list of non-null pointers to Properties
     vec_type vec;
     
+    /// counter incremented every time the list or one of its Property is modified
+    unsigned stp;
+    
 public:
     
     /// constructor
-    PropertyList()   { }
+    PropertyList() : stp(0) { }
     
     /// destructor forget things without deleting objects
     ~PropertyList()  { }
@@ -43,7 +46,7 @@ public:
     void         deposit(Property * p, bool refuse_duplicate = true);
     
     /// push a new Property in the list
-    void         push_back(Property * p) { vec.push_back(p); }
+    void         push_back(Property * p) { vec.push_back(p); ++stp; }
 
     /// forget pointer to p
     int          remove(Property * p);
@@ -51,6 +54,12 @@ public:
     /// delete all Property
     void         erase();
     
+    /// record that a Property of the list has been modified
+    void         modified() { ++stp; }
+    
+    /// value that changes every time the list or one of its Property is modified
+    unsigned     stamp() const { return stp; }
+    
     /// iterator pointing to first element
     iterator     begin()   { return vec.begin(); }
     
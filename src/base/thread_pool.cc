@@ -0,0 +1,145 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "thread_pool.h"
+#include "exceptions.h"
+
+
+ThreadPool::ThreadPool()
+{
+    mSize       = 1;
+    mThreads    = 0;
+    mSlaves     = 0;
+    mGeneration = 0;
+    mPending    = 0;
+    mQuit       = false;
+    mJob        = 0;
+    mArg        = 0;
+    pthread_mutex_init(&mMutex, 0);
+    pthread_cond_init(&mStart, 0);
+    pthread_cond_init(&mDone, 0);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+    pthread_cond_destroy(&mDone);
+    pthread_cond_destroy(&mStart);
+    pthread_mutex_destroy(&mMutex);
+}
+
+
+void ThreadPool::stop()
+{
+    if ( mThreads )
+    {
+        pthread_mutex_lock(&mMutex);
+        mQuit = true;
+        pthread_cond_broadcast(&mStart);
+        pthread_mutex_unlock(&mMutex);
+
+        for ( unsigned ii = 1; ii < mSize; ++ii )
+            pthread_join(mThreads[ii], 0);
+
+        delete[] mThreads;
+        delete[] mSlaves;
+        mThreads = 0;
+        mSlaves  = 0;
+        mQuit    = false;
+    }
+    mSize = 1;
+}
+
+
+/**
+ The slave threads are all started with a copy of the current generation,
+ and they will execute the job when the generation is incremented by run().
+ */
+void ThreadPool::resize(unsigned cnt)
+{
+    if ( cnt < 1 )
+        cnt = 1;
+
+    if ( cnt == mSize )
+        return;
+
+    stop();
+
+    if ( cnt > 1 )
+    {
+        mThreads = new pthread_t[cnt];
+        mSlaves  = new Slave[cnt];
+        for ( unsigned ii = 1; ii < cnt; ++ii )
+        {
+            mSlaves[ii].pool       = this;
+            mSlaves[ii].rank       = ii;
+            mSlaves[ii].generation = mGeneration;
+            if ( pthread_create(mThreads+ii, 0, &work, mSlaves+ii) )
+            {
+                // keep the threads that were successfully created:
+                mSize = ii;
+                throw Exception("failed to create thread");
+            }
+            mSize = ii + 1;
+        }
+    }
+}
+
+
+void* ThreadPool::work(void * arg)
+{
+    Slave * slave = static_cast<Slave*>(arg);
+    ThreadPool * pool = slave->pool;
+    unsigned gen = slave->generation;
+
+    pthread_mutex_lock(&pool->mMutex);
+    while ( 1 )
+    {
+        while ( pool->mGeneration == gen && !pool->mQuit )
+            pthread_cond_wait(&pool->mStart, &pool->mMutex);
+
+        if ( pool->mQuit )
+            break;
+
+        gen = pool->mGeneration;
+        Job job = pool->mJob;
+        void * jarg = pool->mArg;
+        const unsigned size = pool->mSize;
+        pthread_mutex_unlock(&pool->mMutex);
+
+        job(jarg, slave->rank, size);
+
+        pthread_mutex_lock(&pool->mMutex);
+        if ( --pool->mPending == 0 )
+            pthread_cond_signal(&pool->mDone);
+    }
+    pthread_mutex_unlock(&pool->mMutex);
+    return 0;
+}
+
+
+void ThreadPool::run(Job job, void* arg)
+{
+    if ( mSize < 2 )
+    {
+        job(arg, 0, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&mMutex);
+    mJob     = job;
+    mArg     = arg;
+    mPending = mSize - 1;
+    ++mGeneration;
+    pthread_cond_broadcast(&mStart);
+    pthread_mutex_unlock(&mMutex);
+
+    // the calling thread does its share of the work:
+    job(arg, 0, mSize);
+
+    pthread_mutex_lock(&mMutex);
+    while ( mPending > 0 )
+        pthread_cond_wait(&mDone, &mMutex);
+    pthread_mutex_unlock(&mMutex);
+}
+
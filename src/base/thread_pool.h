@@ -0,0 +1,103 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+
+/// A fixed team of threads that can execute the same job in parallel
+/**
+ ThreadPool holds ( size() - 1 ) slave threads, which are sleeping until
+ run() is called. The calling thread takes the role of the thread of rank 0,
+ such that a pool of size 1 does not create any thread at all.
+
+ run(job, arg) calls `job(arg, rank, size)` from every thread,
+ with a different `rank` in [0, size-1], and returns when all calls have completed.
+ The job should use `rank` to decide which part of the work it should do,
+ and it should not throw exceptions.
+
+ The threads are created by resize() and terminated by the destructor.
+ */
+class ThreadPool
+{
+public:
+
+    /// type of the function executed by the threads
+    typedef void (*Job)(void* arg, unsigned rank, unsigned size);
+
+private:
+
+    /// holds the arguments passed to a slave thread
+    struct Slave
+    {
+        ThreadPool * pool;
+        unsigned     rank;
+        unsigned     generation;
+    };
+
+    /// number of threads, including the calling thread
+    unsigned        mSize;
+
+    /// slave threads
+    pthread_t     * mThreads;
+
+    /// arguments passed to the slave threads
+    Slave         * mSlaves;
+
+    /// mutex guarding the variables below
+    pthread_mutex_t mMutex;
+
+    /// condition used to start the slave threads
+    pthread_cond_t  mStart;
+
+    /// condition used to signal the completion of the slave threads
+    pthread_cond_t  mDone;
+
+    /// incremented every time a new job is started
+    unsigned        mGeneration;
+
+    /// number of slave threads that have not yet completed the current job
+    unsigned        mPending;
+
+    /// true if the slave threads should terminate
+    bool            mQuit;
+
+    /// the current job
+    Job             mJob;
+
+    /// the argument of the current job
+    void          * mArg;
+
+    /// terminate all slave threads
+    void            stop();
+
+    /// loop executed by the slave threads
+    static void*    work(void*);
+
+    /// Disabled copy constructor
+    ThreadPool(ThreadPool const&);
+
+    /// Disabled copy assignment
+    ThreadPool& operator=(ThreadPool const&);
+
+public:
+
+    /// create a pool containing only the calling thread
+    ThreadPool();
+
+    /// terminates all threads
+    ~ThreadPool();
+
+    /// number of threads, including the calling thread
+    unsigned size() const { return mSize; }
+
+    /// set the number of threads, including the calling thread
+    void     resize(unsigned);
+
+    /// call `job(arg, rank, size())` from all threads, and wait for completion
+    void     run(Job job, void* arg);
+
+};
+
+#endif
@@ -0,0 +1,83 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+
+/// Three buffers used to pass data from one thread to another, without locking
+/**
+ One thread (the producer) fills writeBuffer() and calls publish(),
+ while another thread (the consumer) calls acquire() and reads readBuffer().
+
+ The buffers are never copied: publish() and acquire() only exchange their indices
+ with a 'middle' slot, using an atomic compare-and-swap. Hence none of the threads
+ can be blocked by the other, and the consumer always gets the last published data.
+ Data that are published while the consumer is busy are simply overwritten.
+
+ There should only be one producer and one consumer.
+ This relies on the GCC atomic builtins, which are also supported by Clang.
+ */
+template < typename T >
+class TripleBuffer
+{
+    /// bit set in `middle` if its buffer has been published but not yet acquired
+    static const int FRESH = 4;
+
+    /// the buffers
+    T            buf[3];
+
+    /// index of the buffer being written, only used by the producer
+    int          back;
+
+    /// index of the buffer being read, only used by the consumer
+    int          front;
+
+    /// index of the buffer in transit, with the FRESH bit
+    volatile int middle;
+
+    /// atomically replace `middle` by `val`, returning the previous value
+    int exchange(int val)
+    {
+        int old;
+        do {
+            old = middle;
+        } while ( !__sync_bool_compare_and_swap(&middle, old, val) );
+        return old;
+    }
+
+    /// disabled copy constructor
+    TripleBuffer(TripleBuffer const&);
+
+    /// disabled assignment
+    TripleBuffer& operator =(TripleBuffer const&);
+
+public:
+
+    /// constructor
+    TripleBuffer() : back(0), front(1), middle(2) {}
+
+    /// the buffer that the producer may write
+    T&       writeBuffer()       { return buf[back]; }
+
+    /// make the buffer that was written available to the consumer
+    void     publish()           { back = exchange(back|FRESH) & 3; }
+
+    /// true if data was published since the last call to acquire()
+    bool     fresh()       const { return middle & FRESH; }
+
+    /// get the last published buffer, returning false if there was nothing new
+    bool     acquire()
+    {
+        // only acquire() can clear the FRESH bit:
+        if ( !( middle & FRESH ) )
+            return false;
+        front = exchange(front) & 3;
+        return true;
+    }
+
+    /// the buffer that the consumer may read, as set by the last acquire()
+    T const& readBuffer()  const { return buf[front]; }
+};
+
+#endif
+
@@ -0,0 +1,79 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+
+#ifndef CONJGRAD_H
+#define CONJGRAD_H
+
+#include <cmath>
+#include "bicgstab.h"
+
+
+namespace Solver
+{
+
+    /// Conjugate Gradient with Preconditionning, for symmetric positive definite systems
+    /**
+     This is the standard algorithm, see for example
+     Y. Saad, `Iterative Methods for Sparse Linear Systems', 2nd ed. SIAM 2003, Algorithm 9.1.
+
+     The matrix and the preconditionner must both be symmetric and positive definite.
+     Every iteration performs one multiplication and one preconditionning.
+     This uses 4 vectors.
+     */
+    template < typename LinearOperator, typename Monitor, typename Allocator >
+    void PCG(const LinearOperator& mat, const real* rhs, real* x, Monitor& monitor, Allocator& allocator)
+    {
+        const unsigned int size = mat.size();
+        allocator.allocate(size, 4);
+        real * r = allocator.bind(0);
+        real * z = allocator.bind(1);
+        real * p = allocator.bind(2);
+        real * q = allocator.bind(3);
+
+        blas_xcopy(size, rhs, 1, r, 1);
+        mat.multiply(x, q);
+        blas_xaxpy(size, -1.0, q, 1, r, 1);       // r = rhs - A * x
+
+        mat.precondition(r, z);                   // z = P * r
+        blas_xcopy(size, z, 1, p, 1);             // p = z
+        double rho = DOT(size, r, 1, z, 1);
+
+        while ( ! monitor.finished(size, r) )
+        {
+            mat.multiply(p, q);                   // q = A * p
+
+            double pq = DOT(size, p, 1, q, 1);
+
+            if ( pq == 0.0 )
+            {
+                monitor.finished(2, size, r);
+                break;
+            }
+
+            double alpha = rho / pq;
+            blas_xaxpy(size,  alpha, p, 1, x, 1); // x = x + alpha * p
+            blas_xaxpy(size, -alpha, q, 1, r, 1); // r = r - alpha * q
+
+            mat.precondition(r, z);               // z = P * r
+            double rho_new = DOT(size, r, 1, z, 1);
+            double beta = rho_new / rho;
+            rho = rho_new;
+
+            // p = z + beta * p
+#ifdef __INTEL_MKL__
+            blas_xaxpby(size, 1.0, z, 1, beta, p, 1);
+#else
+            blas_xscal(size, beta, p, 1);
+            blas_xaxpy(size, 1.0, z, 1, p, 1);
+#endif
+
+            ++monitor;
+        }
+
+        allocator.relax();
+    }
+
+}
+
+#endif
+
@@ -0,0 +1,144 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+
+#ifndef GMRES_H
+#define GMRES_H
+
+#include <cmath>
+#include "bicgstab.h"
+
+
+namespace Solver
+{
+
+    /// Restarted Generalized Minimal Residual, with right Preconditionning
+    /**
+     GMRES(dim) builds an orthonormal basis of the Krylov space with the modified
+     Gram-Schmidt method, and is restarted every `dim` iterations.
+     Each iteration performs one multiplication and one preconditionning,
+     but the cost of orthogonalization increases with the size of the basis.
+     This uses `dim+2` vectors.
+
+     Within a cycle, the residual is not calculated explicitly, and its Euclidian norm,
+     which is known from the Givens rotations, is compared to the threshold of the Monitor.
+     The Monitor is called with the true residual at the end of each cycle.
+
+     Y. Saad and M. H. Schultz, SIAM J. Sci. Stat. Comput. 7, 1986
+     */
+    template < typename LinearOperator, typename Monitor, typename Allocator >
+    void GMRES(const LinearOperator& mat, const real* rhs, real* x, Monitor& monitor, Allocator& allocator, unsigned dim)
+    {
+        if ( dim < 1 )
+            dim = 1;
+
+        const unsigned int size = mat.size();
+        allocator.allocate(size, dim+2);
+        real * r = allocator.bind(dim+1);
+
+        // Hessenberg matrix stored by columns, rotations and right-hand side:
+        double * H  = new double[(dim+1)*(dim+4)];
+        double * cs = H + (dim+1) * dim;
+        double * sn = cs + dim + 1;
+        double * g  = sn + dim + 1;
+
+        mat.multiply(x, r);
+        for ( unsigned i = 0; i < size; ++i )
+            r[i] = rhs[i] - r[i];                       // r = rhs - A * x
+
+        while ( ! monitor.finished(size, r) )
+        {
+            double beta = blas_xnrm2(size, r, 1);
+            if ( beta == 0.0 )
+                break;
+
+            real * v = allocator.bind(0);
+            for ( unsigned i = 0; i < size; ++i )
+                v[i] = r[i] / beta;
+
+            g[0] = beta;
+            unsigned k = 0;
+            bool breakdown = false;
+            while ( k < dim )
+            {
+                double * h = H + (dim+1) * k;
+                real * vk = allocator.bind(k);
+                real * vn = allocator.bind(k+1);
+
+                mat.precondition(vk, r);                // r = PC * v(k)
+                mat.multiply(r, vn);                    // v(k+1) = A * r
+
+                for ( unsigned j = 0; j <= k; ++j )
+                {
+                    real * vj = allocator.bind(j);
+                    h[j] = DOT(size, vj, 1, vn, 1);
+                    blas_xaxpy(size, -h[j], vj, 1, vn, 1);
+                }
+                h[k+1] = blas_xnrm2(size, vn, 1);
+
+                if ( h[k+1] != 0.0 )
+                    blas_xscal(size, 1.0/h[k+1], vn, 1);
+
+                // apply the previous rotations to the new column:
+                for ( unsigned j = 0; j < k; ++j )
+                {
+                    double a = h[j], b = h[j+1];
+                    h[j]   =  cs[j] * a + sn[j] * b;
+                    h[j+1] = -sn[j] * a + cs[j] * b;
+                }
+
+                // calculate the rotation that eliminates h[k+1]:
+                double n = sqrt( h[k] * h[k] + h[k+1] * h[k+1] );
+                if ( n == 0.0 )
+                {
+                    // the first `k` directions of this cycle are still applied below:
+                    breakdown = true;
+                    break;
+                }
+                cs[k] = h[k] / n;
+                sn[k] = h[k+1] / n;
+                h[k] = n;
+                h[k+1] = 0;
+                g[k+1] = -sn[k] * g[k];
+                g[k]   =  cs[k] * g[k];
+
+                ++k;
+                ++monitor;
+
+                if ( fabs(g[k]) < monitor.threshold() )
+                    break;
+            }
+
+            // solve the upper triangular system H * y = g, in place in g:
+            for ( unsigned j = k; j-- > 0; )
+            {
+                double sum = g[j];
+                for ( unsigned i = j+1; i < k; ++i )
+                    sum -= H[j+(dim+1)*i] * g[i];
+                g[j] = sum / H[j+(dim+1)*j];
+            }
+
+            // x = x + PC * ( V * y )
+            blas_xzero(size, r);
+            for ( unsigned j = 0; j < k; ++j )
+                blas_xaxpy(size, g[j], allocator.bind(j), 1, r, 1);
+            real * u = allocator.bind(0);
+            mat.precondition(r, u);
+            blas_xaxpy(size, 1.0, u, 1, x, 1);
+
+            mat.multiply(x, r);
+            for ( unsigned i = 0; i < size; ++i )
+                r[i] = rhs[i] - r[i];                   // r = rhs - A * x
+
+            if ( breakdown )
+            {
+                monitor.finished(4, size, r);
+                break;
+            }
+        }
+
+        delete[] H;
+        allocator.relax();
+    }
+};
+
+#endif
@@ -0,0 +1,182 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+
+#ifndef IDRS_H
+#define IDRS_H
+
+#include <cmath>
+#include "bicgstab.h"
+
+
+namespace Solver
+{
+
+    /// Induced Dimension Reduction IDR(s), with right Preconditionning
+    /**
+     This is the variant with biorthogonalization of
+     M. B. van Gijzen and P. Sonneveld, `Algorithm 913: An Elegant IDR(s) Variant that
+     Efficiently Exploits Biorthogonality Properties', ACM Trans. Math. Softw. 38, 2011.
+
+     Every iteration performs one multiplication and one preconditionning,
+     and the residual is updated at every iteration.
+     IDR(1) is mathematically equivalent to BiCGStab, and larger values of `dim`
+     usually reduce the number of multiplications needed to converge.
+     This uses 3*dim+3 vectors.
+
+     The `dim` shadow vectors are generated by a fixed pseudo-random sequence,
+     such that the global random number generator is not used.
+     */
+    template < typename LinearOperator, typename Monitor, typename Allocator >
+    void IDRS(const LinearOperator& mat, const real* rhs, real* x, Monitor& monitor, Allocator& allocator, unsigned dim)
+    {
+        if ( dim < 1 )
+            dim = 1;
+
+        const unsigned int size = mat.size();
+        allocator.allocate(size, 3*dim+3);
+        real * r = allocator.bind(0);
+        real * v = allocator.bind(1);
+        real * t = allocator.bind(2);
+        real * P = allocator.bind(3);
+        real * G = allocator.bind(3+dim);
+        real * U = allocator.bind(3+2*dim);
+        // the vectors are aligned, and spaced by the same amount:
+        const size_t ld = allocator.bind(1) - r;
+
+        // small matrix M(i,j) = M[i+dim*j], and vectors f and c:
+        double * M = new double[dim*(dim+2)];
+        double * f = M + dim * dim;
+        double * c = f + dim;
+
+        // shadow space, orthonormalized with the modified Gram-Schmidt method:
+        unsigned long seed = 1;
+        for ( unsigned k = 0; k < dim; ++k )
+        {
+            real * pk = P + ld * k;
+            for ( unsigned i = 0; i < size; ++i )
+            {
+                seed = seed * 1103515245UL + 12345UL;
+                pk[i] = real( ( seed >> 16 ) & 32767 ) / 16384.0 - 1.0;
+            }
+            for ( unsigned j = 0; j < k; ++j )
+                blas_xaxpy(size, -DOT(size, P+ld*j, 1, pk, 1), P+ld*j, 1, pk, 1);
+            blas_xscal(size, 1.0/blas_xnrm2(size, pk, 1), pk, 1);
+        }
+
+        for ( unsigned k = 0; k < dim; ++k )
+        {
+            blas_xzero(size, G+ld*k);
+            blas_xzero(size, U+ld*k);
+            for ( unsigned j = 0; j < dim; ++j )
+                M[j+dim*k] = ( j == k );
+        }
+
+        mat.multiply(x, t);
+        for ( unsigned i = 0; i < size; ++i )
+            r[i] = rhs[i] - t[i];                       // r = rhs - A * x
+
+        double omega = 1.0;
+
+        while ( ! monitor.finished(size, r) )
+        {
+            for ( unsigned j = 0; j < dim; ++j )
+                f[j] = DOT(size, P+ld*j, 1, r, 1);
+
+            for ( unsigned k = 0; k < dim; ++k )
+            {
+                // solve the lower triangular system M(k:s,k:s) * c = f(k:s)
+                for ( unsigned i = k; i < dim; ++i )
+                {
+                    double sum = f[i];
+                    for ( unsigned j = k; j < i; ++j )
+                        sum -= M[i+dim*j] * c[j];
+                    c[i] = sum / M[i+dim*i];
+                }
+
+                // v = r - G(:,k:s) * c
+                blas_xcopy(size, r, 1, v, 1);
+                for ( unsigned j = k; j < dim; ++j )
+                    blas_xaxpy(size, -c[j], G+ld*j, 1, v, 1);
+
+                real * uk = U + ld * k;
+                real * gk = G + ld * k;
+
+                // U(:,k) = U(:,k:s) * c + omega * PC * v
+                mat.precondition(v, t);
+                blas_xscal(size, c[k], uk, 1);
+                blas_xaxpy(size, omega, t, 1, uk, 1);
+                for ( unsigned j = k+1; j < dim; ++j )
+                    blas_xaxpy(size, c[j], U+ld*j, 1, uk, 1);
+                mat.multiply(uk, gk);                   // G(:,k) = A * U(:,k)
+
+                // make G(:,k) orthogonal to P(:,1:k-1)
+                for ( unsigned j = 0; j < k; ++j )
+                {
+                    double a = DOT(size, P+ld*j, 1, gk, 1) / M[j+dim*j];
+                    blas_xaxpy(size, -a, G+ld*j, 1, gk, 1);
+                    blas_xaxpy(size, -a, U+ld*j, 1, uk, 1);
+                }
+
+                for ( unsigned j = k; j < dim; ++j )
+                    M[j+dim*k] = DOT(size, P+ld*j, 1, gk, 1);
+
+                if ( M[k+dim*k] == 0.0 )
+                {
+                    monitor.finished(4, size, r);
+                    delete[] M;
+                    allocator.relax();
+                    return;
+                }
+
+                // make r orthogonal to P(:,1:k)
+                double beta = f[k] / M[k+dim*k];
+                blas_xaxpy(size, -beta, gk, 1, r, 1);
+                blas_xaxpy(size,  beta, uk, 1, x, 1);
+
+                ++monitor;
+                if ( monitor.finished(size, r) )
+                {
+                    delete[] M;
+                    allocator.relax();
+                    return;
+                }
+
+                for ( unsigned j = k+1; j < dim; ++j )
+                    f[j] -= beta * M[j+dim*k];
+            }
+
+            // enter the next space: reduce the dimension
+            mat.precondition(r, v);
+            mat.multiply(v, t);
+
+            double tt = DOT(size, t, 1, t, 1);
+            double tr = DOT(size, t, 1, r, 1);
+            if ( tt == 0.0 )
+            {
+                monitor.finished(0, size, r);
+                break;
+            }
+            omega = tr / tt;
+
+            if ( omega == 0.0 )
+            {
+                monitor.finished(3, size, r);
+                break;
+            }
+
+            // limit the angle between t and r, to avoid stagnation:
+            double rho = fabs(tr) / sqrt( tt * DOT(size, r, 1, r, 1) );
+            if ( rho < 0.7 )
+                omega *= 0.7 / rho;
+
+            blas_xaxpy(size, -omega, t, 1, r, 1);       // r = r - omega * t
+            blas_xaxpy(size,  omega, v, 1, x, 1);       // x = x + omega * v
+            ++monitor;
+        }
+
+        delete[] M;
+        allocator.relax();
+    }
+};
+
+#endif
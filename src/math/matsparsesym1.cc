@@ -28,12 +28,26 @@ MatrixSparseSymmetric1::MatrixSparseSymmetric1()
     ija     = 0;
     sa      = 0;
 #endif
+    
+    rowMax  = 0;
+    rowS    = 0;
+    rowJ    = 0;
+    rowV    = 0;
+    rowK    = 0;
+    
+    newPattern      = true;
+    newPatternLines = true;
 }
 
 
 
 void MatrixSparseSymmetric1::allocate( const unsigned int sz )
 {
+    if ( sz != mxSize )
+    {
+        newPattern      = true;
+        newPatternLines = true;
+    }
     mxSize = sz;
     if ( mxSize > mxAllocated )
     {
@@ -70,6 +84,12 @@ void MatrixSparseSymmetric1::allocate( const unsigned int sz )
 #ifdef MATRIX_OPTIMIZE_MULTIPLY
         setColF(true);
 #endif
+        // this will be reallocated by prepareForMultiplyLines():
+        if ( rowS )
+        {
+            delete[] rowS;
+            rowS = 0;
+        }
     }
 }
 
@@ -90,6 +110,11 @@ void MatrixSparseSymmetric1::deallocate()
         delete[] colF;      colF = 0;
 #endif
     }
+    if ( rowS )  { delete[] rowS;  rowS = 0; }
+    if ( rowJ )  { delete[] rowJ;  rowJ = 0; }
+    if ( rowV )  { delete[] rowV;  rowV = 0; }
+    if ( rowK )  { delete[] rowK;  rowK = 0; }
+    rowMax = 0;
     mxAllocated = 0;
 }
 
@@ -153,6 +178,8 @@ real& MatrixSparseSymmetric1::operator()( index_type ii, index_type jj )
     //check if the column is empty:
     if ( colSize[jj] == 0 )
     {
+        newPattern      = true;
+        newPatternLines = true;
         c = allocateColumn( jj, 2 );
         
         //diagonal term always first:
@@ -200,6 +227,8 @@ real& MatrixSparseSymmetric1::operator()( index_type ii, index_type jj )
     }
     
     int indx = e - c;
+    newPattern      = true;
+    newPatternLines = true;
     
     //allocate space for new Element if necessary:
     if ( colMax[jj] <= colSize[jj] )
@@ -247,9 +276,76 @@ void MatrixSparseSymmetric1::makeZero()
 {
     for ( unsigned int ii = 0; ii < mxSize; ++ii )
         colSize[ii] = 0;
+    newPattern      = true;
+    newPatternLines = true;
 }
 
 
+/**
+ The pattern of elements is kept, and all the values are set to zero.
+ Elements that are not set again before prepareForMultiply() will be removed then.
+ */
+void MatrixSparseSymmetric1::resetValues()
+{
+    for ( index_type jj = 0; jj < mxSize; ++jj )
+    {
+        Element * c = col[jj];
+        unsigned int n = 0;
+        for ( unsigned int kk = 0; kk < colSize[jj]; ++kk )
+        {
+            // elements outside the current size of the matrix are removed:
+            if ( c[kk].line < mxSize )
+            {
+                c[n].line = c[kk].line;
+                c[n].val  = 0;
+                ++n;
+            }
+        }
+        if ( n != colSize[jj] )
+        {
+            colSize[jj]     = n;
+            newPattern      = true;
+            newPatternLines = true;
+        }
+    }
+    // forget the columns beyond the size of the matrix:
+    for ( index_type jj = mxSize; jj < mxAllocated; ++jj )
+        colSize[jj] = 0;
+}
+
+
+/**
+ Remove the off-diagonal elements equal to zero, and the columns that contain only zeros.
+ This is necessary after resetValues(), since elements may not have been set again.
+ */
+void MatrixSparseSymmetric1::removeZeros()
+{
+    for ( index_type jj = 0; jj < mxSize; ++jj )
+    {
+        Element * c = col[jj];
+        if ( colSize[jj] == 0 )
+            continue;
+        unsigned int n = 1;
+        for ( unsigned int kk = 1; kk < colSize[jj]; ++kk )
+        {
+            if ( c[kk].val != 0 )
+            {
+                if ( n < kk )
+                    c[n] = c[kk];
+                ++n;
+            }
+        }
+        if ( n == 1  &&  c[0].val == 0 )
+            n = 0;
+        if ( n != colSize[jj] )
+        {
+            colSize[jj]     = n;
+            newPattern      = true;
+            newPatternLines = true;
+        }
+    }
+}
+
 
 void MatrixSparseSymmetric1::scale( const real a )
 {
@@ -471,6 +567,27 @@ void MatrixSparseSymmetric1::setColF(bool alloc)
 
 void MatrixSparseSymmetric1::prepareForMultiply()
 {
+    removeZeros();
+
+    if ( !newPattern )
+    {
+        //the indices are unchanged, and only the values need to be copied:
+        index_type kk = mxSize;
+        for ( unsigned int jj = 0; jj < mxSize; ++jj )
+        {
+            if ( colSize[jj] > 0 )
+            {
+                sa[jj] = col[jj][0].val;
+                for ( unsigned int cc = 1; cc < colSize[jj]; ++cc )
+                    sa[++kk] = col[jj][cc].val;
+            }
+            else
+                sa[jj] = 0;
+        }
+        assert_true( kk+1 == ija[mxSize] );
+        return;
+    }
+    
     setColF(false);
     
     //count number of non-zero elements, including diagonal
@@ -520,6 +637,7 @@ void MatrixSparseSymmetric1::prepareForMultiply()
         ija[jj+1] = kk+1;
     }
     assert_true( kk+1 == nbe );
+    newPattern = false;
 }
 
 
@@ -632,3 +750,150 @@ void MatrixSparseSymmetric1::vecMulAddIso3D( const real* X, real* Y ) const
 
 #endif
 
+
+//------------------------------------------------------------------------------
+#pragma mark - Storage by lines
+
+/**
+ Build a copy of the full symmetric matrix, in which the elements are stored by lines.
+ This uses twice more memory than the storage of the lower triangle, 
+ but the lines can be multiplied independently, without writing outside the
+ range of lines being calculated.
+ This must be called after prepareForMultiply(), and if the pattern of elements
+ has not changed, only the values are copied from sa[].
+ */
+void MatrixSparseSymmetric1::prepareForMultiplyLines()
+{
+#ifdef MATRIX_OPTIMIZE_MULTIPLY
+    assert_true( !newPattern );
+    if ( !newPatternLines )
+    {
+        //the indices are unchanged, and only the values need to be copied:
+        const index_type end = rowS[mxSize];
+        for ( index_type n = 0; n < end; ++n )
+            rowV[n] = sa[rowK[n]];
+        return;
+    }
+#endif
+    
+    if ( rowS == 0 )
+        rowS = new index_type[mxAllocated+1];
+    
+    //count number of elements in each line:
+    for ( index_type jj = 0; jj <= mxSize; ++jj )
+        rowS[jj] = 0;
+    
+    for ( index_type jj = 0; jj < mxSize; ++jj )
+    {
+        rowS[jj+1] += colSize[jj];
+        for ( unsigned int kk = 1; kk < colSize[jj]; ++kk )
+            ++rowS[col[jj][kk].line+1];
+    }
+    
+    for ( index_type jj = 0; jj < mxSize; ++jj )
+        rowS[jj+1] += rowS[jj];
+    
+    const unsigned int nbe = rowS[mxSize];
+    
+    if ( nbe > rowMax )
+    {
+        if ( rowJ )  delete[] rowJ;
+        if ( rowV )  delete[] rowV;
+        if ( rowK )  delete[] rowK;
+        rowMax = nbe + mxSize;
+        rowJ   = new index_type[rowMax];
+        rowV   = new real[rowMax];
+        rowK   = new index_type[rowMax];
+    }
+    
+    //distribute the elements, using rowS[] as a moving insertion point:
+    for ( index_type jj = 0; jj < mxSize; ++jj )
+    {
+        for ( unsigned int kk = 0; kk < colSize[jj]; ++kk )
+        {
+            const index_type ii = col[jj][kk].line;
+            const real a = col[jj][kk].val;
+#ifdef MATRIX_OPTIMIZE_MULTIPLY
+            // index of the element in sa[]:
+            const index_type k = ( kk > 0 ) ? ija[jj] + kk - 1 : jj;
+#else
+            const index_type k = 0;
+#endif
+            index_type n = rowS[jj]++;
+            rowJ[n] = ii;
+            rowV[n] = a;
+            rowK[n] = k;
+            if ( ii != jj )
+            {
+                n = rowS[ii]++;
+                rowJ[n] = jj;
+                rowV[n] = a;
+                rowK[n] = k;
+            }
+        }
+    }
+    
+    //restore the start of the lines:
+    for ( index_type jj = mxSize; jj > 0; --jj )
+        rowS[jj] = rowS[jj-1];
+    rowS[0] = 0;
+    assert_true( rowS[mxSize] == nbe );
+    newPatternLines = false;
+}
+
+
+void MatrixSparseSymmetric1::vecMulAdd( const real* X, real* Y, index_type start, const index_type stop ) const
+{
+    assert_true( stop <= mxSize );
+    for ( ; start < stop; ++start )
+    {
+        real Y0 = 0;
+        const index_type end = rowS[start+1];
+        for ( index_type kk = rowS[start]; kk < end; ++kk )
+            Y0 += rowV[kk] * X[rowJ[kk]];
+        Y[start] += Y0;
+    }
+}
+
+
+void MatrixSparseSymmetric1::vecMulAddIso2D( const real* X, real* Y, index_type start, const index_type stop ) const
+{
+    assert_true( stop <= mxSize );
+    for ( ; start < stop; ++start )
+    {
+        real Y0 = 0, Y1 = 0;
+        const index_type end = rowS[start+1];
+        for ( index_type kk = rowS[start]; kk < end; ++kk )
+        {
+            const real a = rowV[kk];
+            const real* x = X + 2 * rowJ[kk];
+            Y0 += a * x[0];
+            Y1 += a * x[1];
+        }
+        Y[2*start  ] += Y0;
+        Y[2*start+1] += Y1;
+    }
+}
+
+
+void MatrixSparseSymmetric1::vecMulAddIso3D( const real* X, real* Y, index_type start, const index_type stop ) const
+{
+    assert_true( stop <= mxSize );
+    for ( ; start < stop; ++start )
+    {
+        real Y0 = 0, Y1 = 0, Y2 = 0;
+        const index_type end = rowS[start+1];
+        for ( index_type kk = rowS[start]; kk < end; ++kk )
+        {
+            const real a = rowV[kk];
+            const real* x = X + 3 * rowJ[kk];
+            Y0 += a * x[0];
+            Y1 += a * x[1];
+            Y2 += a * x[2];
+        }
+        Y[3*start  ] += Y0;
+        Y[3*start+1] += Y1;
+        Y[3*start+2] += Y2;
+    }
+}
+
@@ -13,6 +13,14 @@
  MatrixSparseSymmetric1 uses a sparse storage, with arrays of elements for each column.
  For multiplication, it uses a another format, from Numerical Recipes.
  The conversion is done when prepareForMultiply() is called
+ 
+ A third format holding the full symmetric matrix by lines can be built by
+ prepareForMultiplyLines(). A range of lines can then be multiplied independently,
+ allowing different threads to calculate different parts of the result.
+ 
+ resetValues() can be called instead of makeZero() to keep the pattern of 
+ elements. If the same elements are set again, no allocation is needed, and 
+ the conversions only copy the values, without rebuilding the indices.
 */
 class MatrixSparseSymmetric1 : public Matrix
 {
@@ -48,6 +56,9 @@ private:
     
     void printColumn( index_type );
     
+    /// remove elements that are zero
+    void removeZeros();
+    
 #ifdef MATRIX_OPTIMIZE_MULTIPLY
     ///colF[ii] is the index of the first non-empty column of index >= ii
     index_type  * colF;
@@ -61,6 +72,27 @@ private:
     void setColF(bool);    
 #endif
     
+    /// amount of memory allocated for the storage by lines
+    unsigned int  rowMax;
+    
+    /// rowS[ii] is the index in rowJ[] and rowV[] of the first element of line 'ii'
+    index_type  * rowS;
+    
+    /// column index of the elements stored by lines
+    index_type  * rowJ;
+    
+    /// values of the elements stored by lines
+    real        * rowV;
+    
+    /// index in sa[] of the elements stored by lines
+    index_type  * rowK;
+    
+    /// true if the pattern of elements was modified since the last prepareForMultiply()
+    bool          newPattern;
+    
+    /// true if the pattern of elements was modified since the last prepareForMultiplyLines()
+    bool          newPatternLines;
+    
 public:
     
     //size of (square) matrix
@@ -78,6 +110,9 @@ public:
     /// set all the element to zero
     void makeZero();
     
+    /// set all the element to zero, keeping the pattern of elements
+    void resetValues();
+    
     /// allocate the matrix to hold ( sz * sz )
     void allocate( unsigned int sz );
         
@@ -108,6 +143,21 @@ public:
     /// 3D isotropic multiplication of a vector: Y = Y + M * X
     void vecMulAddIso3D( const real* X, real* Y ) const;
     
+    /// build the storage by lines, needed to multiply a subset of lines
+    void prepareForMultiplyLines();
+    
+    /// number of elements stored for lines [start, stop), after prepareForMultiplyLines()
+    unsigned int nbElementsInLines( index_type start, index_type stop ) const { return rowS[stop] - rowS[start]; }
+    
+    /// multiplication restricted to lines [start, stop): Y = Y + M * X
+    void vecMulAdd( const real* X, real* Y, index_type start, index_type stop ) const;
+    
+    /// 2D isotropic multiplication restricted to lines [start, stop): Y = Y + M * X
+    void vecMulAddIso2D( const real* X, real* Y, index_type start, index_type stop ) const;
+    
+    /// 3D isotropic multiplication restricted to lines [start, stop): Y = Y + M * X
+    void vecMulAddIso3D( const real* X, real* Y, index_type start, index_type stop ) const;
+    
     /// true if matrix is non-zero
     bool nonZero() const;
     
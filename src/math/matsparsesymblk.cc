@@ -0,0 +1,903 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "matsparsesymblk.h"
+#include "cblas.h"
+#include "smath.h"
+
+#include <iomanip>
+#include <sstream>
+
+#define MATRIX_USES_INTEL_SSE3 defined(__SSE3__) &&  !defined(REAL_IS_FLOAT)
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Block operations
+
+/// Y <- Y + B * X, for a block B of size BS*BS stored column-major
+template < unsigned BS >
+inline void mulBlock(const real* B, const real* X, real* Y)
+{
+    for ( unsigned b = 0; b < BS; ++b )
+        for ( unsigned a = 0; a < BS; ++a )
+            Y[a] += B[a+BS*b] * X[b];
+}
+
+/// Y <- Y + transpose(B) * X, for a block B of size BS*BS stored column-major
+template < unsigned BS >
+inline void mulBlockT(const real* B, const real* X, real* Y)
+{
+    for ( unsigned b = 0; b < BS; ++b )
+        for ( unsigned a = 0; a < BS; ++a )
+            Y[b] += B[a+BS*b] * X[a];
+}
+
+/// Y <- Y + B * X, where B is applied isotropically to vectors of dimension D
+template < unsigned BS, unsigned D >
+inline void mulBlockIso(const real* B, const real* X, real* Y)
+{
+    for ( unsigned b = 0; b < BS; ++b )
+        for ( unsigned a = 0; a < BS; ++a )
+            for ( unsigned d = 0; d < D; ++d )
+                Y[D*a+d] += B[a+BS*b] * X[D*b+d];
+}
+
+/// Y <- Y + transpose(B) * X, where B is applied isotropically to vectors of dimension D
+template < unsigned BS, unsigned D >
+inline void mulBlockIsoT(const real* B, const real* X, real* Y)
+{
+    for ( unsigned b = 0; b < BS; ++b )
+        for ( unsigned a = 0; a < BS; ++a )
+            for ( unsigned d = 0; d < D; ++d )
+                Y[D*b+d] += B[a+BS*b] * X[D*a+d];
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Allocation
+
+template < unsigned BS >
+MatrixSparseSymmetricBlock<BS>::MatrixSparseSymmetricBlock()
+{
+    mxSize      = 0;
+    mxBlocks    = 0;
+    mxAllocated = 0;
+
+    col     = 0;
+    colSize = 0;
+    colMax  = 0;
+
+    bsrMax  = 0;
+    bsrS    = 0;
+    bsrI    = 0;
+    bsrV    = 0;
+
+    rowMax  = 0;
+    rowS    = 0;
+    rowJ    = 0;
+    rowV    = 0;
+    rowK    = 0;
+
+    newPattern      = true;
+    newPatternLines = true;
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::allocate( const unsigned int sz )
+{
+    assert_true( sz % BS == 0 );
+    if ( sz != mxSize )
+    {
+        newPattern      = true;
+        newPatternLines = true;
+    }
+    mxSize   = sz;
+    mxBlocks = sz / BS;
+    if ( mxBlocks > mxAllocated )
+    {
+        Block ** col_new            = new Block*[mxBlocks];
+        unsigned int * colSize_new  = new unsigned int[mxBlocks];
+        unsigned int * colMax_new   = new unsigned int[mxBlocks];
+
+        unsigned int ii = 0;
+        if ( col )
+        {
+            for ( ; ii < mxAllocated; ++ii )
+            {
+                col_new[ii]     = col[ii];
+                colSize_new[ii] = colSize[ii];
+                colMax_new[ii]  = colMax[ii];
+            }
+            delete[] col;
+            delete[] colSize;
+            delete[] colMax;
+        }
+
+        for ( ; ii < mxBlocks; ++ii )
+        {
+            col_new[ii]     = 0;
+            colSize_new[ii] = 0;
+            colMax_new[ii]  = 0;
+        }
+
+        col         = col_new;
+        colSize     = colSize_new;
+        colMax      = colMax_new;
+        mxAllocated = mxBlocks;
+
+        // these will be reallocated when needed:
+        if ( bsrS ) { delete[] bsrS;  bsrS = 0; }
+        if ( rowS ) { delete[] rowS;  rowS = 0; }
+    }
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::deallocate()
+{
+    if ( col )
+    {
+        for ( unsigned int ii = 0; ii < mxAllocated; ++ii )
+        {
+            if ( col[ii] )
+                delete[] col[ii];
+        }
+        delete[] col;       col     = 0;
+        delete[] colSize;   colSize = 0;
+        delete[] colMax;    colMax  = 0;
+    }
+    if ( bsrS )  { delete[] bsrS;  bsrS = 0; }
+    if ( bsrI )  { delete[] bsrI;  bsrI = 0; }
+    if ( bsrV )  { delete[] bsrV;  bsrV = 0; }
+    if ( rowS )  { delete[] rowS;  rowS = 0; }
+    if ( rowJ )  { delete[] rowJ;  rowJ = 0; }
+    if ( rowV )  { delete[] rowV;  rowV = 0; }
+    if ( rowK )  { delete[] rowK;  rowK = 0; }
+    bsrMax = 0;
+    rowMax = 0;
+    mxAllocated = 0;
+}
+
+
+template < unsigned BS >
+typename MatrixSparseSymmetricBlock<BS>::Block * MatrixSparseSymmetricBlock<BS>::allocateColumn( const index_type jj, unsigned int sz )
+{
+    assert_true( jj < mxBlocks );
+    assert_true( sz > 0 );
+
+    if ( sz > colMax[jj] )
+    {
+        const unsigned chunk = 4;
+        sz = ( sz + chunk - 1 ) & -chunk;
+        Block * col_new = new Block[sz];
+
+        if ( col[jj] )
+        {
+            //copy what is there
+            for ( unsigned int ii = 0; ii < colSize[jj]; ++ii )
+                col_new[ii] = col[jj][ii];
+
+            //release old memory
+            delete[] col[jj];
+        }
+        col[jj]    = col_new;
+        colMax[jj] = sz;
+        return col_new;
+    }
+
+    return col[jj];
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Access
+
+/**
+ As for MatrixSparseSymmetric1, the element (x, y) and (y, x) are the same.
+ The indices are swapped to access the lower triangle, and thus only the lower
+ part of the diagonal blocks is used during assembly.
+ */
+template < unsigned BS >
+real& MatrixSparseSymmetricBlock<BS>::operator()( index_type ii, index_type jj )
+{
+    assert_true( ii < mxSize );
+    assert_true( jj < mxSize );
+
+    //we swap to get the lower side
+    if ( jj > ii )
+    {
+        index_type tmp = ii;
+        ii = jj;
+        jj = tmp;
+    }
+
+    const index_type bi = ii / BS;
+    const index_type bj = jj / BS;
+    const unsigned   ix = ii % BS + BS * ( jj % BS );
+
+    Block * c;
+
+    //check if the column is empty:
+    if ( colSize[bj] == 0 )
+    {
+        newPattern      = true;
+        newPatternLines = true;
+        c = allocateColumn( bj, 2 );
+
+        //diagonal block always first:
+        c->line = bj;
+        for ( unsigned k = 0; k < BS*BS; ++k )
+            c->val[k] = 0.;
+        colSize[bj] = 1;
+
+        if ( bi != bj )
+        {
+            //add the requested block:
+            ++c;
+            c->line = bi;
+            for ( unsigned k = 0; k < BS*BS; ++k )
+                c->val[k] = 0.;
+            colSize[bj] = 2;
+        }
+
+        return c->val[ix];
+    }
+
+    c = col[bj];
+
+    //check if diagonal block is requested
+    if ( bi == bj )
+    {
+        assert_true( c->line == bj );
+        return c->val[ix];
+    }
+
+    Block * e = c + 1;
+    Block * last = c + colSize[bj];
+
+    //the blocks are kept ordered in the column:
+    while ( e < last )
+    {
+        if ( e->line == bi )
+            return e->val[ix];
+        if ( e->line > bi )
+            break;
+        ++e;
+    }
+
+    int indx = e - c;
+    newPattern      = true;
+    newPatternLines = true;
+
+    //allocate space for new Block if necessary:
+    if ( colMax[bj] <= colSize[bj] )
+    {
+        c = allocateColumn( bj, colSize[bj]+1 );
+        assert_true( colMax[bj] > colSize[bj] );
+        e = c + indx;
+    }
+
+    // shift the end of the column
+    for ( int k = colSize[bj]; k > indx; --k )
+        c[k] = c[k-1];
+    ++colSize[bj];
+
+    // add the requested block
+    e->line = bi;
+    for ( unsigned k = 0; k < BS*BS; ++k )
+        e->val[k] = 0.;
+
+    return e->val[ix];
+}
+
+
+template < unsigned BS >
+real* MatrixSparseSymmetricBlock<BS>::addr( index_type ii, index_type jj ) const
+{
+    //we swap to get the order right
+    if ( jj > ii )
+    {
+        index_type tmp = ii;
+        ii  = jj;
+        jj  = tmp;
+    }
+
+    const index_type bi = ii / BS;
+    const index_type bj = jj / BS;
+
+    for ( unsigned int kk = 0; kk < colSize[bj]; ++kk )
+        if ( col[bj][kk].line == bi )
+            return &( col[bj][kk].val[ii%BS+BS*(jj%BS)] );
+
+    return 0;
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::makeZero()
+{
+    for ( unsigned int ii = 0; ii < mxBlocks; ++ii )
+        colSize[ii] = 0;
+    newPattern      = true;
+    newPatternLines = true;
+}
+
+
+/// true if all the values of the block are zero
+template < unsigned BS >
+inline bool zeroBlock(const real* val)
+{
+    for ( unsigned n = 0; n < BS*BS; ++n )
+        if ( val[n] != 0 )
+            return false;
+    return true;
+}
+
+
+/**
+ The pattern of blocks is kept, and all the values are set to zero.
+ Blocks that are not set again before prepareForMultiply() will be removed then.
+ */
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::resetValues()
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        Block * c = col[jj];
+        unsigned int n = 0;
+        for ( unsigned int kk = 0; kk < colSize[jj]; ++kk )
+        {
+            // blocks outside the current size of the matrix are removed:
+            if ( c[kk].line < mxBlocks )
+            {
+                c[n].line = c[kk].line;
+                for ( unsigned k = 0; k < BS*BS; ++k )
+                    c[n].val[k] = 0;
+                ++n;
+            }
+        }
+        if ( n != colSize[jj] )
+        {
+            colSize[jj]     = n;
+            newPattern      = true;
+            newPatternLines = true;
+        }
+    }
+    // forget the columns beyond the size of the matrix:
+    for ( index_type jj = mxBlocks; jj < mxAllocated; ++jj )
+        colSize[jj] = 0;
+}
+
+
+/**
+ Remove the off-diagonal blocks equal to zero, and the columns that contain only zeros.
+ This is necessary after resetValues(), since blocks may not have been set again.
+ */
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::removeZeros()
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        Block * c = col[jj];
+        if ( colSize[jj] == 0 )
+            continue;
+        unsigned int n = 1;
+        for ( unsigned int kk = 1; kk < colSize[jj]; ++kk )
+        {
+            if ( !zeroBlock<BS>(c[kk].val) )
+            {
+                if ( n < kk )
+                    c[n] = c[kk];
+                ++n;
+            }
+        }
+        if ( n == 1  &&  zeroBlock<BS>(c[0].val) )
+            n = 0;
+        if ( n != colSize[jj] )
+        {
+            colSize[jj]     = n;
+            newPattern      = true;
+            newPatternLines = true;
+        }
+    }
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::scale( const real a )
+{
+    for ( unsigned int jj = 0; jj < mxBlocks; ++jj )
+        for ( unsigned int kk = 0; kk < colSize[jj]; ++kk )
+            for ( unsigned int n = 0; n < BS*BS; ++n )
+                col[jj][kk].val[n] *= a;
+}
+
+
+/**
+ Execute CODE for the elements (ii, jj, val) of the lower triangle (ii >= jj),
+ that are in the block-columns and block-lines overlapping [START, STOP)
+ */
+#define FOR_LOWER_ELEMENTS(START, STOP, CODE)                        \
+for ( index_type bj = START / BS; BS * bj < STOP; ++bj )             \
+{                                                                    \
+    for ( unsigned int kk = 0; kk < colSize[bj]; ++kk )              \
+    {                                                                \
+        Block const& blk = col[bj][kk];                              \
+        if ( BS * blk.line >= STOP )                                 \
+            break;                                                   \
+        for ( unsigned b = 0; b < BS; ++b )                          \
+        for ( unsigned a = ( blk.line == bj ? b : 0 ); a < BS; ++a ) \
+        {                                                            \
+            const index_type ii = BS * blk.line + a;                 \
+            const index_type jj = BS * bj + b;                       \
+            const real val = blk.val[a+BS*b];                        \
+            CODE                                                     \
+        }                                                            \
+    }                                                                \
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::addTriangularBlock(real* M, const index_type x, const unsigned int sx ) const
+{
+    assert_true( x + sx <= mxSize );
+
+    FOR_LOWER_ELEMENTS(x, x+sx,
+        if ( x <= jj  &&  ii < x + sx )
+            M[jj-x+sx*(ii-x)] += val;
+    )
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::addDiagonalBlock(real* M, const index_type x, const unsigned int sx ) const
+{
+    assert_true( x + sx <= mxSize );
+
+    FOR_LOWER_ELEMENTS(x, x+sx,
+        if ( x <= jj  &&  ii < x + sx )
+        {
+            M[ii-x+sx*(jj-x)] += val;
+            if ( ii != jj )
+                M[jj-x+sx*(ii-x)] += val;
+        }
+    )
+}
+
+
+template < unsigned BS >
+int MatrixSparseSymmetricBlock<BS>::bad() const
+{
+    if ( mxSize <= 0 ) return 1;
+    for ( unsigned int jj = 0; jj < mxBlocks; ++jj )
+    {
+        if ( colSize[jj] > 0  &&  col[jj][0].line != jj ) return 2;
+        for ( unsigned int kk = 1; kk < colSize[jj]; ++kk )
+        {
+            if ( col[jj][kk].line >= mxBlocks ) return 3;
+            if ( col[jj][kk].line <= col[jj][kk-1].line ) return 4;
+        }
+    }
+    return 0;
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::printSparse(std::ostream & os) const
+{
+    FOR_LOWER_ELEMENTS(0, mxSize,
+        os << ii << " " << jj << " " << std::setprecision(8) << val << std::endl;
+    )
+}
+
+
+template < unsigned BS >
+bool MatrixSparseSymmetricBlock<BS>::nonZero() const
+{
+    for ( unsigned int jj = 0; jj < mxBlocks; ++jj )
+        for ( unsigned int kk = 0; kk < colSize[jj]; ++kk )
+            for ( unsigned int n = 0; n < BS*BS; ++n )
+                if ( col[jj][kk].val[n] )
+                    return true;
+
+    //if here, the matrix is empty
+    return false;
+}
+
+
+template < unsigned BS >
+unsigned int MatrixSparseSymmetricBlock<BS>::nbNonZeroElements() const
+{
+    //all allocated blocks are counted, even if zero
+    unsigned int cnt = 0;
+    for ( unsigned int jj = 0; jj < mxBlocks; ++jj )
+        cnt += colSize[jj];
+    return BS * BS * cnt;
+}
+
+
+template < unsigned BS >
+std::string MatrixSparseSymmetricBlock<BS>::what() const
+{
+    std::ostringstream msg;
+#if MATRIX_USES_INTEL_SSE3
+    msg << "SPSB" << BS << "i (nnz: " << nbNonZeroElements() << ")";
+#else
+    msg << "SPSB" << BS << " (nnz: " << nbNonZeroElements() << ")";
+#endif
+    return msg.str();
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Multiplication
+
+/**
+ Copy the blocks into contiguous memory, in the same order.
+ The diagonal blocks are made symmetric, such that they can be multiplied directly.
+ */
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::prepareForMultiply()
+{
+    removeZeros();
+
+    if ( newPattern )
+    {
+        if ( bsrS == 0 )
+            bsrS = new index_type[mxAllocated+1];
+
+        bsrS[0] = 0;
+        for ( index_type jj = 0; jj < mxBlocks; ++jj )
+            bsrS[jj+1] = bsrS[jj] + colSize[jj];
+
+        const unsigned int nbb = bsrS[mxBlocks];
+
+        if ( nbb > bsrMax )
+        {
+            if ( bsrI )  delete[] bsrI;
+            if ( bsrV )  delete[] bsrV;
+            bsrMax = nbb + mxBlocks;
+            bsrI   = new index_type[bsrMax];
+            bsrV   = new real[BS*BS*bsrMax];
+        }
+    }
+
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        index_type n = bsrS[jj];
+        for ( unsigned int kk = 0; kk < colSize[jj]; ++kk, ++n )
+        {
+            Block const& blk = col[jj][kk];
+            real * dst = bsrV + BS*BS*n;
+            assert_true( newPattern || bsrI[n] == blk.line );
+            bsrI[n] = blk.line;
+            if ( kk == 0 )
+            {
+                // symmetrize the diagonal block, using its lower triangle:
+                assert_true( blk.line == jj );
+                for ( unsigned b = 0; b < BS; ++b )
+                    for ( unsigned a = b; a < BS; ++a )
+                    {
+                        dst[a+BS*b] = blk.val[a+BS*b];
+                        dst[b+BS*a] = blk.val[a+BS*b];
+                    }
+            }
+            else
+            {
+                for ( unsigned k = 0; k < BS*BS; ++k )
+                    dst[k] = blk.val[k];
+            }
+        }
+    }
+    newPattern = false;
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::vecMulAdd( const real* X, real* Y ) const
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        const index_type start = bsrS[jj];
+        const index_type stop  = bsrS[jj+1];
+        if ( start < stop )
+        {
+            const real* xj = X + BS * jj;
+            real yj[BS] = { 0 };
+            // diagonal block:
+            mulBlock<BS>(bsrV+BS*BS*start, xj, yj);
+            for ( index_type kk = start+1; kk < stop; ++kk )
+            {
+                const real* blk = bsrV + BS*BS*kk;
+                const index_type ii = BS * bsrI[kk];
+                mulBlock<BS>(blk, xj, Y+ii);
+                mulBlockT<BS>(blk, X+ii, yj);
+            }
+            for ( unsigned a = 0; a < BS; ++a )
+                Y[BS*jj+a] += yj[a];
+        }
+    }
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::vecMulAddIso2D( const real* X, real* Y ) const
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        const index_type start = bsrS[jj];
+        const index_type stop  = bsrS[jj+1];
+        if ( start < stop )
+        {
+            const real* xj = X + 2*BS * jj;
+            real yj[2*BS] = { 0 };
+            mulBlockIso<BS,2>(bsrV+BS*BS*start, xj, yj);
+            for ( index_type kk = start+1; kk < stop; ++kk )
+            {
+                const real* blk = bsrV + BS*BS*kk;
+                const index_type ii = 2*BS * bsrI[kk];
+                mulBlockIso<BS,2>(blk, xj, Y+ii);
+                mulBlockIsoT<BS,2>(blk, X+ii, yj);
+            }
+            for ( unsigned a = 0; a < 2*BS; ++a )
+                Y[2*BS*jj+a] += yj[a];
+        }
+    }
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::vecMulAddIso3D( const real* X, real* Y ) const
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        const index_type start = bsrS[jj];
+        const index_type stop  = bsrS[jj+1];
+        if ( start < stop )
+        {
+            const real* xj = X + 3*BS * jj;
+            real yj[3*BS] = { 0 };
+            mulBlockIso<BS,3>(bsrV+BS*BS*start, xj, yj);
+            for ( index_type kk = start+1; kk < stop; ++kk )
+            {
+                const real* blk = bsrV + BS*BS*kk;
+                const index_type ii = 3*BS * bsrI[kk];
+                mulBlockIso<BS,3>(blk, xj, Y+ii);
+                mulBlockIsoT<BS,3>(blk, X+ii, yj);
+            }
+            for ( unsigned a = 0; a < 3*BS; ++a )
+                Y[3*BS*jj+a] += yj[a];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - SIMD code
+
+#if (MATRIX_USES_INTEL_SSE3)
+
+#include <pmmintrin.h>
+#warning "Manual SSE3 code in MatrixSparseSymmetricBlock"
+
+#define SSE(x) _mm_##x##_pd
+
+/**
+ For 2x2 blocks stored column-major, a block is held in two SSE registers,
+ containing the two columns of the block:
+ B * X = col0 * X[0] + col1 * X[1]
+ transpose(B) * X = ( col0.X, col1.X ), obtained with a horizontal add.
+ */
+template < >
+void MatrixSparseSymmetricBlock<2>::vecMulAdd( const real* X, real* Y ) const
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        const index_type start = bsrS[jj];
+        const index_type stop  = bsrS[jj+1];
+        if ( start < stop )
+        {
+            const real* blk = bsrV + 4 * start;
+            __m128d x0 = SSE(loaddup)(X+2*jj);
+            __m128d x1 = SSE(loaddup)(X+2*jj+1);
+            // diagonal block:
+            __m128d y = SSE(add)(SSE(mul)(SSE(loadu)(blk), x0), SSE(mul)(SSE(loadu)(blk+2), x1));
+            for ( index_type kk = start+1; kk < stop; ++kk )
+            {
+                blk = bsrV + 4 * kk;
+                real * yi = Y + 2 * bsrI[kk];
+                __m128d c0 = SSE(loadu)(blk);
+                __m128d c1 = SSE(loadu)(blk+2);
+                __m128d xi = SSE(loadu)(X + 2 * bsrI[kk]);
+                // Y[ii] += B * X[jj]
+                SSE(storeu)(yi, SSE(add)(SSE(loadu)(yi), SSE(add)(SSE(mul)(c0, x0), SSE(mul)(c1, x1))));
+                // Y[jj] += transpose(B) * X[ii]
+                y = SSE(add)(y, SSE(hadd)(SSE(mul)(c0, xi), SSE(mul)(c1, xi)));
+            }
+            SSE(storeu)(Y+2*jj, SSE(add)(SSE(loadu)(Y+2*jj), y));
+        }
+    }
+}
+
+/**
+ Isotropic multiplication with 1x1 blocks: each value is applied to a 2D vector
+ */
+template < >
+void MatrixSparseSymmetricBlock<1>::vecMulAddIso2D( const real* X, real* Y ) const
+{
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        const index_type start = bsrS[jj];
+        const index_type stop  = bsrS[jj+1];
+        if ( start < stop )
+        {
+            __m128d x = SSE(loadu)(X+2*jj);
+            __m128d y = SSE(mul)(SSE(loaddup)(bsrV+start), x);
+            for ( index_type kk = start+1; kk < stop; ++kk )
+            {
+                __m128d a = SSE(loaddup)(bsrV+kk);
+                real * yi = Y + 2 * bsrI[kk];
+                SSE(storeu)(yi, SSE(add)(SSE(loadu)(yi), SSE(mul)(x, a)));
+                y = SSE(add)(y, SSE(mul)(SSE(loadu)(X + 2 * bsrI[kk]), a));
+            }
+            SSE(storeu)(Y+2*jj, SSE(add)(SSE(loadu)(Y+2*jj), y));
+        }
+    }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+#pragma mark - Storage by lines
+
+/**
+ Build a copy of the full symmetric matrix, where the blocks are stored by block-lines.
+ The blocks from the upper triangle are transposed copies of the lower blocks.
+ Lines can then be multiplied independently, writing only to the lines being calculated.
+ This must be called after prepareForMultiply(), and if the pattern of blocks
+ has not changed, only the values are copied from bsrV[].
+ */
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::prepareForMultiplyLines()
+{
+    assert_true( !newPattern );
+    if ( !newPatternLines )
+    {
+        //the indices are unchanged, and only the values need to be copied:
+        for ( index_type ii = 0; ii < mxBlocks; ++ii )
+        {
+            for ( index_type n = rowS[ii]; n < rowS[ii+1]; ++n )
+            {
+                real const* src = bsrV + BS*BS*rowK[n];
+                real * dst = rowV + BS*BS*n;
+                if ( rowJ[n] > ii )
+                {
+                    for ( unsigned b = 0; b < BS; ++b )
+                        for ( unsigned a = 0; a < BS; ++a )
+                            dst[b+BS*a] = src[a+BS*b];
+                }
+                else
+                {
+                    for ( unsigned k = 0; k < BS*BS; ++k )
+                        dst[k] = src[k];
+                }
+            }
+        }
+        return;
+    }
+
+    if ( rowS == 0 )
+        rowS = new index_type[mxAllocated+1];
+
+    //count number of blocks in each block-line:
+    for ( index_type jj = 0; jj <= mxBlocks; ++jj )
+        rowS[jj] = 0;
+
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        rowS[jj+1] += colSize[jj];
+        for ( unsigned int kk = 1; kk < colSize[jj]; ++kk )
+            ++rowS[col[jj][kk].line+1];
+    }
+
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+        rowS[jj+1] += rowS[jj];
+
+    const unsigned int nbb = rowS[mxBlocks];
+
+    if ( nbb > rowMax )
+    {
+        if ( rowJ )  delete[] rowJ;
+        if ( rowV )  delete[] rowV;
+        if ( rowK )  delete[] rowK;
+        rowMax = nbb + mxBlocks;
+        rowJ   = new index_type[rowMax];
+        rowV   = new real[BS*BS*rowMax];
+        rowK   = new index_type[rowMax];
+    }
+
+    //distribute the blocks from the packed storage, using rowS[] as insertion point:
+    for ( index_type jj = 0; jj < mxBlocks; ++jj )
+    {
+        for ( index_type kk = bsrS[jj]; kk < bsrS[jj+1]; ++kk )
+        {
+            const index_type ii = bsrI[kk];
+            real const* src = bsrV + BS*BS*kk;
+            index_type n = rowS[ii]++;
+            rowJ[n] = jj;
+            rowK[n] = kk;
+            for ( unsigned k = 0; k < BS*BS; ++k )
+                rowV[BS*BS*n+k] = src[k];
+            if ( ii != jj )
+            {
+                n = rowS[jj]++;
+                rowJ[n] = ii;
+                rowK[n] = kk;
+                real * dst = rowV + BS*BS*n;
+                for ( unsigned b = 0; b < BS; ++b )
+                    for ( unsigned a = 0; a < BS; ++a )
+                        dst[b+BS*a] = src[a+BS*b];
+            }
+        }
+    }
+
+    //restore the start of the block-lines:
+    for ( index_type jj = mxBlocks; jj > 0; --jj )
+        rowS[jj] = rowS[jj-1];
+    rowS[0] = 0;
+    assert_true( rowS[mxBlocks] == nbb );
+    newPatternLines = false;
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::vecMulAdd( const real* X, real* Y, index_type start, index_type stop ) const
+{
+    assert_true( start % BS == 0  &&  stop % BS == 0 );
+    assert_true( stop <= mxSize );
+    for ( index_type ii = start/BS; ii < stop/BS; ++ii )
+    {
+        real yi[BS] = { 0 };
+        for ( index_type kk = rowS[ii]; kk < rowS[ii+1]; ++kk )
+            mulBlock<BS>(rowV+BS*BS*kk, X+BS*rowJ[kk], yi);
+        for ( unsigned a = 0; a < BS; ++a )
+            Y[BS*ii+a] += yi[a];
+    }
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::vecMulAddIso2D( const real* X, real* Y, index_type start, index_type stop ) const
+{
+    assert_true( start % BS == 0  &&  stop % BS == 0 );
+    assert_true( stop <= mxSize );
+    for ( index_type ii = start/BS; ii < stop/BS; ++ii )
+    {
+        real yi[2*BS] = { 0 };
+        for ( index_type kk = rowS[ii]; kk < rowS[ii+1]; ++kk )
+            mulBlockIso<BS,2>(rowV+BS*BS*kk, X+2*BS*rowJ[kk], yi);
+        for ( unsigned a = 0; a < 2*BS; ++a )
+            Y[2*BS*ii+a] += yi[a];
+    }
+}
+
+
+template < unsigned BS >
+void MatrixSparseSymmetricBlock<BS>::vecMulAddIso3D( const real* X, real* Y, index_type start, index_type stop ) const
+{
+    assert_true( start % BS == 0  &&  stop % BS == 0 );
+    assert_true( stop <= mxSize );
+    for ( index_type ii = start/BS; ii < stop/BS; ++ii )
+    {
+        real yi[3*BS] = { 0 };
+        for ( index_type kk = rowS[ii]; kk < rowS[ii+1]; ++kk )
+            mulBlockIso<BS,3>(rowV+BS*BS*kk, X+3*BS*rowJ[kk], yi);
+        for ( unsigned a = 0; a < 3*BS; ++a )
+            Y[3*BS*ii+a] += yi[a];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template class MatrixSparseSymmetricBlock<1>;
+template class MatrixSparseSymmetricBlock<2>;
+template class MatrixSparseSymmetricBlock<3>;
+
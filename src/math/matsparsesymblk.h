@@ -0,0 +1,183 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef MATSPARSESYMBLK_H
+#define MATSPARSESYMBLK_H
+
+#include <cstdio>
+#include "matrix.h"
+
+
+///real symmetric sparse Matrix, stored by square blocks of size BS
+/**
+ MatrixSparseSymmetricBlock<BS> uses a sparse storage, where the non-zero elements
+ are grouped into dense blocks of size BS*BS, aligned on multiples of BS.
+ Only one index is stored for each block, and the BS*BS values of a block are contiguous,
+ such that a block can be multiplied by a vector using registers only.
+ With BS = DIM, this matches the structure of the interactions between points,
+ which couple the DIM coordinates of a point with the DIM coordinates of another point.
+ With BS = 1, this is a standard compressed sparse matrix.
+
+ As in MatrixSparseSymmetric1, only the lower triangle is stored during assembly,
+ using arrays of blocks for each column of blocks.
+ For multiplication, the blocks are copied into contiguous arrays (Block Compressed Sparse Row)
+ when prepareForMultiply() is called, and the diagonal blocks are symmetrized.
+
+ The size of the matrix must be a multiple of BS.
+ 
+ As in MatrixSparseSymmetric1, resetValues() can be called instead of makeZero()
+ to keep the pattern of blocks, such that the conversions only copy the values.
+ */
+template < unsigned BS >
+class MatrixSparseSymmetricBlock : public Matrix
+{
+
+private:
+
+    /// a block of the matrix, stored in the column of blocks
+    struct Block
+    {
+        index_type line;        ///< index of the block-line
+        real val[BS*BS];        ///< values stored column-major
+    };
+
+    /// size of matrix
+    unsigned int mxSize;
+
+    /// number of blocks in a line or a column
+    unsigned int mxBlocks;
+
+    /// amount of memory which has been allocated (in number of block columns)
+    unsigned int mxAllocated;
+
+    /// array col[c][] holds the Blocks of block-column 'c', diagonal block first
+    Block ** col;
+
+    /// colSize[c] is the number of Blocks in block-column 'c'
+    unsigned int  * colSize;
+
+    /// colMax[c] number of Blocks allocated in block-column 'c'
+    unsigned int  * colMax;
+
+    /// allocate block-column to hold specified number of blocks
+    Block * allocateColumn( index_type column_index, unsigned nb );
+
+    /// remove blocks that are zero
+    void removeZeros();
+
+    /// amount of memory allocated for the packed storage
+    unsigned int  bsrMax;
+
+    /// blocks of block-column 'c' are in bsrI[] and bsrV[] from bsrS[c] to bsrS[c+1]
+    index_type  * bsrS;
+
+    /// block-line index of the packed blocks
+    index_type  * bsrI;
+
+    /// values of the packed blocks, BS*BS values for each block
+    real        * bsrV;
+
+    /// amount of memory allocated for the storage by block-lines
+    unsigned int  rowMax;
+
+    /// blocks of block-line 'r' are in rowJ[] and rowV[] from rowS[r] to rowS[r+1]
+    index_type  * rowS;
+
+    /// block-column index of the blocks stored by block-lines
+    index_type  * rowJ;
+
+    /// values of the blocks stored by block-lines
+    real        * rowV;
+
+    /// index in bsrV[] of the blocks stored by block-lines
+    index_type  * rowK;
+
+    /// true if the pattern of blocks was modified since the last prepareForMultiply()
+    bool          newPattern;
+
+    /// true if the pattern of blocks was modified since the last prepareForMultiplyLines()
+    bool          newPatternLines;
+
+public:
+
+    //size of (square) matrix
+    unsigned int size() const { return mxSize; }
+
+    /// base for destructor
+    void deallocate();
+
+    /// default constructor
+    MatrixSparseSymmetricBlock();
+
+    /// default destructor
+    virtual ~MatrixSparseSymmetricBlock()  { deallocate(); }
+
+    /// set all the element to zero
+    void makeZero();
+
+    /// set all the element to zero, keeping the pattern of blocks
+    void resetValues();
+
+    /// allocate the matrix to hold ( sz * sz ), where `sz` is a multiple of BS
+    void allocate( unsigned int sz );
+
+    /// returns the address of element at (x, y), no allocation is done
+    real* addr( index_type x, index_type y ) const;
+
+    /// returns the address of element at (x, y), allocating if necessary
+    real& operator()( index_type x, index_type y );
+
+    /// scale the matrix by a scalar factor
+    void scale( real a );
+
+    /// add the diagonal block ( x, x, x+sx, x+sx ) from this matrix to M
+    void addDiagonalBlock( real* M, index_type x, unsigned int sx) const;
+
+    /// add the upper triagular block ( x, x, x+sx, x+sx ) from this matrix to M
+    void addTriangularBlock( real* M, index_type x, unsigned int sx) const;
+
+    /// copy the blocks into contiguous arrays, necessary before any multiplication
+    void prepareForMultiply();
+
+    /// multiplication of a vector: Y = Y + M * X, dim(X) = dim(M)
+    void vecMulAdd( const real* X, real* Y ) const;
+
+    /// 2D isotropic multiplication of a vector: Y = Y + M * X
+    void vecMulAddIso2D( const real* X, real* Y ) const;
+
+    /// 3D isotropic multiplication of a vector: Y = Y + M * X
+    void vecMulAddIso3D( const real* X, real* Y ) const;
+
+    /// build the storage by block-lines, needed to multiply a subset of lines
+    void prepareForMultiplyLines();
+
+    /// number of elements stored for lines [start, stop), after prepareForMultiplyLines()
+    unsigned int nbElementsInLines( index_type start, index_type stop ) const { return BS * BS * ( rowS[stop/BS] - rowS[start/BS] ); }
+
+    /// multiplication restricted to lines [start, stop), which should be multiples of BS
+    void vecMulAdd( const real* X, real* Y, index_type start, index_type stop ) const;
+
+    /// 2D isotropic multiplication restricted to lines [start, stop)
+    void vecMulAddIso2D( const real* X, real* Y, index_type start, index_type stop ) const;
+
+    /// 3D isotropic multiplication restricted to lines [start, stop)
+    void vecMulAddIso3D( const real* X, real* Y, index_type start, index_type stop ) const;
+
+    /// true if matrix is non-zero
+    bool nonZero() const;
+
+    /// number of element which are non-zero
+    unsigned int  nbNonZeroElements() const;
+
+    /// returns a string which a description of the type of matrix
+    std::string what() const;
+
+    /// printf debug function in sparse mode: i, j : value
+    void printSparse(std::ostream &) const;
+
+    /// debug function
+    int bad() const;
+};
+
+
+#endif
+
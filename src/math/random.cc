@@ -4,6 +4,7 @@
 #include "assert_macro.h"
 
 #include <climits>
+#include <cstring>
 #include <sys/time.h>
 #include <time.h>
 
@@ -67,6 +68,47 @@ uint32_t Random::seedTimer()
     return s;
 }
 
+//------------------------------------------------------------------------------
+/**
+ The state includes the Mersenne Twister data, the position of the next
+ value in this data, and the value buffered by gauss().
+ */
+size_t Random::stateSize()
+{
+    return sizeof(sfmt_t) + sizeof(uint32_t) + sizeof(real) + sizeof(uint32_t);
+}
+
+
+void Random::saveState(void * dst) const
+{
+    char * ptr = static_cast<char*>(dst);
+    uint32_t pos = sfmt_ptr - sfmt_first;
+    uint32_t val = bufferValid;
+    memcpy(ptr, &sfmt, sizeof(sfmt_t));
+    ptr += sizeof(sfmt_t);
+    memcpy(ptr, &pos, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+    memcpy(ptr, &bufferValue, sizeof(real));
+    ptr += sizeof(real);
+    memcpy(ptr, &val, sizeof(uint32_t));
+}
+
+
+void Random::loadState(const void * src)
+{
+    const char * ptr = static_cast<const char*>(src);
+    uint32_t pos = 0, val = 0;
+    memcpy(&sfmt, ptr, sizeof(sfmt_t));
+    ptr += sizeof(sfmt_t);
+    memcpy(&pos, ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+    memcpy(&bufferValue, ptr, sizeof(real));
+    ptr += sizeof(real);
+    memcpy(&val, ptr, sizeof(uint32_t));
+    sfmt_ptr = sfmt_first + ( pos < SFMT_N32 ? pos : SFMT_N32 );
+    bufferValid = val;
+}
+
 //------------------------------------------------------------------------------
 #pragma mark -
 
@@ -67,6 +67,15 @@ public:
     
     /// seed with time()
     uint32_t  seedTimer();
+    
+    /// number of bytes needed to store the state of the generator
+    static size_t stateSize();
+    
+    /// copy the state of the generator to `dst`, which should have stateSize() bytes
+    void      saveState(void * dst) const;
+    
+    /// restore the state recorded by saveState()
+    void      loadState(const void * src);
 
     /// unsigned integer in [0,2^32-1]
     uint32_t  pint()                     { return RAN32(); }
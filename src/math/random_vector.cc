@@ -19,6 +19,7 @@ const Vector1 Vector1::randBox(real n)    { return Vector1(n*RNG.sreal(), 0); }
 const Vector1 Vector1::randUnit()         { return Vector1(  RNG.sflip(), 0); }
 const Vector1 Vector1::randUnit(real n)   { return Vector1(n*RNG.sflip(), 0); }
 void  Vector1::addRand(real n)            { XX += n*RNG.sreal(); }
+void  Vector1::addRand(real n, Random& rng) { XX += n*rng.sreal(); }
 
 const Vector1 Vector1::randBall()         { return Vector1(   RNG.sreal(), 0); }
 const Vector1 Vector1::randBall(real n)   { return Vector1( n*RNG.sreal(), 0); }
@@ -33,6 +34,7 @@ const Vector2 Vector2::randBox()          { return Vector2(RNG.sreal(), RNG.srea
 const Vector2 Vector2::randBox(real n)    { return Vector2(n*RNG.sreal(), n*RNG.sreal()); }
 const Vector2 Vector2::randGauss(real n)  { return Vector2(n*RNG.gauss(), n*RNG.gauss()); }
 void  Vector2::addRand(real n)            { XX += n*RNG.sreal(); YY += n*RNG.sreal(); }
+void  Vector2::addRand(real n, Random& rng) { XX += n*rng.sreal(); YY += n*rng.sreal(); }
 
 const Vector2 Vector2::randUnit()
 {
@@ -91,6 +93,7 @@ const Vector3 Vector3::randBox()          { return Vector3(RNG.sreal(), RNG.srea
 const Vector3 Vector3::randBox(real n)    { return Vector3(n*RNG.sreal(), n*RNG.sreal(), n*RNG.sreal()); }
 const Vector3 Vector3::randGauss(real n)  { return Vector3(n*RNG.gauss(), n*RNG.gauss(), n*RNG.gauss()); }
 void  Vector3::addRand(real n)            { XX += n*RNG.sreal(); YY += n*RNG.sreal(); ZZ += n*RNG.sreal(); }
+void  Vector3::addRand(real n, Random& rng) { XX += n*rng.sreal(); YY += n*rng.sreal(); ZZ += n*rng.sreal(); }
 
 
 #if ( 1 )
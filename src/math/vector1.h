@@ -12,6 +12,8 @@
 #include <cstdio>
 #include <cmath>
 
+class Random;
+
 /// Vector1 is a vector with 1 `real` component.
 class Vector1
 {
@@ -439,6 +441,9 @@ public:
     /// add a random component in [-s, s] to each coordinate
     void addRand(real s);
     
+    /// add a random component in [-s, s] to each coordinate, using the given generator
+    void addRand(real s, Random&);
+    
     /// a vector of norm `n`, orthogonal to *this, chosen randomly and uniformly
     const Vector1 randPerp(real n) const;
     
@@ -12,6 +12,8 @@
 #include <cstdio>
 #include <cmath>
 
+class Random;
+
 /// Vector2 is a vector with 2 `real` components.
 /**
  Note: We assume that the coordinates XX and YY are adjacent in memory,
@@ -496,6 +498,9 @@ public:
     /// add a random component in [-s, s] to each coordinate
     void addRand(real s);
     
+    /// add a random component in [-s, s] to each coordinate, using the given generator
+    void addRand(real s, Random&);
+    
     /// a vector of norm `n`, orthogonal to *this, chosen randomly and uniformly
     const Vector2 randPerp(real n) const;
     
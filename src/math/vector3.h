@@ -12,6 +12,8 @@
 #include <cstdio>
 #include <cmath>
 
+class Random;
+
 /// Vector3 is a vector with 3 `real` components.
 /**
  Note: We assume that the coordinates XX, YY and ZZ are adjacent in memory,
@@ -540,6 +542,9 @@ public:
     /// add a random component in [-s, s] to each coordinate
     void addRand(real s);
     
+    /// add a random component in [-s, s] to each coordinate, using the given generator
+    void addRand(real s, Random&);
+    
     /// a vector of norm `n`, orthogonal to *this, chosen randomly and uniformly
     const Vector3 randPerp(real n) const;
     
@@ -4,6 +4,7 @@
 #include "exceptions.h"
 #include "iowrapper.h"
 #include "simul.h"
+#include "frame_index.h"
 
 //#define VERBOSE_READER
 
@@ -48,6 +49,12 @@ void FrameReader::openFile(std::string& file)
     if ( inw.error() )
         throw InvalidIO("file `"+file+"' is invalid");
     
+    // the index is loaded before the file is mapped:
+    loadIndex(file);
+    
+    // read from memory if possible, to avoid the overhead of the C-library:
+    inw.map();
+
     //std::cerr << "FrameReader: has openned " << obj_file << std::endl;
 }
 
@@ -79,6 +86,32 @@ void FrameReader::checkFile()
         throw InvalidIO("File has errors");
 }
 
+/**
+ The index is ignored if it does not match the trajectory file
+ */
+void FrameReader::loadIndex(std::string const& file)
+{
+    FrameIndex index;
+    
+    if ( index.load(file) || index.check(inw.file(), FRAME_TAG) )
+        return;
+    
+    fpos_t pos;
+    for ( size_t i = 0; i < index.size(); ++i )
+    {
+        if ( fseeko(inw.file(), index[i].offset, SEEK_SET) )
+            break;
+        inw.get_pos(pos);
+        savePos(i, pos, 2);
+        framePos[i].key = index[i].base;
+    }
+    inw.rewind();
+    
+#ifdef VERBOSE_READER
+    std::cerr << "FrameReader: loaded index of " << index.size() << " frames" << std::endl;
+#endif
+}
+
 //------------------------------------------------------------------------------
 #pragma mark -
 
@@ -238,37 +271,52 @@ int FrameReader::seekFrame(const int frm)
 }
 
 //------------------------------------------------------------------------------
-/** 
- returns 0 for success, an error code, or throws an exception
+/**
+ A frame is complete, unless the line following the `#time` line is `#delta`.
+ This goes backward from \a frm, until a complete frame is found,
+ and records the result for all the frames that were visited.
  */
-int FrameReader::readFrame(Simul& sim, int frm, const bool reload)
+int FrameReader::keyFrame(const int frm)
 {
-    if ( badFile() )
-        return 1;
-
-#ifdef VERBOSE_READER
-    std::cerr << "FrameReader: readFrame("<<frm<<", "<<reload <<")" << std::endl;
-#endif
+    int inx = frm;
+    std::string line;
     
-    // a negative index is counted from the end
-    if ( frm < 0 )
+    while ( 0 < inx )
     {
-#ifdef VERBOSE_READER
-        std::cerr << "FrameReader: counting down from frame "<< lastFrame() << std::endl;
-#endif
-        frm += 1 + lastFrame();
-        if ( frm < 0 )
-            frm = 0;
+        if ( inx < (int)framePos.size()  &&  0 <= framePos[inx].key )
+        {
+            inx = framePos[inx].key;
+            break;
+        }
+        
+        if ( 0 != seekFrame(inx) )
+            return -1;
+        
+        // skip the frame tag and the time:
+        inw.get_line(line);
+        inw.get_line(line);
+        inw.get_line(line);
+        
+        if ( line.compare(0, 6, "#delta") )
+            break;
+        --inx;
     }
     
-    // what we are looking for might already be in the buffer:
-    if ( frm == curFrame && ! reload )
-        return 0;
+    for ( int i = inx; i <= frm && i < (int)framePos.size(); ++i )
+        framePos[i].key = inx;
     
-    // it might be the next one in the buffer:
-    if ( frm == 1+curFrame )
-        return readNextFrame(sim);
+#ifdef VERBOSE_READER
+    std::cerr << "FrameReader: frame " << frm << " depends on frame " << inx << std::endl;
+#endif
+    return inx;
+}
+
 
+/**
+ returns 0 for success, an error code, or throws an exception
+ */
+int FrameReader::readFrameAt(Simul& sim, const int frm)
+{
     //---------------------try to find the start tag from there:
     
     if ( 0 != seekFrame(frm) )
@@ -306,6 +354,62 @@ int FrameReader::readFrame(Simul& sim, int frm, const bool reload)
     }
 }
 
+
+/** 
+ returns 0 for success, an error code, or throws an exception
+ */
+int FrameReader::readFrame(Simul& sim, int frm, const bool reload)
+{
+    if ( badFile() )
+        return 1;
+
+#ifdef VERBOSE_READER
+    std::cerr << "FrameReader: readFrame("<<frm<<", "<<reload <<")" << std::endl;
+#endif
+    
+    // a negative index is counted from the end
+    if ( frm < 0 )
+    {
+#ifdef VERBOSE_READER
+        std::cerr << "FrameReader: counting down from frame "<< lastFrame() << std::endl;
+#endif
+        frm += 1 + lastFrame();
+        if ( frm < 0 )
+            frm = 0;
+    }
+    
+    // what we are looking for might already be in the buffer:
+    if ( frm == curFrame && ! reload )
+        return 0;
+    
+    // it might be the next one in the buffer:
+    if ( frm == 1+curFrame )
+        return readNextFrame(sim);
+
+    int key = keyFrame(frm);
+    
+    if ( key < 0 )
+        return 1;
+    
+    if ( key == frm )
+        return readFrameAt(sim, frm);
+    
+    // read forward from the complete frame, or from the current frame if possible:
+    if ( curFrame < key || frm <= curFrame )
+    {
+        if ( readFrameAt(sim, key) )
+            return 1;
+    }
+    
+    // the position in the file may have changed in keyFrame():
+    while ( curFrame < frm )
+    {
+        if ( readFrameAt(sim, curFrame+1) )
+            return 1;
+    }
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 int FrameReader::readFrameCatch(Simul& sim, const int frm, const bool reload)
 {
@@ -1,5 +1,8 @@
 // Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
 
+#ifndef FRAME_READER_H
+#define FRAME_READER_H
+
 #include "iowrapper.h"
 #include <vector>
 class Simul;
@@ -11,6 +14,11 @@ class Simul;
  and it will handle basic IO failures.
  FrameReader will remember the starting points of all frames that were found,
  and will use this information to speed up future access to these and other frames.
+ If the trajectory has a valid index file (see FrameIndex), the starting points
+ of all frames are known from the start, and any frame can be reached with a single seek.
+ 
+ A frame that only contains the objects that have changed (a 'delta' frame)
+ is read after the preceding frames, starting from the last complete frame.
 
  FrameReader makes minimal assuptions on what constitutes a 'frame':
  - It looks for a string-tag present at the start of a frame (FRAME_TAG).
@@ -26,8 +34,9 @@ private:
     {
     public:
         int    status;   ///< indicates that \a value is not valid
+        int    key;      ///< index of the complete frame preceding this one, or -1 if unknown
         fpos_t value;
-        file_pos() { status=0; }
+        file_pos() { status=0; key=-1; }
     };
     
     /// type for list of positions
@@ -48,6 +57,15 @@ private:
     /// go to a position where a frame close to \a frm is known to start
     int      seekPos(int frm);
     
+    /// index of the last complete frame before \a frm, or -1 if frame was not found
+    int      keyFrame(int frm);
+    
+    /// find frame \a frm, and read it without reading the preceding frames
+    int      readFrameAt(Simul&, int frm);
+
+    /// learn the starting points of the frames from the index file of `file`
+    void     loadIndex(std::string const& file);
+
     /// check file validity
     void     checkFile();
     
@@ -97,4 +115,5 @@ public:
         
 };
 
+#endif
 
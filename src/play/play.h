@@ -136,6 +136,9 @@ namespace Player
     /// display cytosim state and message
     void displayCytosim(Simul const&);
     
+    /// read the display parameters specified in SimulProp::display
+    void readDisplayString(std::string const&);
+    
     /// display function for on-screen rendering
     void displayLive();
 
@@ -270,32 +270,57 @@ void Player::displayCytosim(Simul const& simul)
 }
 
 
+void Player::readDisplayString(std::string const& str)
+{
+    try
+    {
+        Glossary glos(str);
+        GP.read(glos);
+        View & view = glApp::currentView();
+        view.read(glos);
+        view.setModelView();
+        DP.read(glos);
+    }
+    catch( Exception & e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+}
+
+
 /**
- display is done only if data can be accessed by this thread,
+ While the simulation is running live, the display uses the copy of the simulation
+ that is made from the last Snapshot published by SimThread, without locking.
+ 
+ Otherwise, display is done only if data can be accessed by this thread,
  otherwise display is postponed with a call to postRedisplay()
  */
 void Player::displayLive()
 {
     //std::cerr << "displayLive win=" << glutGetWindow() << std::endl;
+    if ( PP.live  &&  simThread.running()  &&  0 == simThread.updateMirror() )
+    {
+        // read the "display" parameters if they have changed
+        static unsigned display_stamp = 0;
+        if ( simThread.snapshot().display_stamp != display_stamp )
+        {
+            readDisplayString(simThread.snapshot().display);
+            display_stamp = simThread.snapshot().display_stamp;
+        }
+        
+        Simul & mirror = simThread.mirror();
+        prepareDisplay(glApp::currentView(), mirror);
+        displayCytosim(mirror);
+        return;
+    }
+    
     SimThread::TryLock lck(&simThread);
     if ( 0 == lck.status() )
     {
         // read the "display" parameters if they have changed
         if ( simul.prop->display_fresh )
         {
-            try
-            {
-                Glossary glos(simul.prop->display);
-                GP.read(glos);
-                View & view = glApp::currentView();
-                view.read(glos);
-                view.setModelView();
-                DP.read(glos);
-            }
-            catch( Exception & e )
-            {
-                std::cerr << "Error: " << e.what() << std::endl;
-            }
+            readDisplayString(simul.prop->display);
             simul.prop->display_fresh = false;
         }
         
@@ -2,13 +2,26 @@
 
 #include <sys/time.h>
 #include <time.h>
+#include <cstdlib>
+#include <sstream>
 #include "sim_thread.h"
 #include "exceptions.h"
+#include "iowrapper.h"
 #include "picket.h"
+#include "random.h"
+
+extern Random RNG;
 
 
 //------------------------------------------------------------------------------
 
+/// callback of mMirror, see Simul::secondary()
+void mirror_creating(void * arg)
+{
+    static_cast<SimThread*>(arg)->mirrorCreating();
+}
+
+
 /**
  This uses a Parser that cannot write to disc.
  The function callback is called when Parser::hold() is reached.
@@ -19,6 +32,11 @@ SimThread::SimThread(void (*hold_callback)(void))
     mStatus = 0;
     mHold   = 0;
     mPeriod = 1;
+    mDisplayStamp = 0;
+    mMirrorStamp  = 0;
+    mMirrorValid  = false;
+    mMirrorLocked = false;
+    mMirror.secondary(mirror_creating, this);
     pthread_mutex_init(&mMutex, 0);
     pthread_cond_init(&mCondition, 0);
 }
@@ -38,12 +56,136 @@ SimThread::~SimThread()
 //------------------------------------------------------------------------------
 #pragma mark -
 
+/**
+ This is called by the simulation thread, which then holds the mutex.
+ The Snapshot is written in a buffer that is not accessed by the display,
+ and it is then made available with a lock-free exchange of buffers.
+ The objects are written in binary format, with the usual single precision.
+ */
+void SimThread::publish()
+{
+    Snapshot & snap = mSnapshots.writeBuffer();
+
+    snap.prop = *simul.prop;
+    if ( simul.prop->display_fresh )
+    {
+        ++mDisplayStamp;
+        simul.prop->display_fresh = false;
+    }
+    snap.display = simul.prop->display;
+    snap.display_stamp = mDisplayStamp;
+    
+    // the properties are formatted only if they have changed:
+    if ( snap.properties_stamp != simul.properties.stamp() )
+    {
+        std::ostringstream oss;
+        simul.properties.write(oss, true);
+        snap.properties = oss.str();
+        snap.properties_stamp = simul.properties.stamp();
+    }
+    
+    char * data = 0;
+    size_t size = 0;
+    FILE * mem = open_memstream(&data, &size);
+    if ( !mem )
+        return;
+    try {
+        // return the free objects that are held in reserve, as for a trajectory frame:
+        simul.relax();
+        OutputWrapper out(mem, true);
+        simul.writeObjects(out);
+        out.close();
+        snap.frame.assign(data, size);
+        free(data);
+    }
+    catch( Exception & e ) {
+        std::cerr << "Error in SimThread::publish(): " << e.what() << std::endl;
+        free(data);
+        return;
+    }
+    mSnapshots.publish();
+}
+
+
+/**
+ The constructors of some objects use the global RNG, which is also used by the
+ simulation thread. The simulation is thus stopped before mMirror creates objects,
+ and the state of RNG is restored afterwards, such that the random sequence of the
+ simulation is not affected by the display.
+ */
+void SimThread::mirrorCreating()
+{
+    if ( !mMirrorLocked )
+    {
+        lock();
+        mMirrorLocked = true;
+        mMirrorRNG.resize(Random::stateSize());
+        RNG.saveState(&mMirrorRNG[0]);
+    }
+}
+
+
+void SimThread::mirrorCreated()
+{
+    if ( mMirrorLocked )
+    {
+        RNG.loadState(&mMirrorRNG[0]);
+        mMirrorLocked = false;
+        unlock();
+    }
+}
+
+
+/**
+ This is called by the display thread, and does not lock the simulation,
+ unless mMirror needs to create new objects (see mirrorCreating()).
+ The properties of the mirror are rebuilt only if they have changed,
+ and the objects are then updated from the frame recorded in the Snapshot.
+ mMirror does not modify the global variables, see Simul::secondary().
+ */
+int SimThread::updateMirror()
+{
+    if ( mSnapshots.acquire() )
+    {
+        Snapshot const& snap = mSnapshots.readBuffer();
+        try {
+            // the properties refer to the Simul via SimulProp::simul
+            *mMirror.prop = snap.prop;
+            mMirror.prop->simul = &mMirror;
+            
+            if ( !mMirrorValid  ||  snap.properties_stamp != mMirrorStamp )
+            {
+                mMirror.erase();
+                std::istringstream iss(snap.properties);
+                Parser(mMirror, 1, 1, 0, 0, 0).parse(iss, "snapshot");
+                mMirrorStamp = snap.properties_stamp;
+            }
+            
+            FILE * mem = fmemopen(const_cast<char*>(snap.frame.data()), snap.frame.size(), "rb");
+            if ( !mem )
+                throw InvalidIO("could not read snapshot");
+            InputWrapper in(mem);
+            mMirror.reloadObjects(in);
+            mirrorCreated();
+            mMirrorValid = true;
+        }
+        catch( Exception & e ) {
+            mirrorCreated();
+            std::cerr << "Error in SimThread::updateMirror(): " << e.what() << std::endl;
+            mMirrorValid = false;
+        }
+    }
+    return !mMirrorValid;
+}
+
+
 void SimThread::hold()
 {
     //assert_true( pthread_equal(pthread_self(), mThread) );
 
     if ( ++mHold >= mPeriod )
     {
+        publish();
         holding();
         mHold = 0;
         if ( mStatus > 0 )
@@ -125,6 +267,7 @@ int SimThread::start()
     {
         if ( 0 == trylock() )
         {
+            mMirrorValid = false;
             mStatus = 1;
             pthread_create(&mThread, 0, run_thread, this);
             return 0;
@@ -140,6 +283,7 @@ int SimThread::persist()
     {
         if ( 0 == trylock() )
         {
+            mMirrorValid = false;
             mStatus = 2;
             pthread_create(&mThread, 0, run_more_thread, this);
             return 0;
@@ -294,6 +438,8 @@ void SimThread::clear()
     simul.erase();
     mHandles.clear();
     mHandle = 0;
+    mMirror.erase();
+    mMirrorValid = false;
 }
 
 //------------------------------------------------------------------------------
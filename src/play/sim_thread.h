@@ -4,9 +4,11 @@
 #define LIVE_THREAD_H
 
 #include <pthread.h>
+#include <vector>
 #include "parser.h"
 #include "simul.h"
 #include "frame_reader.h"
+#include "triple_buffer.h"
 
 
 /// SimThread is used to run a simulation in a dedicated thread
@@ -61,6 +63,35 @@ public:
         /// Release the pthread lock
         ~TryLock() { if ( ecode == 0 ) mlt->unlock(); }
     };
+    
+    
+    /**
+     A Snapshot records the state of the simulation, such that it can be displayed
+     while the simulation continues. The objects are recorded in the binary format
+     of the trajectory files, and the properties as text.
+     */
+    struct Snapshot
+    {
+        /// global parameters of the simulation
+        SimulProp    prop;
+        
+        /// all properties except SimulProp, in the format of 'properties.cmo'
+        std::string  properties;
+        
+        /// value of PropertyList::stamp() when `properties` was recorded
+        unsigned     properties_stamp;
+        
+        /// all objects, in the format of 'objects.cmo'
+        std::string  frame;
+        
+        /// value of SimulProp::display
+        std::string  display;
+        
+        /// incremented every time SimulProp::display has been modified
+        unsigned     display_stamp;
+        
+        Snapshot() : prop("simul", 0), properties_stamp(~0U), display_stamp(0) {}
+    };
 
 private:
     
@@ -103,6 +134,28 @@ private:
     Array<Single *> mHandles;
     
     
+    /// snapshots passed from the simulation thread to the display
+    TripleBuffer<Snapshot> mSnapshots;
+    
+    /// counter of the changes made to SimulProp::display
+    unsigned        mDisplayStamp;
+    
+    /// copy of the simulation, built from the snapshots
+    Simul           mMirror;
+    
+    /// stamp of the properties that were used to build mMirror
+    unsigned        mMirrorStamp;
+    
+    /// true if mMirror holds a snapshot of the current live simulation
+    bool            mMirrorValid;
+    
+    /// true if the display thread holds the mutex, while mMirror creates objects
+    bool            mMirrorLocked;
+    
+    /// state of the global RNG, saved while mMirror creates objects
+    std::vector<char> mMirrorRNG;
+    
+    
     /// create or make a new SingleProp for the handles
     SingleProp *  getHandleProperty(real range);
 
@@ -117,6 +170,18 @@ private:
     int           trylock() { return pthread_mutex_trylock(&mMutex); }
 
     
+    /// record the state of the simulation in a Snapshot, and pass it to the display
+    void          publish();
+    
+    /// called before mMirror creates an object: stop the simulation and save RNG
+    void          mirrorCreating();
+    
+    /// restore RNG and release the simulation, if mirrorCreating() was called
+    void          mirrorCreated();
+    
+    /// accessory function to call SimThread::mirrorCreating()
+    friend void   mirror_creating(void * arg);
+    
     /// redefines Interface::hold(), will be called between commands
     void          hold();
     
@@ -143,6 +208,18 @@ public:
     /// Simul reference
     Simul&     sim() { return simul; }
     
+    /// true if the simulation is running in the slave thread
+    bool       running() const { return mStatus > 0; }
+    
+    /// load the last Snapshot into mirror(), returning 0 if mirror() can be displayed
+    int        updateMirror();
+    
+    /// copy of the live simulation, that can be accessed without locking
+    Simul&     mirror() { return mMirror; }
+    
+    /// the last Snapshot loaded by updateMirror()
+    Snapshot const& snapshot() const { return mSnapshots.readBuffer(); }
+    
     /// set how many 'hold()' are necessary to halt the thread
     void       period(unsigned int c) { mPeriod = c; }
     
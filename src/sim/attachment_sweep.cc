@@ -0,0 +1,50 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "attachment_sweep.h"
+#include "hand.h"
+
+extern Random RNG;
+
+
+void AttachmentSweep::prepare(unsigned cnt, FiberGrid const& grid)
+{
+    if ( cnt != nbBuffers )
+    {
+        delete[] buffers;
+        buffers = new AttachmentBuffer[cnt];
+        nbBuffers = cnt;
+        for ( unsigned n = 0; n < cnt; ++n )
+            buffers[n].rng.seed(RNG.pint());
+    }
+
+    for ( unsigned n = 0; n < cnt; ++n )
+    {
+        buffers[n].attempts.clear();
+        buffers[n].sites.clear();
+        buffers[n].grid = &grid;
+    }
+}
+
+
+/**
+ The buffers are processed in the order of the threads,
+ which is the order of the objects given to run().
+ */
+void AttachmentSweep::commit(FiberGrid const& grid)
+{
+    for ( unsigned n = 0; n < nbBuffers; ++n )
+    {
+        AttachmentBuffer & buf = buffers[n];
+
+        for ( unsigned i = 0; i < buf.attempts.size(); ++i )
+        {
+            AttachmentBuffer::Attempt const& a = buf.attempts[i];
+
+            if ( a.defer )
+                a.hand->stepFree(grid, a.pos);
+            else if ( !a.hand->attached() )
+                FiberGrid::attachToOne(*a.hand, buf.sites.addr()+a.start, a.end-a.start);
+        }
+    }
+}
+
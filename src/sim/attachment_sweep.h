@@ -0,0 +1,156 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef ATTACHMENT_SWEEP_H
+#define ATTACHMENT_SWEEP_H
+
+#include "vector.h"
+#include "array.h"
+#include "random.h"
+#include "fiber_grid.h"
+#include "thread_pool.h"
+
+class Hand;
+
+
+/// Records the binding attempts made by one thread during an AttachmentSweep
+class AttachmentBuffer
+{
+public:
+
+    /// a binding attempt of a Hand, with the sites that are within reach
+    struct Attempt
+    {
+        Hand *   hand;      ///< the Hand
+        Vector   pos;       ///< position of the Hand
+        unsigned start;     ///< index of the first site in `sites`
+        unsigned end;       ///< index after the last site in `sites`
+        bool     defer;     ///< if true, Hand::stepFree() will be called instead
+    };
+
+    /// random number generator to be used by this thread
+    Random               rng;
+
+    /// binding attempts, in the order in which they were made
+    Array<Attempt>       attempts;
+
+    /// binding sites, of all attempts
+    FiberGrid::SiteList  sites;
+
+    /// the grid used to find the sites
+    FiberGrid const*     grid;
+
+public:
+
+    /// record an attempt of the Hand at position `pos`, finding the sites on the grid
+    void search(Hand * ha, Vector const& pos)
+    {
+        Attempt a;
+        a.hand  = ha;
+        a.pos   = pos;
+        a.start = sites.size();
+        grid->findSites(pos, *ha, sites);
+        a.end   = sites.size();
+        a.defer = false;
+        if ( a.end > a.start )
+            attempts.push_back(a);
+    }
+
+    /// record that Hand::stepFree() should be called at position `pos`
+    void defer(Hand * ha, Vector const& pos)
+    {
+        Attempt a;
+        a.hand  = ha;
+        a.pos   = pos;
+        a.start = 0;
+        a.end   = 0;
+        a.defer = true;
+        attempts.push_back(a);
+    }
+};
+
+
+/// Parallel diffusion of free Couples or Singles, and search of binding sites
+/**
+ The objects are distributed in contiguous slices, one for each thread of the ThreadPool.
+ Every thread has its own AttachmentBuffer, which holds a Random generator,
+ and records the binding attempts made by the Hands.
+ The grid is only read during this phase.
+
+ The attempts are then executed by commit(), sequentially in the order of the objects,
+ using the global Random generator to select the binding sites.
+ Hence the results are reproducible for a given random seed and number of threads.
+
+ The Random generator of each buffer is seeded from the global generator when
+ the number of threads is changed.
+ */
+class AttachmentSweep
+{
+
+    /// one buffer for each thread
+    AttachmentBuffer * buffers;
+
+    /// number of buffers
+    unsigned           nbBuffers;
+
+    /// arguments passed to the threads
+    template < typename T >
+    struct Work
+    {
+        AttachmentBuffer * buffers;
+        T * const*         objs;
+        unsigned           cnt;
+        void (T::*func)(AttachmentBuffer&);
+    };
+
+    /// job executed by the threads: call `func` for a slice of the objects
+    template < typename T >
+    static void job(void * arg, unsigned rank, unsigned size)
+    {
+        Work<T> const* w = static_cast<Work<T> const*>(arg);
+        AttachmentBuffer & buf = w->buffers[rank];
+        const unsigned start = ( w->cnt * (unsigned long)rank ) / size;
+        const unsigned stop = ( w->cnt * (unsigned long)(rank+1) ) / size;
+        for ( unsigned i = start; i < stop; ++i )
+            (w->objs[i]->*w->func)(buf);
+    }
+
+    /// allocate one buffer for each thread, and clear them
+    void prepare(unsigned, FiberGrid const&);
+
+    /// execute the attempts recorded in the buffers
+    void commit(FiberGrid const&);
+
+    /// Disabled copy constructor
+    AttachmentSweep(AttachmentSweep const&);
+
+    /// Disabled copy assignment
+    AttachmentSweep& operator = (AttachmentSweep const&);
+
+public:
+
+    /// constructor
+    AttachmentSweep() : buffers(0), nbBuffers(0) {}
+
+    /// destructor
+    ~AttachmentSweep() { delete[] buffers; }
+
+    /// release the buffers, such that their generators are seeded again from RNG by run()
+    void reset() { delete[] buffers; buffers = 0; nbBuffers = 0; }
+
+    /// call `(obj->*func)()` for the `cnt` objects in parallel, and then commit()
+    template < typename T >
+    void run(ThreadPool& pool, FiberGrid const& grid, T * const* objs, unsigned cnt, void (T::*func)(AttachmentBuffer&))
+    {
+        prepare(pool.size(), grid);
+        Work<T> w;
+        w.buffers = buffers;
+        w.objs    = objs;
+        w.cnt     = cnt;
+        w.func    = func;
+        pool.run(job<T>, &w);
+        commit(grid);
+    }
+};
+
+#endif
+
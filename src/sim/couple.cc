@@ -13,6 +13,7 @@
 #include "modulo.h"
 #include "aster.h"
 #include "aster_prop.h"
+#include "attachment_sweep.h"
 
 extern Random RNG;
 extern Modulo * modulo;
@@ -94,12 +95,10 @@ void Couple::setInteractions(Meca & meca) const
 //------------------------------------------------------------------------------
 #pragma mark -
 
-void Couple::stepFF(const FiberGrid& grid)
+void Couple::diffuse(Random& rng)
 {
-    assert_true( !attached1() && !attached2() );
-    
     // diffusion step:
-    cPos.addRand( prop->diffusion_dt);
+    cPos.addRand(prop->diffusion_dt, rng);
     
     // confinement:
     if ( prop->confine == CONFINE_INSIDE )
@@ -115,6 +114,14 @@ void Couple::stepFF(const FiberGrid& grid)
         assert_true(spc);
         spc->project(cPos);        
     }    
+}
+
+
+void Couple::stepFF(const FiberGrid& grid)
+{
+    assert_true( !attached1() && !attached2() );
+    
+    diffuse(RNG);
 
     // activity (attachment):
     cHand1->stepFree(grid, cPos);
@@ -122,6 +129,17 @@ void Couple::stepFF(const FiberGrid& grid)
 }
 
 
+void Couple::sweepFF(AttachmentBuffer& buf)
+{
+    assert_true( !attached1() && !attached2() );
+    
+    diffuse(buf.rng);
+    
+    cHand1->sweepFree(buf, cPos);
+    cHand2->sweepFree(buf, cPos);
+}
+
+
 void Couple::stepAF(const FiberGrid& grid)
 {
     assert_true( attached1() && !attached2() );
@@ -359,6 +377,20 @@ void Couple::read(InputWrapper & in, Simul& sim)
     }
 }
 
+
+void Couple::writeState(OutputWrapper& out) const
+{
+    cHand1->writeState(out);
+    cHand2->writeState(out);
+}
+
+
+void Couple::readState(InputWrapper& in)
+{
+    cHand1->readState(in);
+    cHand2->readState(in);
+}
+
 //------------------------------------------------------------------------------
 
 int Couple::whichLinkAA() const
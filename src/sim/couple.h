@@ -11,6 +11,7 @@
 class Meca;
 class Glossary;
 class FiberGrid;
+class AttachmentBuffer;
 
 
 /// A set of two Hand linked by an elastic element
@@ -138,9 +139,15 @@ public:
    
     //--------------------------------------------------------------------------
 
+    /// diffusion and confinement of a free Couple, using the given generator
+    void           diffuse(Random&);
+
     /// simulation step for a free Couple: diffusion
     virtual void   stepFF(const FiberGrid&);
     
+    /// equivalent of stepFF() called in parallel by AttachmentSweep
+    virtual void   sweepFF(AttachmentBuffer&);
+    
     /// simulation step for a Couple attached by Hand1
     void           stepAF(const FiberGrid&);
     
@@ -227,6 +234,12 @@ public:
     /// read from file
     void           read(InputWrapper&, Simul&);
     
+    /// write the state of the Hands that is not saved by write()
+    void           writeState(OutputWrapper&) const;
+    
+    /// read the state written by writeState()
+    void           readState(InputWrapper&);
+    
     /// return PointDisp of Hand1
     PointDisp *    disp1() const { return cHand1->prop->disp; }
     
@@ -83,6 +83,10 @@ void CoupleSet::step(FiberSet const& fibers, FiberGrid const& fgrid)
     // use alternate attachment strategy:
     if ( uni )
         uniAttach(fibers);
+    
+    // transfer the diffusing Couples to the arrays:
+    if ( simul.prop->free_arrays )
+        arraysCollect(simul.properties);
 
     /*
      ATTENTION: we have multiple lists, and Objects are automatically transfered
@@ -134,19 +138,36 @@ void CoupleSet::step(FiberSet const& fibers, FiberGrid const& fgrid)
     
     //std::clog << "CoupleSet::step : FF " << ffList.size() << " head " << ffHead << std::endl;
     
-    obj = ffHead;
-    while ( obj )
+    ThreadPool& pool = simul.threadPool();
+    
+    if ( pool.size() > 1 )
     {
-        nxt = obj->next();
-        obj->stepFF(fgrid);
-        obj = nxt;
+        // the Couples transfered to ffList above were linked before ffHead:
+        sweepObjs.clear();
+        for ( obj = ffHead; obj; obj = obj->next() )
+            sweepObjs.push_back(obj);
+        sweep.run(pool, fgrid, sweepObjs.addr(), sweepObjs.size(), &Couple::sweepFF);
+    }
+    else
+    {
+        obj = ffHead;
+        while ( obj )
+        {
+            nxt = obj->next();
+            obj->stepFF(fgrid);
+            obj = nxt;
+        }
     }
+    
+    if ( arrays.size() )
+        arraysStep(fgrid);
 }
 
 
 void CoupleSet::relax()
 {
     uniRelax();
+    arraysRelax();
 }
 
 //------------------------------------------------------------------------------
@@ -291,6 +312,7 @@ void CoupleSet::erase()
 {
     uni = false;
     uniRelax();
+    arraysRelax();
     ffList.erase();
     afList.erase();
     faList.erase();
@@ -302,6 +324,7 @@ void CoupleSet::erase()
 void CoupleSet::freeze()
 {
     uniRelax();
+    arraysRelax();
     ffIce.transfer(ffList);
     faIce.transfer(faList);
     afIce.transfer(afList);
@@ -386,21 +409,6 @@ int CoupleSet::bad() const
 #pragma mark -
 #pragma mark Fast Diffusion
 
-/**
- Estimate attachment propensity per unit length of fiber
- */
-real attachDensity(const HandProp * hp)
-{
-    real density = hp->binding_rate_dt;
-#if ( DIM == 2 )
-    density *= 2 * hp->binding_range;
-#elif ( DIM == 3 )
-    density *= M_PI * hp->binding_range * hp->binding_range;
-#endif
-    return density;
-}
-
-
 /**
  Implements a Monte-Carlo approach for attachments of free Couple,
  under the assumption that diffusion is sufficiently fast to
@@ -419,11 +427,15 @@ real attachDensity(const HandProp * hp)
    - the volume of the Space,
    - the binding parameters of Hands.
    .
- - Perform the estimated number of binding events:
+ - Draw the number of binding events from a Poisson distribution of this mean,
+ - Perform the binding events:
    - find a random position on a Fiber, uniformly according to length,
    - attach a couple from the reserve.
    .
  .
+ The work is proportional to the number of binding events, 
+ and not to the number of Couples or Fibers.
+ The sites are drawn with FiberSet::uniFiberSite(), which must have been prepared.
  */
 void CoupleSet::uniAttach(FiberSet const& fibers, CoupleList& reserve)
 {
@@ -443,21 +455,22 @@ void CoupleSet::uniAttach(FiberSet const& fibers, CoupleList& reserve)
     if ( volume <= 0 )
         throw InvalidParameter("couple:fast_diffusion requires a non-zero space::volume");
     
-    Array<FiberBinder> loc(1024, 1024);
+    // length of fiber per unit volume:
+    const real fiber_density = fibers.uniLength() / volume;
     
     // attach Couple::hand1
-    real density = rsize * attachDensity(obj->hand1()->prop);
+    real density = rsize * obj->hand1()->prop->attachDensity();
     if ( density > 0 )
     {
-        // the average distance between attachment estimated from the concentration of Hands
-        fibers.uniFiberSites(loc, volume/density);
+        unsigned cnt = RNG.poisson(density * fiber_density);
         
-        for ( unsigned int s = 0; s < loc.size(); ++s )
+        for ( ; cnt > 0; --cnt )
         {
             assert_true(!obj->cHand2->attached());
-            if ( obj->cHand1->attachmentAllowed(loc[s]) )
+            FiberBinder site = fibers.uniFiberSite();
+            if ( obj->cHand1->attachmentAllowed(site) )
             {
-                obj->cHand1->attach(loc[s]);
+                obj->cHand1->attach(site);
                 reserve.pop();
                 link(obj);
                 if ( reserve.empty() )
@@ -471,18 +484,18 @@ void CoupleSet::uniAttach(FiberSet const& fibers, CoupleList& reserve)
     assert_true(obj==reserve.top());
     
     // attach Couple::hand2
-    density = rsize * attachDensity(obj->hand2()->prop);
+    density = rsize * obj->hand2()->prop->attachDensity();
     if ( density > 0 )
     {
-        // the average distance between attachment estimated from the concentration of Hands
-        fibers.uniFiberSites(loc, volume/density);
+        unsigned cnt = RNG.poisson(density * fiber_density);
         
-        for ( unsigned int s = 0; s < loc.size(); ++s )
+        for ( ; cnt > 0; --cnt )
         {
             assert_true(!obj->cHand1->attached());
-            if ( obj->cHand2->attachmentAllowed(loc[s]) )
+            FiberBinder site = fibers.uniFiberSite();
+            if ( obj->cHand2->attachmentAllowed(site) )
             {
-                obj->cHand2->attach(loc[s]);
+                obj->cHand2->attach(site);
                 reserve.pop();
                 link(obj);
                 if ( reserve.empty() )
@@ -518,6 +531,9 @@ void CoupleSet::uniAttach(FiberSet const& fibers)
         obj = nxt;
     }
     
+    if ( fibers.uniLength() <= 0 )
+        return;
+    
     // uniform attachment for reserved couples:
     for ( CoupleReserve::iterator c = uniLists.begin(); c < uniLists.end(); ++c )
         if ( ! (*c).empty() )
@@ -575,3 +591,120 @@ void CoupleSet::uniRelax()
     }
 }
 
+
+//------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Free Arrays
+
+/**
+ Set the classes of `arrays` from the current properties,
+ and transfer the free Couples that can be stepped by FreeArrays.
+ 
+ This applies to the plain Couple (couple:activity = diffuse), since derived classes
+ may redefine stepFF(). The Couples with fast_diffusion are handled by uniAttach(),
+ and a Nucleator redefines Hand::stepFree().
+ */
+void CoupleSet::arraysCollect(PropertyList const& properties)
+{
+    arrays.clearClasses();
+    
+    PropertyList plist = properties.find_all("couple");
+    
+    for ( PropertyList::const_iterator n = plist.begin(); n != plist.end(); ++n )
+    {
+        CoupleProp const * p = static_cast<CoupleProp const*>(*n);
+        if ( p->activity == "diffuse"  &&  !p->fast_diffusion
+            &&  p->hand_prop1->activity != "nucleate"
+            &&  p->hand_prop2->activity != "nucleate" )
+        {
+            FreeArrays::Class c;
+            c.used         = true;
+            c.diffusion_dt = p->diffusion_dt;
+            c.confine      = p->confine;
+            c.space        = p->confine_space_ptr;
+            c.rate_dt[0]   = p->hand_prop1->binding_rate_dt;
+            c.rate_dt[1]   = p->hand_prop2->binding_rate_dt;
+            arrays.setClass(p->index(), c);
+        }
+    }
+    
+    Couple * obj = firstFF(), * nxt = obj;
+    while ( nxt )
+    {
+        nxt = nxt->next();
+        const unsigned k = obj->property()->index();
+        if ( arrays.accepts(k) )
+        {
+            real t[2] = { obj->cHand1->attachTime(), obj->cHand2->attachTime() };
+            ffList.pop(obj);
+            arrays.add(obj, obj->posFree(), k, t);
+        }
+        obj = nxt;
+    }
+}
+
+
+/**
+ This is equivalent to Couple::stepFF() for all the Couples in `arrays`.
+ The Hands whose attachment time became negative try to bind, and if
+ at least one succeeds, the Couple is removed from `arrays` and linked.
+ 
+ The fired times are processed from the end, such that removing a Couple,
+ which is replaced by the last one, does not affect the times not yet processed.
+ */
+void CoupleSet::arraysStep(FiberGrid const& fgrid)
+{
+    arrays.diffuse(RNG);
+    arrays.countdown(arraysFired);
+    
+    unsigned n = arraysFired.size();
+    while ( n > 0 )
+    {
+        const unsigned i = arraysFired[n-1] / 2;
+        // the times of a Couple are contiguous, with hand1 first:
+        unsigned f = n - 1;
+        if ( f > 0  &&  arraysFired[f-1] / 2 == i )
+            --f;
+        
+        Couple * obj = static_cast<Couple*>(arrays.object(i));
+        obj->setPosition(arrays.position(i));
+
+        bool attached = false;
+        for ( unsigned u = f; u < n; ++u )
+        {
+            const unsigned h = arraysFired[u] % 2;
+            Hand * ha = h ? obj->cHand2 : obj->cHand1;
+            arrays.time(i, h) = RNG.exponential();
+            if ( fgrid.tryToAttach(arrays.position(i), *ha) )
+                attached = true;
+        }
+        
+        if ( attached )
+        {
+            obj->cHand1->attachTime(arrays.time(i, 0));
+            obj->cHand2->attachTime(arrays.time(i, 1));
+            arrays.remove(i);
+            link(obj);
+        }
+        n = f;
+    }
+}
+
+
+/**
+ Copy the position and the attachment times back to the Couples,
+ and return them to ffList.
+ */
+void CoupleSet::arraysRelax()
+{
+    for ( unsigned i = 0; i < arrays.size(); ++i )
+    {
+        Couple * obj = static_cast<Couple*>(arrays.object(i));
+        obj->setPosition(arrays.position(i));
+        obj->cHand1->attachTime(arrays.time(i, 0));
+        obj->cHand2->attachTime(arrays.time(i, 1));
+        ffList.push_front(obj);
+    }
+    arrays.clear();
+}
+
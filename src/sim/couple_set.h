@@ -6,6 +6,8 @@
 #include "object_set.h"
 #include "couple.h"
 #include "couple_prop.h"
+#include "attachment_sweep.h"
+#include "free_arrays.h"
 #include <stack>
 
 /// Set for Couple
@@ -16,6 +18,9 @@
  - faList = hand1 free, hand2 attached.
  - aaList = hand1 and hand2 attached [also called bridge].
  .
+ If simul:free_arrays is true, the free Couples that only diffuse are removed from ffList,
+ and stepped from the contiguous arrays of a FreeArrays, until one of their Hands binds,
+ or until relax() is called.
  The lists are accessible via firstFF() and firstFA(), firstAF() and firstAA.
  This way, when scanning the Couple, the states of both hands are known,
  and we can save the corresponding tests. This is very efficient.
@@ -66,11 +71,32 @@ private:
     
     /// return Couples in uniLists to the normal lists
     void         uniRelax();
+    
+    /// used to step the free Couples in parallel
+    AttachmentSweep    sweep;
+    
+    /// the free Couples, in the order of ffList
+    Array<Couple*>     sweepObjs;
+    
+    /// state of the free Couples that are stepped from arrays, if simul:free_arrays is true
+    FreeArrays         arrays;
+    
+    /// times of arrays that became negative during the current step
+    Array<unsigned>    arraysFired;
+    
+    /// transfer the eligible Couples from ffList to `arrays`
+    void         arraysCollect(PropertyList const&);
+    
+    /// step the Couples stored in `arrays`, linking those that have attached
+    void         arraysStep(FiberGrid const&);
+    
+    /// return the Couples stored in `arrays` to ffList
+    void         arraysRelax();
 
 public:
     
     ///creator
-    CoupleSet(Simul& s) : ObjectSet(s), ffList(this), afList(this), faList(this), aaList(this), uni(false) {}
+    CoupleSet(Simul& s) : ObjectSet(s), ffList(this), afList(this), faList(this), aaList(this), uni(false), arrays(2) {}
     
     ///destructor
     virtual ~CoupleSet() {}
@@ -91,6 +117,9 @@ public:
     /// construct object
     Object *     newObjectT(const Tag tag, int prop_index);
 
+    /// true if couple:fast_diffusion is used, in which case FiberSet::uniPrepare() must be called before step()
+    bool         fastDiffusion() const { return uni; }
+    
     /// first free
     Couple *     firstFF()     const { return static_cast<Couple*>(ffList.first()); }
     
@@ -132,6 +161,9 @@ public:
     /// mix order of elements
     void         mix();
     
+    /// discard the generators used to step the free Couples in parallel
+    void         resetSweep() { sweep.reset(); }
+    
     
     
     /// prepare for step()
@@ -7,6 +7,7 @@
 #include "meca.h"
 #include "random.h"
 #include "space.h"
+#include "attachment_sweep.h"
 
 extern Modulo* modulo;
 extern Random RNG;
@@ -97,23 +98,7 @@ void Bridge::stepFF(const FiberGrid& grid)
 {
     assert_true( !attached1() && !attached2() );
     
-    // diffusion:
-    cPos.addRand( prop->diffusion_dt );
-    
-    // confinement
-    if ( prop->confine == CONFINE_INSIDE )
-    {
-        const Space* spc = prop->confine_space_ptr;
-        assert_true(spc);
-        if ( ! spc->inside(cPos) )
-            spc->bounce(cPos);
-    }
-    else if ( prop->confine == CONFINE_SURFACE )
-    {
-        const Space* spc = prop->confine_space_ptr;
-        assert_true(spc);
-        spc->project(cPos);        
-    }    
+    diffuse(RNG);
     
     // activity (attachment):
     if ( prop->trans_activated )
@@ -128,4 +113,16 @@ void Bridge::stepFF(const FiberGrid& grid)
 }
 
 
+void Bridge::sweepFF(AttachmentBuffer& buf)
+{
+    assert_true( !attached1() && !attached2() );
+    
+    diffuse(buf.rng);
+    
+    cHand1->sweepFree(buf, cPos);
+    if ( !prop->trans_activated )
+        cHand2->sweepFree(buf, cPos);
+}
+
+
 
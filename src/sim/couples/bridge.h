@@ -45,6 +45,9 @@ public:
     
     /// simulation step for a free Couple, implementing BridgeProp::trans_activated
     void    stepFF(const FiberGrid&);
+    
+    /// equivalent of stepFF() called in parallel by AttachmentSweep
+    void    sweepFF(AttachmentBuffer&);
  
     /// force between hands
     Vector  force1() const;
@@ -5,6 +5,7 @@
 #include "exceptions.h"
 #include "random.h"
 #include "space.h"
+#include "attachment_sweep.h"
 
 extern Random RNG;
 
@@ -67,23 +68,7 @@ void Crosslink::stepFF(const FiberGrid& grid)
 {
     assert_true( !attached1() && !attached2() );
     
-    // diffusion:
-    cPos.addRand( prop->diffusion_dt );
-    
-    // confinement:
-    if ( prop->confine == CONFINE_INSIDE )
-    {
-        const Space* spc = prop->confine_space_ptr;
-        assert_true(spc);
-        if ( ! spc->inside(cPos) )
-            spc->bounce(cPos);
-    }
-    else if ( prop->confine == CONFINE_SURFACE )
-    {
-        const Space* spc = prop->confine_space_ptr;
-        assert_true(spc);
-        spc->project(cPos);        
-    }    
+    diffuse(RNG);
     
     // activity (attachment):
     if ( prop->trans_activated )
@@ -97,3 +82,15 @@ void Crosslink::stepFF(const FiberGrid& grid)
     }
 }
 
+
+void Crosslink::sweepFF(AttachmentBuffer& buf)
+{
+    assert_true( !attached1() && !attached2() );
+    
+    diffuse(buf.rng);
+    
+    cHand1->sweepFree(buf, cPos);
+    if ( !prop->trans_activated )
+        cHand2->sweepFree(buf, cPos);
+}
+
@@ -38,6 +38,9 @@ public:
     /// simulation step for a free Couple, implementing CrosslinkProp::trans_activated
     void    stepFF(const FiberGrid&);
     
+    /// equivalent of stepFF() called in parallel by AttachmentSweep
+    void    sweepFF(AttachmentBuffer&);
+    
 };
 
 
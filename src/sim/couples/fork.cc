@@ -4,6 +4,9 @@
 #include "fork_prop.h"
 #include "meca.h"
 #include "space.h"
+#include "attachment_sweep.h"
+
+extern Random RNG;
 
 
 //------------------------------------------------------------------------------
@@ -24,23 +27,7 @@ void Fork::stepFF(const FiberGrid& grid)
 {
     assert_true( !attached1() && !attached2() );
     
-    // diffusion:
-    cPos.addRand( prop->diffusion_dt );
-    
-    // confinement:
-    if ( prop->confine == CONFINE_INSIDE )
-    {
-        const Space* spc = prop->confine_space_ptr;
-        assert_true(spc);
-        if ( ! spc->inside(cPos) )
-            spc->bounce(cPos);
-    }
-    else if ( prop->confine == CONFINE_SURFACE )
-    {
-        const Space* spc = prop->confine_space_ptr;
-        assert_true(spc);
-        spc->project(cPos);
-    }
+    diffuse(RNG);
     
     // activity (attachment):
     if ( prop->trans_activated )
@@ -55,6 +42,18 @@ void Fork::stepFF(const FiberGrid& grid)
 }
 
 
+void Fork::sweepFF(AttachmentBuffer& buf)
+{
+    assert_true( !attached1() && !attached2() );
+    
+    diffuse(buf.rng);
+    
+    cHand1->sweepFree(buf, cPos);
+    if ( !prop->trans_activated )
+        cHand2->sweepFree(buf, cPos);
+}
+
+
 void Fork::setInteractions(Meca & meca) const
 {
     PointInterpolated pt1 = cHand1->interpolation();
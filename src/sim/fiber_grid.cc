@@ -108,6 +108,10 @@ void FiberGrid::clear()
 {
     // this is to be able to detect if paintGrid() is not called:
     gridRange = 0;
+    gridSkin = 0;
+    painted.clear();
+    compact = false;
+    rods.clear();
     
     mGrid.clear();
 }
@@ -169,6 +173,104 @@ void paintCellPeriodic(const int x_inf, const int x_sup, const int y, const int
     }
 }
 
+
+/// remove one occurence of `seg` from `list`, without preserving the order
+inline void eraseSegment(FiberGrid::SegmentList & list, FiberLocus const* seg)
+{
+    int i = list.find(seg);
+    if ( i >= 0 )
+    {
+        list[i] = list[list.size()-1];
+        list.truncate(list.size()-1);
+    }
+}
+
+
+/**
+ eraseCell(x,y,z) removes a Segment from the SegmentList associated with
+ the grid point (x,y,z), reverting paintCell().
+ It is called by the rasterizer function paintFatLine().
+ */
+
+void eraseCell(const int x_inf, const int x_sup, const int y, const int z, void * arg1, void * arg2)
+{
+    FiberLocus const* seg = static_cast<FiberLocus const*>(arg1);
+    FiberGrid::grid_type * mGrid = static_cast<FiberGrid::grid_type *>(arg2);
+    
+#if   ( DIM == 1 )
+    FiberGrid::SegmentList & inf = mGrid->cell1D( x_inf );
+    FiberGrid::SegmentList & sup = mGrid->cell1D( x_sup );
+#elif ( DIM == 2 )
+    FiberGrid::SegmentList & inf = mGrid->cell2D( x_inf, y );
+    FiberGrid::SegmentList & sup = mGrid->cell2D( x_sup, y );
+#elif ( DIM == 3 )
+    FiberGrid::SegmentList & inf = mGrid->cell3D( x_inf, y, z );
+    FiberGrid::SegmentList & sup = mGrid->cell3D( x_sup, y, z );
+#endif
+    
+    for ( FiberGrid::SegmentList * list = &inf; list <= &sup; ++list )
+        eraseSegment(*list, seg);
+}
+
+
+/**
+ eraseCellPeriodic(x,y,z) removes a Segment from the SegmentList associated with
+ the grid point (x,y,z), reverting paintCellPeriodic().
+ */
+
+void eraseCellPeriodic(const int x_inf, const int x_sup, const int y, const int z, void * arg1, void * arg2)
+{
+    FiberLocus const* seg = static_cast<FiberLocus const*>(arg1);
+    FiberGrid::grid_type * mGrid = static_cast<FiberGrid::grid_type *>(arg2);
+    
+    for ( int x = x_inf; x <= x_sup; ++x )
+    {
+#if   ( DIM == 1 )
+        eraseSegment(mGrid->cell1D( x ), seg);
+#elif ( DIM == 2 )
+        eraseSegment(mGrid->cell2D( x, y ), seg);
+#elif ( DIM == 3 )
+        eraseSegment(mGrid->cell3D( x, y, z ), seg);
+#endif
+    }
+}
+
+
+/**
+ markCell(x,y,z) records the index of the cells (x_inf to x_sup, y, z) in the Array
+ given as first argument. It is called by the rasterizer function paintFatLine(),
+ and it covers the same cells as paintCell().
+ */
+
+void markCell(const int x_inf, const int x_sup, const int y, const int z, void * arg1, void * arg2)
+{
+    Array<unsigned> * marks = static_cast<Array<unsigned>*>(arg1);
+    FiberGrid::grid_type * mGrid = static_cast<FiberGrid::grid_type *>(arg2);
+    
+    int inf[3] = { x_inf, y, z };
+    int sup[3] = { x_sup, y, z };
+    const unsigned i_sup = mGrid->indexFromCoordinates(sup);
+    
+    for ( unsigned i = mGrid->indexFromCoordinates(inf); i <= i_sup; ++i )
+        marks->push_back(i);
+}
+
+
+/**
+ markCellPeriodic(x,y,z) records the index of the cells (x_inf to x_sup, y, z),
+ and it covers the same cells as paintCellPeriodic().
+ */
+
+void markCellPeriodic(const int x_inf, const int x_sup, const int y, const int z, void * arg1, void * arg2)
+{
+    Array<unsigned> * marks = static_cast<Array<unsigned>*>(arg1);
+    FiberGrid::grid_type * mGrid = static_cast<FiberGrid::grid_type *>(arg2);
+    
+    int coord[3] = { x_inf, y, z };
+    for ( ; coord[0] <= x_sup; ++coord[0] )
+        marks->push_back(mGrid->indexFromCoordinates(coord));
+}
+
 //------------------------------------------------------------------------------
 /**
 paintGrid( first_fiber, last_fiber, max_range ) links all segments found in 'fiber' and its
@@ -196,48 +298,314 @@ paintGrid( first_fiber, last_fiber, max_range ) links all segments found in 'fib
  calls the function paint() above.
  */
 
-void FiberGrid::paintGrid(const Fiber * first, const Fiber * last, const real max_range)
+void FiberGrid::rasterize(paint_function func, void * arg,
+                          Vector const& P, Vector const& Q, real width, real len)
 {
-    clear();
-    gridRange = max_range;
+    const real* offset = mGrid.inf();
+    const real* deltas = mGrid.delta();
+#if   (DIM == 1)
+    Rasterizer::paintFatLine1D(func, arg, &mGrid, P, Q, width, offset, deltas);
+#elif (DIM == 2)
+    Rasterizer::paintFatLine2D(func, arg, &mGrid, P, Q, width, offset, deltas, len);
+#elif (DIM == 3)
+    //Rasterizer::paintHexLine3D(func, arg, &mGrid, P, Q, width, offset, deltas, len);
+    Rasterizer::paintFatLine3D(func, arg, &mGrid, P, Q, width, offset, deltas, len);
+    //Rasterizer::paintBox3D(func, arg, &mGrid, P, Q, width, offset, deltas);
+#endif
+}
+
+
+/**
+ If `rec` is not null, the positions of the segments are recorded, and the
+ length of the segments is calculated by the Rasterizer, such that the same cells
+ can be found again to erase the segment.
+ Otherwise, the segmentation of the Fiber is used as an approximation of the length.
+ */
+void FiberGrid::paintFiber(paint_function func, Fiber const* fib, real width, Painted * rec)
+{
+    const unsigned nbs = fib->nbSegments();
+
+    if ( rec )
+    {
+        rec->identity = fib->number();
+        rec->segments = &fib->segment(0);
+        rec->nbSeg    = nbs;
+        rec->seen     = true;
+        rec->ends.resize(2*DIM*nbs);
+        
+        real * ends = &rec->ends[0];
+        for ( unsigned s = 0; s < nbs; ++s, ends += 2*DIM )
+        {
+            Vector P = fib->posPoint(s);
+            Vector Q = fib->posPoint(s+1);
+            rasterize(func, &fib->segment(s), P, Q, width, 0);
+            P.put(ends);
+            Q.put(ends+DIM);
+        }
+        return;
+    }
+    
+    Vector Q, P = fib->posPoint(0);
+    real S = fib->segmentation();
     
+    for ( unsigned pp = 1; pp <= nbs; ++pp )
+    {
+        FiberLocus * seg = &(fib->segment(pp-1));
+        
+        if ( pp & 1 )
+            Q = fib->posPoint(pp);
+        else
+            P = fib->posPoint(pp);
+        
+        rasterize(func, seg, P, Q, width, S);
+    }
+}
+
+
+void FiberGrid::paintGrid(const Fiber * first, const Fiber * last, const real max_range, const real skin)
+{
     assert_true(hasGrid());
     
-    const real* offset = mGrid.inf();
-    const real* deltas = mGrid.delta();
+    if ( skin > 0  &&  gridSkin == skin  &&  gridRange == max_range )
+    {
+        updateGrid(first, last);
+        return;
+    }
+    
+    clear();
+    gridRange = max_range;
+    
     real width = gridRange + 0.5 * mGrid.diagonalLength();
     
     //define the painting function used:
-    void (*paint)(int, int, int, int, void*, void*) = modulo ? paintCellPeriodic : paintCell;
+    paint_function paint = modulo ? paintCellPeriodic : paintCell;
+    
+    if ( skin > 0 )
+    {
+        gridSkin = skin;
+        width += skin;
+        for ( const Fiber * fib = first; fib != last ; fib=fib->next() )
+            paintFiber(paint, fib, width, &painted[fib]);
+    }
+    else
+    {
+        for ( const Fiber * fib = first; fib != last ; fib=fib->next() )
+            paintFiber(paint, fib, width, 0);
+    }
+}
+
+
+/**
+ The segments of a Fiber that has been painted before are repainted individually,
+ if one of their ends has moved by more than gridSkin.
+ The Fibers that were deleted, or which have a different number of points,
+ or for which the segments were reallocated are erased entirely.
+ All the erasing is done before any new segment is painted, since the address
+ of a new segment may be identical to the one of a deleted segment.
+ */
+void FiberGrid::updateGrid(const Fiber * first, const Fiber * last)
+{
+    const real width = gridRange + gridSkin + 0.5 * mGrid.diagonalLength();
+    const real skinSqr = gridSkin * gridSkin;
+    
+    paint_function paint = modulo ? paintCellPeriodic : paintCell;
+    paint_function erase = modulo ? eraseCellPeriodic : eraseCell;
+    
+    for ( PaintedMap::iterator i = painted.begin(); i != painted.end(); ++i )
+        i->second.seen = false;
+    
+    // Fibers that need to be painted entirely:
+    std::vector<Fiber const*> fresh;
+    
+    for ( const Fiber * fib = first; fib != last ; fib=fib->next() )
+    {
+        PaintedMap::iterator i = painted.find(fib);
+        
+        if ( i == painted.end() )
+        {
+            fresh.push_back(fib);
+            continue;
+        }
+        
+        Painted & rec = i->second;
+        
+        if ( rec.identity != fib->number()
+            || rec.nbSeg != fib->nbSegments()
+            || rec.segments != &fib->segment(0) )
+        {
+            // the record will be erased below:
+            fresh.push_back(fib);
+            continue;
+        }
+        
+        rec.seen = true;
+        real * ends = &rec.ends[0];
+        
+        for ( unsigned s = 0; s < rec.nbSeg; ++s, ends += 2*DIM )
+        {
+            Vector P = fib->posPoint(s);
+            Vector Q = fib->posPoint(s+1);
+            
+            if ( distanceSqr(P, Vector(ends)) > skinSqr || distanceSqr(Q, Vector(ends+DIM)) > skinSqr )
+            {
+                FiberLocus * seg = const_cast<FiberLocus*>(rec.segments + s);
+                rasterize(erase, seg, Vector(ends), Vector(ends+DIM), width, 0);
+                rasterize(paint, seg, P, Q, width, 0);
+                P.put(ends);
+                Q.put(ends+DIM);
+            }
+        }
+    }
+    
+    /*
+     Erase the Fibers that were not found, or have changed.
+     They are sorted by serial number, since the order in which segments are erased
+     affects the order of the lists, and the map is ordered by address.
+     */
+    std::map<Number, PaintedMap::iterator> stale;
+    for ( PaintedMap::iterator i = painted.begin(); i != painted.end(); ++i )
+    {
+        if ( !i->second.seen )
+            stale[i->second.identity] = i;
+    }
+    
+    for ( std::map<Number, PaintedMap::iterator>::iterator n = stale.begin(); n != stale.end(); ++n )
+    {
+        Painted & rec = n->second->second;
+        real * ends = &rec.ends[0];
+        for ( unsigned s = 0; s < rec.nbSeg; ++s, ends += 2*DIM )
+            rasterize(erase, const_cast<FiberLocus*>(rec.segments+s), Vector(ends), Vector(ends+DIM), width, 0);
+        painted.erase(n->second);
+    }
+    
+    for ( unsigned n = 0; n < fresh.size(); ++n )
+        paintFiber(paint, fresh[n], width, &painted[fresh[n]]);
+}
+
+
+
+/**
+ This builds the compact representation of the grid in two passes:
+ - the segments are copied to `rods`, and the cells covered by each segment are
+ recorded in `marks`, using the Rasterizer with the same width as paintGrid(),
+ - the number of Rods in each cell is counted to set `cellStart`,
+ and the index of the Rods are distributed to `cellRods`.
+ .
+ */
+void FiberGrid::paintCompact(const Fiber * first, const Fiber * last, const real max_range)
+{
+    assert_true(hasGrid());
+    
+    if ( !compact )
+    {
+        clear();
+        compact = true;
+    }
+    gridRange = max_range;
+    
+    const real width = gridRange + 0.5 * mGrid.diagonalLength();
+    paint_function mark = modulo ? markCellPeriodic : markCell;
+    
+    rods.clear();
+    marks.clear();
+    rodMarks.clear();
     
     for ( const Fiber * fib = first; fib != last ; fib=fib->next() )
     {
+        const unsigned nbs = fib->nbSegments();
         Vector Q, P = fib->posPoint(0);
         real S = fib->segmentation();
         
-        for ( unsigned pp = 1; pp < fib->nbPoints(); ++pp )
+        for ( unsigned pp = 1; pp <= nbs; ++pp )
         {
-            FiberLocus * seg = &(fib->segment(pp-1));
-            
             if ( pp & 1 )
                 Q = fib->posPoint(pp);
             else
                 P = fib->posPoint(pp);
             
-#if   (DIM == 1)
-            Rasterizer::paintFatLine1D(paint, seg, &mGrid, P, Q, width, offset, deltas);
-#elif (DIM == 2)
-            Rasterizer::paintFatLine2D(paint, seg, &mGrid, P, Q, width, offset, deltas, S);
-#elif (DIM == 3)
-            //Rasterizer::paintHexLine3D(paint, seg, &mGrid, P, Q, width, offset, deltas, S);
-            Rasterizer::paintFatLine3D(paint, seg, &mGrid, P, Q, width, offset, deltas, S);
-            //Rasterizer::paintBox3D(paint, seg, &mGrid, P, Q, width, offset, deltas);
-#endif
+            Rod rod;
+            rod.pos1  = fib->posPoint(pp-1);
+            rod.pos2  = fib->posPoint(pp);
+            rod.len   = S;
+            rod.seg   = &(fib->segment(pp-1));
+            rod.first = ( pp == 1 );
+            rod.last  = ( pp == nbs );
+            rods.push_back(rod);
+            
+            rodMarks.push_back(marks.size());
+            rasterize(mark, &marks, P, Q, width, S);
         }
     }
+    rodMarks.push_back(marks.size());
+    
+    // count the Rods in each cell:
+    const unsigned nbc = mGrid.nbCells();
+    cellStart.resize(nbc+1);
+    cellStart.zero(0);
+    for ( unsigned i = 0; i < marks.size(); ++i )
+        ++cellStart[marks[i]+1];
+    
+    for ( unsigned c = 0; c < nbc; ++c )
+        cellStart[c+1] += cellStart[c];
+    
+    // distribute the Rods, using cellStart[c] as a cursor in cell `c`:
+    cellRods.resize(marks.size());
+    for ( unsigned r = 0; r < rods.size(); ++r )
+    {
+        for ( unsigned i = rodMarks[r]; i < rodMarks[r+1]; ++i )
+            cellRods[cellStart[marks[i]]++] = r;
+    }
+    
+    // restore the start of the cells:
+    for ( unsigned c = nbc; c > 0; --c )
+        cellStart[c] = cellStart[c-1];
+    cellStart[0] = 0;
+}
+
+
+/**
+ This is identical to FiberLocus::projectPoint(), using the positions stored in the Rod
+ */
+void FiberGrid::projectRod(Rod const& rod, Vector const& w, real& abs, real& dis) const
+{
+    Vector dx = rod.pos2 - rod.pos1;
+    Vector aw = w - rod.pos1;
+    
+    if ( modulo )
+        modulo->fold(aw);
+    
+    // project with the scalar product:
+    abs = ( aw * dx ) / rod.len;
+    
+    // test boundaries of segment:
+    if ( abs < 0 )
+    {
+        if ( rod.first )
+            dis = w.distanceSqr(rod.pos1);
+    }
+    else if ( abs > rod.len )
+    {
+        if ( rod.last )
+            dis = w.distanceSqr(rod.pos2);
+    }
+    else
+    {
+#if ( DIM == 1 )
+        dis = 0;
+#else
+        dis = aw.normSqr() - abs * abs;
+#endif
+    }
 }
 
 
+unsigned * FiberGrid::cellRodList(Vector const& place, unsigned& cnt) const
+{
+    const unsigned indx = mGrid.index(place, 0.5);
+    cnt = cellStart[indx+1] - cellStart[indx];
+    return cellRods.addr() + cellStart[indx];
+}
+
 
 //============================================================================
 #pragma mark -
@@ -256,6 +624,9 @@ bool FiberGrid::tryToAttach(Vector const& place, Hand& ha) const
         //throw InvalidParameter("the FiberGrid range was exceeded");
     }
     
+    if ( compact )
+        return tryToAttachCompact(place, ha);
+    
     //get the grid node list index closest to the position in space:
     const unsigned int indx = mGrid.index(place, 0.5);
     
@@ -295,6 +666,129 @@ bool FiberGrid::tryToAttach(Vector const& place, Hand& ha) const
 }
 
 
+/**
+ This is equivalent to tryToAttach(), using the Rods stored by paintCompact().
+ The Fiber is only accessed if the Hand is within range.
+ */
+bool FiberGrid::tryToAttachCompact(Vector const& place, Hand& ha) const
+{
+    unsigned cnt;
+    unsigned * list = cellRodList(place, cnt);
+    
+    //randomize the list, as done by Array::mix()
+    for ( unsigned jj = cnt; jj > 1; )
+    {
+        unsigned kk = RNG.pint() % jj;
+        --jj;
+        unsigned tmp = list[jj];
+        list[jj] = list[kk];
+        list[kk] = tmp;
+    }
+    
+    for ( unsigned n = 0; n < cnt; ++n )
+    {
+        Rod const& rod = rods[list[n]];
+        
+        real abs, dis = INFINITY;
+        projectRod(rod, place, abs, dis);
+        
+        if ( dis > ha.prop->binding_range_sqr )
+            continue;
+        
+        Fiber * fib = const_cast<Fiber*>(rod.seg->fiber());
+        
+        FiberBinder site(fib, fib->abscissaP(rod.seg->point())+abs);
+        
+        if ( ha.attachmentAllowed(site) )
+        {
+            ha.attach(site);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+
+/**
+ This performs the search done by tryToAttach(), without attaching the Hand.
+ The grid is not modified, and several threads can call this function simultaneously.
+ The Hand should then be attached by attachToOne().
+ */
+void FiberGrid::findSites(Vector const& place, Hand const& ha, SiteList& res) const
+{
+    assert_true( hasGrid() );
+    
+    if ( gridRange < ha.prop->binding_range )
+        printf("Warning: the FiberGrid range was exceeded:\n");
+    
+    if ( compact )
+    {
+        unsigned cnt;
+        unsigned const* list = cellRodList(place, cnt);
+        
+        for ( unsigned n = 0; n < cnt; ++n )
+        {
+            Rod const& rod = rods[list[n]];
+            
+            real abs, dis = INFINITY;
+            projectRod(rod, place, abs, dis);
+            
+            if ( dis > ha.prop->binding_range_sqr )
+                continue;
+            
+            Site site;
+            site.fiber = const_cast<Fiber*>(rod.seg->fiber());
+            site.abscissa = site.fiber->abscissaP(rod.seg->point()) + abs;
+            res.push_back(site);
+        }
+        return;
+    }
+    
+    //get the list of rods associated with the cell closest to the position:
+    SegmentList & segments = mGrid.cell(mGrid.index(place, 0.5));
+    
+    for ( SegmentList::iterator si = segments.begin(); si < segments.end(); ++si )
+    {
+        FiberLocus const* loc = *si;
+        
+        real abs, dis = INFINITY;
+        loc->projectPoint(place, abs, dis);
+        
+        if ( dis > ha.prop->binding_range_sqr )
+            continue;
+        
+        Site site;
+        site.fiber = const_cast<Fiber*>(loc->fiber());
+        site.abscissa = site.fiber->abscissaP(loc->point()) + abs;
+        res.push_back(site);
+    }
+}
+
+
+/**
+ The sites are tested in a random order, and the Hand is attached to the first
+ site that is allowed. This is equivalent to the shuffling done in tryToAttach().
+ The array `sites` is reordered.
+ */
+bool FiberGrid::attachToOne(Hand& ha, Site * sites, unsigned cnt)
+{
+    while ( cnt > 0 )
+    {
+        unsigned i = RNG.pint_exc(cnt);
+        FiberBinder site(sites[i].fiber, sites[i].abscissa);
+        
+        if ( ha.attachmentAllowed(site) )
+        {
+            ha.attach(site);
+            return true;
+        }
+        sites[i] = sites[--cnt];
+    }
+    return false;
+}
+
+
 //------------------------------------------------------------------------------
 /** 
  This function is limited to the range given in paintGrid();
@@ -310,6 +804,28 @@ FiberGrid::SegmentList FiberGrid::nearbySegments( Vector const& place, const rea
     }
     
     SegmentList res;
+    const real DD = D*D;
+    
+    if ( compact )
+    {
+        unsigned cnt;
+        unsigned const* list = cellRodList(place, cnt);
+        
+        for ( unsigned n = 0; n < cnt; ++n )
+        {
+            Rod const& rod = rods[list[n]];
+            
+            if ( rod.seg->fiber() == exclude )
+                continue;
+            
+            real abs, dis = INFINITY;
+            projectRod(rod, place, abs, dis);
+            
+            if ( dis < DD )
+                res.push_back(rod.seg);
+        }
+        return res;
+    }
     
     //get the grid node list index closest to the position in space:
     const unsigned indx = mGrid.index( place, 0.5 );
@@ -317,7 +833,6 @@ FiberGrid::SegmentList FiberGrid::nearbySegments( Vector const& place, const rea
     //get the list of rods associated with this cell:
     SegmentList & segments = mGrid.cell(indx);
     
-    const real DD = D*D;
     for ( SegmentList::iterator si = segments.begin(); si < segments.end(); ++si )
     {
         FiberLocus const* loc = *si;
@@ -342,15 +857,36 @@ FiberGrid::SegmentList FiberGrid::nearbySegments( Vector const& place, const rea
 
 FiberLocus FiberGrid::closestSegment(Vector const& place)
 {
+    FiberLocus const* res = 0;
+    real closest = 4 * gridRange * gridRange;
+    
+    if ( compact )
+    {
+        unsigned cnt;
+        unsigned const* list = cellRodList(place, cnt);
+        
+        for ( unsigned n = 0; n < cnt; ++n )
+        {
+            Rod const& rod = rods[list[n]];
+            
+            real abs, dis = INFINITY;
+            projectRod(rod, place, abs, dis);
+            
+            if ( dis < closest )
+            {
+                closest = dis;
+                res = rod.seg;
+            }
+        }
+        return *res;
+    }
+    
     //get the cell index from the position in space:
     const unsigned indx = mGrid.index( place, 0.5 );
     
     //get the list of rods associated with this cell:
     SegmentList & segments =  mGrid.cell(indx);
     
-    FiberLocus const* res = 0;
-    real closest = 4 * gridRange * gridRange;
-    
     for ( SegmentList::iterator si = segments.begin(); si < segments.end(); ++si )
     {
         FiberLocus const* loc = *si;
@@ -7,7 +7,9 @@
 #include "vector.h"
 #include "array.h"
 #include "grid.h"
+#include "inventoried.h"
 #include <vector>
+#include <map>
 
 class FiberLocus;
 class Space;
@@ -37,12 +39,23 @@ A divide-and-conquer algorithm is used to find all segments of fibers close to a
     Finally, using a random number it tests the probability of attachment for the Hand given as argument.
  .
  
- @todo we could call paintGrid() only if the objects have moved by a certain threshold.
- This would work if we also extend the painted area around the rod, by the same threshold.
- we must also redo the paintGrid() when MT points are added or removed.
+ If paintGrid() is called with a positive \a skin, the painted area around each segment
+ is extended by \a skin, and the grid is updated incrementally at the next call:
+ a segment is repainted only if one of its ends has moved by more than \a skin
+ since it was painted, by erasing it from the cells and painting it again.
+ A Fiber is entirely repainted if its number of points has changed, or if its segments
+ were reallocated, and the segments of Fibers that have been deleted are erased.
+ This saves clearing and painting all cells, which is costly in 3D,
+ where the number of grid-cells is large.
  
- Such algortihm should lead to large CPU gain, if calling clear() or paintGrid() is limiting,
- which is the case in particular in 3D, because the number of grid-cells is large.
+ paintCompact() is an alternative to paintGrid(), which does not use the SegmentList of the cells.
+ The segments are copied to a contiguous array of Rod, which holds the position of their ends,
+ and the indices of the Rods painted in each cell are stored contiguously in one array,
+ in the order of the cells (Compressed Sparse Row format).
+ This array is built in two passes: the cells covered by each segment are first recorded,
+ and then distributed using a counting sort. The Rods are listed in each cell in the same
+ order as with paintGrid(), and tryToAttach() finds the same segments,
+ without accessing the Fibers to calculate the distances.
 */
 
 class FiberGrid 
@@ -55,21 +68,100 @@ public:
 
     typedef Grid<DIM, SegmentList, unsigned int> grid_type;
     
+    /// a binding site on a Fiber, found by findSites()
+    struct Site
+    {
+        Fiber * fiber;      ///< the Fiber
+        real    abscissa;   ///< abscissa from the origin of the Fiber
+    };
+    
+    /// type for a list of Site
+    typedef Array<Site> SiteList;
+
 private:
     
+    /// type of the functions called by the Rasterizer
+    typedef void (*paint_function)(int, int, int, int, void*, void*);
+
+    /// positions of the segments of a Fiber that were painted on the grid
+    struct Painted
+    {
+        Number             identity;  ///< serial number of the Fiber
+        FiberLocus const*  segments;  ///< address of the first segment of the Fiber
+        unsigned           nbSeg;     ///< number of segments
+        bool               seen;      ///< used to detect Fibers that were deleted
+        std::vector<real>  ends;      ///< position of the ends of the segments, 2*DIM values per segment
+    };
+    
+    /// type for the set of painted Fibers
+    typedef std::map<Fiber const*, Painted> PaintedMap;
+    
+    /// a segment with the position of its ends, used by paintCompact()
+    struct Rod
+    {
+        Vector             pos1;      ///< position of the first point
+        Vector             pos2;      ///< position of the second point
+        real               len;       ///< segmentation of the Fiber
+        FiberLocus const*  seg;       ///< the segment of the Fiber
+        bool               first;     ///< true if this is the first segment of the Fiber
+        bool               last;      ///< true if this is the last segment of the Fiber
+    };
+
     ///the maximum distance that can be found by the grid
     real  gridRange;
     
+    ///distance by which the painted area is extended, for incremental painting
+    real  gridSkin;
+    
+    ///the Fibers that were painted, if ( gridSkin > 0 )
+    PaintedMap painted;
+    
+    ///true if the grid was painted by paintCompact()
+    bool  compact;
+    
+    ///segments painted by paintCompact()
+    Array<Rod> rods;
+    
+    ///index in `cellRods` of the first Rod of each cell, for nbCells()+1 cells
+    Array<unsigned> cellStart;
+    
+    ///indices of the Rods in each cell, stored contiguously
+    mutable Array<unsigned> cellRods;
+    
+    ///indices of the cells covered by each Rod, used while painting
+    Array<unsigned> marks;
+    
+    ///index in `marks` of the first cell of each Rod, used while painting
+    Array<unsigned> rodMarks;
+    
     ///grid for divide-and-conquer strategies:
     grid_type mGrid;
     
     ///the modulo object
     const Modulo * modulo;
+    
+    ///call the Rasterizer to apply `func` to all cells within `width` of segment [P, Q]
+    void rasterize(paint_function func, void * arg, Vector const& P, Vector const& Q, real width, real len);
+    
+    ///paint all segments of the Fiber, recording their positions in `rec` if it is not null
+    void paintFiber(paint_function func, Fiber const*, real width, Painted * rec);
+
+    ///update the grid, repainting only the segments that have moved by more than gridSkin
+    void updateGrid(const Fiber * first, const Fiber * last);
+    
+    ///calculate the distance between the Rod and `w`, as FiberLocus::projectPoint()
+    void projectRod(Rod const&, Vector const& w, real& abs, real& dis) const;
+    
+    ///return the Rods of the cell containing `place`, setting `cnt`, if the grid is compact
+    unsigned * cellRodList(Vector const& place, unsigned& cnt) const;
+    
+    ///tryToAttach() for the compact representation
+    bool tryToAttachCompact(Vector const&, Hand&) const;
         
 public:
     
     ///creator
-    FiberGrid()             { modulo = 0; gridRange = -1; }
+    FiberGrid()             { modulo = 0; gridRange = -1; gridSkin = 0; compact = false; }
         
     ///destructor
     virtual ~FiberGrid()    { }
@@ -84,12 +176,21 @@ public:
     ///clear the grid
     void clear();
     
-    ///paint the Fibers, to be able to find up to a distance max_range
-    void paintGrid(const Fiber * first, const Fiber * last, real max_range);
+    ///paint the Fibers, to be able to find up to a distance max_range, with incremental updates if ( skin > 0 )
+    void paintGrid(const Fiber * first, const Fiber * last, real max_range, real skin = 0);
+    
+    ///paint the Fibers as paintGrid(), using the compact representation of the cells
+    void paintCompact(const Fiber * first, const Fiber * last, real max_range);
         
     ///given a position, find nearby Fiber segments and test attachement of the provided Hand
     bool tryToAttach(Vector const&, Hand&) const;
     
+    ///append to \a res the sites within reach of the Hand at the given position, without modifying the grid
+    void findSites(Vector const&, Hand const&, SiteList& res) const;
+    
+    ///attach the Hand to one of the `cnt` sites, picked randomly among those that are allowed
+    static bool attachToOne(Hand&, Site * sites, unsigned cnt);
+    
     /// return all fiber segments located at a distance D or less from P, except those belonging to \a exclude
     SegmentList nearbySegments(Vector const& P, real D, Fiber * exclude = 0);
 
@@ -23,7 +23,7 @@ int FiberGrid::setGrid(const Space *, const Modulo * mod, real, unsigned long)
     return 0;
 }
 
-void FiberGrid::paintGrid(const Fiber * first, const Fiber * last, real) 
+void FiberGrid::paintGrid(const Fiber * first, const Fiber * last, real, real) 
 {
     allSegments.clear();
     //we go through all the segments
@@ -1238,3 +1238,17 @@ void FiberNaked::read(InputWrapper & in, Simul& sim)
 #endif
 }
 
+
+void FiberNaked::writeState(OutputWrapper& out) const
+{
+    PointSet::writeState(out);
+    out.writeDouble(fnCut);
+}
+
+
+void FiberNaked::readState(InputWrapper& in)
+{
+    PointSet::readState(in);
+    fnCut = in.readDouble();
+}
+
@@ -298,6 +298,12 @@ public:
     /// read from InputWrapper
     void         read(InputWrapper&, Simul&);
     
+    /// write the exact segmentation, which is not saved by write()
+    void         writeState(OutputWrapper&) const;
+    
+    /// read the state written by writeState()
+    void         readState(InputWrapper&);
+    
 };
 
 
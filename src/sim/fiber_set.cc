@@ -324,28 +324,59 @@ void FiberSet::foldPosition(const Modulo * s) const
 
 
 /**
- Set a list of Locations on the fibers, chosen randomly with uniform sampling.
- The number of site over a stretch of length `len` should be `len/spread` .
- 
- Condition: ( spread > 0 )
+ Record the list of Fibers, and the cumulated lengths needed by uniFiberSite().
+ This must be called again if any Fiber is created, deleted or changes length.
  */
-void FiberSet::uniFiberSites(Array<FiberBinder>& res, const real spread) const
+void FiberSet::uniPrepare()
 {
-    assert_true( spread > 0 );
+    uniFibers.clear();
+    uniLengths.clear();
     
-    res.clear();
-    Fiber * fib = first();
-    real abs = spread * RNG.exponential();
-    while ( fib )
+    real sum = 0;
+    for ( Fiber * fib = first(); fib; fib = fib->next() )
     {
-        while ( abs < fib->length() )
+        uniFibers.push_back(fib);
+        uniLengths.push_back(sum);
+        sum += fib->length();
+    }
+    uniLengths.push_back(sum);
+}
+
+
+/**
+ Return a site chosen randomly with uniform sampling along all the Fibers,
+ by bisection in the cumulated lengths recorded by uniPrepare().
+ 
+ A Fiber may have been shortened since uniPrepare(), for example by a Cutter,
+ in which case a site beyond its current end is drawn again.
+ 
+ Condition: ( uniLength() > 0 )
+ */
+FiberBinder FiberSet::uniFiberSite() const
+{
+    assert_true( uniLength() > 0 );
+    
+    Fiber * fib;
+    real a;
+    do {
+        const real abs = RNG.preal() * uniLength();
+        
+        // find `i` such that uniLengths[i] <= abs < uniLengths[i+1]:
+        unsigned i = 0, j = uniFibers.size();
+        while ( i + 1 < j )
         {
-            res.push_back(FiberBinder(fib, abs+fib->abscissaM()));
-            abs += spread * RNG.exponential();
+            unsigned m = ( i + j ) / 2;
+            if ( uniLengths[m] <= abs )
+                i = m;
+            else
+                j = m;
         }
-        abs -= fib->length();
-        fib = fib->next();
-    }
+        
+        fib = uniFibers[i];
+        a = abs - uniLengths[i];
+    } while ( a > fib->length() );
+    
+    return FiberBinder(fib, a + fib->abscissaM());
 }
 
 
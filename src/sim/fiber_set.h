@@ -21,6 +21,12 @@ class FiberSet : public ObjectSet
 private:
     
     FiberSet();
+    
+    /// the Fibers recorded by uniPrepare()
+    Array<Fiber*> uniFibers;
+    
+    /// uniLengths[i] is the cumulated length of uniFibers[0] to uniFibers[i-1]
+    Array<real>   uniLengths;
 
 public:
     
@@ -73,8 +79,14 @@ public:
     /// modulo the position (periodic boundary conditions)
     void foldPosition(const Modulo *) const;
     
-    /// set random sites along the fibers, separated on average by `spread`
-    void uniFiberSites(Array<FiberBinder>&, const real spread) const;
+    /// record the Fibers and their cumulated lengths, for uniFiberSite()
+    void uniPrepare();
+    
+    /// total length of the Fibers recorded by uniPrepare()
+    real uniLength() const { return uniLengths.empty() ? 0 : uniLengths[uniFibers.size()]; }
+    
+    /// a random site, uniformly distributed along the Fibers recorded by uniPrepare()
+    FiberBinder uniFiberSite() const;
 
     //--------------------------------------------------------------------------
 
@@ -221,3 +221,17 @@ void ClassicFiber::read(InputWrapper & in, Simul& sim)
     Fiber::read(in, sim);
 }
 
+
+void ClassicFiber::writeState(OutputWrapper& out) const
+{
+    Fiber::writeState(out);
+    out.writeDouble(mGrowth);
+}
+
+
+void ClassicFiber::readState(InputWrapper& in)
+{
+    Fiber::readState(in);
+    mGrowth = in.readDouble();
+}
+
@@ -101,6 +101,12 @@ public:
     /// read from InputWrapper
     void        read(InputWrapper&, Simul&);
     
+    /// write the assembly during the last time-step, which is not saved by write()
+    void        writeState(OutputWrapper&) const;
+    
+    /// read the state written by writeState()
+    void        readState(InputWrapper&);
+    
 };
 
 
@@ -323,3 +323,27 @@ void DynamicFiber::read(InputWrapper & in, Simul& sim)
     Fiber::read(in, sim);
 }
 
+
+void DynamicFiber::writeState(OutputWrapper& out) const
+{
+    Fiber::writeState(out);
+    out.writeDouble(mGrowthP);
+    out.writeDouble(mGrowthM);
+    out.writeDouble(nextGrowthP);
+    out.writeDouble(nextHydrolP);
+    out.writeDouble(nextGrowthM);
+    out.writeDouble(nextHydrolM);
+}
+
+
+void DynamicFiber::readState(InputWrapper& in)
+{
+    Fiber::readState(in);
+    mGrowthP = in.readDouble();
+    mGrowthM = in.readDouble();
+    nextGrowthP = in.readDouble();
+    nextHydrolP = in.readDouble();
+    nextGrowthM = in.readDouble();
+    nextHydrolM = in.readDouble();
+}
+
@@ -137,6 +137,12 @@ public:
     /// read from InputWrapper
     void        read(InputWrapper&, Simul&);
     
+    /// write the Gillespie times and the last assembly, which are not saved by write()
+    void        writeState(OutputWrapper&) const;
+    
+    /// read the state written by writeState()
+    void        readState(InputWrapper&);
+    
 };
 
 
@@ -212,3 +212,19 @@ void TreadmillingFiber::read(InputWrapper & in, Simul& sim)
     Fiber::read(in, sim);
 }
 
+
+void TreadmillingFiber::writeState(OutputWrapper& out) const
+{
+    Fiber::writeState(out);
+    out.writeDouble(mGrowthP);
+    out.writeDouble(mGrowthM);
+}
+
+
+void TreadmillingFiber::readState(InputWrapper& in)
+{
+    Fiber::readState(in);
+    mGrowthP = in.readDouble();
+    mGrowthM = in.readDouble();
+}
+
@@ -6,6 +6,9 @@
 #include "fiber_set.h"
 #include "cblas.h"
 #include "sim.h"
+#include "thread_pool.h"
+#include "conjgrad.h"
+#include <algorithm>
 
 extern Random RNG;
 
@@ -19,13 +22,21 @@ void FieldBase<FieldScalar>::prepare()
     const unsigned int nbc = FieldGrid::nbCells();
     assert_true( nbc > 0 );
     
+    // build an array of offsets to right-side neighbor in each dimension
+    unsigned int off = 1;
+    for ( int d = 0; d < DIM; ++d )
+    {
+        fiOffset[d] = off;
+        off *= FieldGrid::nbCells(d);
+    }
+    
+    // the mirror is padded, such that the neighbors of all cells can be read:
+    fiPad = fiOffset[DIM-1];
+    
     if ( fiMirror )
         delete [] fiMirror;    
-    fiMirror = new FieldScalar[nbc];
-    fiMirrorSize = nbc;
-    
-    fiDiffusionMatrix.allocate(nbc);
-    fiDiffusionMatrix.makeZero();
+    fiMirrorSize = nbc + 2 * fiPad;
+    fiMirror = new FieldScalar[fiMirrorSize];
     
     // find out which cell is inside the space:
     Vector pos(0,0,0);
@@ -45,49 +56,171 @@ void FieldBase<FieldScalar>::prepare()
         inside[c] = ! spc->allOutside(pos, range);
     }
 #endif
-    // build an array of offsets to right-side neighbor in each dimension
-    unsigned int off = 1, offset[DIM];
-    for ( int d = 0; d < DIM; ++d )
-    {
-        offset[d] = off;
-        off *= FieldGrid::nbCells(d);
-    }
     
-    // build the matrix for diffusion,
-    // keeping only cells which are inside the space:
+    // link the neighboring cells which are both inside the space:
+    if ( fiLinks )
+        delete [] fiLinks;
+    fiLinks = new unsigned char[nbc];
+    
+    unsigned int nbl = 0;
     for ( unsigned int c = 0; c < nbc; ++c )
     {
+        unsigned char m = 0;
         if ( inside[c] )
         {
             for ( int d = 0; d < DIM; ++d )
             {
-                unsigned int oc = c + offset[d];
-                if ( oc < nbc  &&  inside[oc] )
+                // coordinate of the cell in dimension d:
+                unsigned int x = ( c / fiOffset[d] ) % FieldGrid::nbCells(d);
+                if ( x+1 < FieldGrid::nbCells(d)  &&  inside[c+fiOffset[d]] )
                 {
-                    fiDiffusionMatrix(c,  oc) += 1.0;
-                    fiDiffusionMatrix(c,  c ) -= 1.0;
-                    fiDiffusionMatrix(oc, oc) -= 1.0;
+                    m |= 1 << d;
+                    ++nbl;
                 }
+                if ( x > 0  &&  inside[c-fiOffset[d]] )
+                    m |= 1 << ( DIM + d );
             }
         }
+        fiLinks[c] = m;
     }
     delete[] inside;
-    if ( 0 && nbc < 100 ) {
-        std::cerr << std::endl;
-        fiDiffusionMatrix.printFull(std::cerr);
-    }
-    fiDiffusionMatrix.prepareForMultiply();
     
     std::cerr << "Field::prepare() diffusion using ";
-    std::cerr << fiDiffusionMatrix.nbNonZeroElements() << " matrix elements" << std::endl;
+    std::cerr << nbl << " links between cells" << std::endl;
+}
+
+
+/**
+ This calculates, for the cells in [start, stop[:
+ @code
+ dst = decay * src + theta * Laplacian(src)
+ @endcode
+ where the Laplacian only involves the pairs of neighboring cells that are linked.
+ The cells are independent, and different ranges can be processed concurrently.
+ The loop does not branch, and all neighbors can be read since `src` is padded
+ by `fiPad` cells on each side, like fiMirror.
+ */
+template < >
+void FieldBase<FieldScalar>::diffuse(const real* src, real* dst, const real theta, const real decay,
+                                     const unsigned start, const unsigned stop) const
+{
+    const unsigned char * links = fiLinks;
+    
+    for ( unsigned c = start; c < stop; ++c )
+    {
+        const real * ptr = src + c;
+        const real val = *ptr;
+        const unsigned m = links[c];
+        real sum = 0;
+        for ( int d = 0; d < DIM; ++d )
+        {
+            const unsigned o = fiOffset[d];
+            sum += (real)( ( m >> d ) & 1 ) * ( *(ptr+o) - val );
+            sum += (real)( ( m >> ( DIM + d ) ) & 1 ) * ( *(ptr-o) - val );
+        }
+        dst[c] = decay * val + theta * sum;
+    }
+}
+
+
+/// arguments passed to diffusionJob()
+struct DiffusionArg
+{
+    Field const* field;
+    const real * src;
+    real       * dst;
+    real         theta;
+    real         decay;
+};
+
+
+/// entry point for the threads executing Field::diffuse(), each on a range of cells
+static void diffusionJob(void* arg, unsigned rank, unsigned size)
+{
+    DiffusionArg const* dif = static_cast<DiffusionArg*>(arg);
+    const unsigned nbc = dif->field->nbCells();
+    const unsigned chunk = ( nbc + size - 1 ) / size;
+    const unsigned start = std::min(nbc, rank * chunk);
+    const unsigned stop = std::min(nbc, start + chunk);
+    dif->field->diffuse(dif->src, dif->dst, dif->theta, dif->decay, start, stop);
+}
+
+
+template < >
+void FieldBase<FieldScalar>::diffuse(const real* src, real* dst, const real theta, const real decay,
+                                     ThreadPool& pool) const
+{
+    if ( pool.size() > 1 )
+    {
+        DiffusionArg arg = { this, src, dst, theta, decay };
+        pool.run(diffusionJob, &arg);
+    }
+    else
+        diffuse(src, dst, theta, decay, 0, FieldGrid::nbCells());
 }
 
 
+/// the linear system solved by the implicit methods of diffusion
 /**
- //\todo implement Crank-Nicholson for diffusion
+ The matrix is `A = I - theta * Laplacian`, which is symmetric and positive definite,
+ and the preconditionner is the inverse of its diagonal.
+ The vectors are copied to `buf` before multiplication, since the stencil needs padding.
+ */
+class FieldDiffusionSystem
+{
+    Field const& field;
+    real       * buf;
+    real         theta;
+    ThreadPool & pool;
+    
+    /// inverse of the diagonal element, for each possible value of the links of a cell
+    real         inv[1<<(2*DIM)];
+    
+public:
+    
+    FieldDiffusionSystem(Field const& f, real* b, real t, ThreadPool& p) : field(f), buf(b), theta(t), pool(p)
+    {
+        for ( unsigned m = 0; m < ( 1 << (2*DIM) ); ++m )
+        {
+            unsigned n = 0;
+            for ( unsigned k = m; k; k >>= 1 )
+                n += k & 1;
+            inv[m] = 1.0 / ( 1.0 + theta * n );
+        }
+    }
+    
+    unsigned int size() const { return field.nbCells(); }
+    
+    void multiply(const real* X, real* Y) const
+    {
+        blas_xcopy(size(), X, 1, buf, 1);
+        field.diffuse(buf, Y, -theta, 1.0, pool);
+    }
+    
+    void precondition(const real* X, real* Y) const
+    {
+        const unsigned char * links = field.links();
+        for ( unsigned c = 0; c < size(); ++c )
+            Y[c] = X[c] * inv[links[c]];
+    }
+};
+
+
+/**
+ The diffusion is done in `field:diffusion_steps` steps, and the decay is applied in the first one.
+ With the explicit method, each step is:
+ @code
+ field = decay * field + theta * Laplacian(field)
+ @endcode
+ The implicit methods solve with the Conjugate Gradient method:
+ @code
+ implicit:        ( I - theta * Laplacian ) new_field = decay * field
+ crank_nicolson:  ( I - theta/2 * Laplacian ) new_field = decay * field + theta/2 * Laplacian(field)
+ @endcode
+ using the current field as initial guess.
  */
 template < >
-void FieldBase<FieldScalar>::step(FiberSet&, real time_step)
+void FieldBase<FieldScalar>::step(FiberSet&, real time_step, ThreadPool& pool)
 {
     assert_true( prop );
     
@@ -97,27 +230,63 @@ void FieldBase<FieldScalar>::step(FiberSet&, real time_step)
     
     if ( prop->diffusion > 0 )
     {
-        assert_true( fiMirror );
-        assert_true( fiMirrorSize == FieldGrid::nbCells() );
-        real * dfield = (real*)( fiMirror );
-        
-        // dfield = field * prop->diffusion_theta:
-        blas_xcopy(FieldGrid::nbCells(), field, 1, dfield, 1);
-        blas_xscal(FieldGrid::nbCells(), prop->diffusion_theta, dfield, 1);
+        const unsigned nbc = FieldGrid::nbCells();
+        assert_true( fiMirror && fiLinks );
+        assert_true( fiMirrorSize == nbc + 2 * fiPad );
+        real * mirror = (real*)( fiMirror ) + fiPad;
         
+        // field = field * ( 1 - decay_rate * dt ):
+        real decay = 1.0 - prop->decay_rate_dt;
         
-        // decay:
-        if ( prop->decay_rate > 0 )
+        if ( prop->diffusion_method == FieldProp::DIFFUSION_EXPLICIT )
         {
-            // field = field * ( 1 - decay_rate * dt ):
-            blas_xscal(FieldGrid::nbCells(), 1.0 - prop->decay_rate_dt, field, 1);
+            for ( unsigned s = 0; s < prop->diffusion_steps; ++s )
+            {
+                blas_xcopy(nbc, field, 1, mirror, 1);
+                diffuse(mirror, field, prop->diffusion_theta, decay, pool);
+                decay = 1.0;
+            }
+            return;
         }
         
-        // diffusion
-        assert_true( fiDiffusionMatrix.size() == FieldGrid::nbCells() );
+        static Solver::Allocator allocator, workspace;
+        workspace.allocate(nbc, 1);
+        real * rhs = workspace.bind(0);
+        
+        real theta = prop->diffusion_theta;
+        if ( prop->diffusion_method == FieldProp::DIFFUSION_CRANK_NICOLSON )
+            theta *= 0.5;
+        
+        FieldDiffusionSystem system(*this, mirror, theta, pool);
         
-        // field = field + fiDiffusionMatrix * dfield:
-        fiDiffusionMatrix.vecMulAdd(dfield, field);
+        for ( unsigned s = 0; s < prop->diffusion_steps; ++s )
+        {
+            if ( prop->diffusion_method == FieldProp::DIFFUSION_CRANK_NICOLSON )
+            {
+                blas_xcopy(nbc, field, 1, mirror, 1);
+                diffuse(mirror, rhs, theta, decay, pool);
+            }
+            else
+            {
+                blas_xcopy(nbc, field, 1, rhs, 1);
+                blas_xscal(nbc, decay, rhs, 1);
+            }
+            decay = 1.0;
+            
+            const real norm = blas_xnrm8(nbc, rhs);
+            if ( norm <= 0 )
+            {
+                blas_xcopy(nbc, rhs, 1, field, 1);
+                continue;
+            }
+            
+            // Conjugate Gradient converges in at most `nbc` iterations with exact arithmetic:
+            Solver::Monitor monitor(nbc, prop->diffusion_tolerance * norm);
+            Solver::PCG(system, rhs, field, monitor, allocator);
+            
+            if ( !monitor.converged() )
+                Cytosim::warning("Field diffusion did not converge: flag %i, nb_iter %i, residual %.2e\n",
+                                 monitor.flag(), monitor.iterations(), monitor.residual());
+        }
     }
 }
-
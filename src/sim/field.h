@@ -8,11 +8,19 @@
 typedef FieldBase<FieldScalar> Field;
 
 
-/// initialize diffusion matrix (only for FieldScalar)
+/// initialize diffusion stencil (only for FieldScalar)
 template < > 
 void FieldBase<FieldScalar>::prepare();
 
+/// diffusion kernel
+template < > 
+void FieldBase<FieldScalar>::diffuse(const real*, real*, real, real, unsigned, unsigned) const;
+
+/// diffusion kernel, distributed over threads
+template < > 
+void FieldBase<FieldScalar>::diffuse(const real*, real*, real, real, ThreadPool&) const;
+
 /// diffusion step
 template < > 
-void FieldBase<FieldScalar>::step(FiberSet&, real);
+void FieldBase<FieldScalar>::step(FiberSet&, real, ThreadPool&);
 
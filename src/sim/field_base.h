@@ -11,9 +11,9 @@
 #include "iowrapper.h"
 #include "messages.h"
 #include "exceptions.h"
-#include "matsparsesym1.h"
 #include "field_prop.h"
 class FiberSet;
+class ThreadPool;
 
 #ifdef DISPLAY
    #include "gle.h"
@@ -47,14 +47,20 @@ private:
     /// disabled default constructor
     FieldBase();
 
-    /// duplicate field
+    /// duplicate field, with `fiPad` cells on each side
     VAL*     fiMirror;
     
     /// allocated size of fiMirror
     unsigned fiMirrorSize;
     
-    /// matrix for diffusion
-    MatrixSparseSymmetric1 fiDiffusionMatrix;
+    /// number of cells added on each side of fiMirror
+    unsigned fiPad;
+    
+    /// offset between a cell and the next cell in each dimension
+    unsigned fiOffset[DIM];
+    
+    /// for each cell, bit `d` is set if diffusion occurs with the next cell in dimension `d`, and bit `DIM+d` with the previous cell
+    unsigned char * fiLinks;
     
     
     /// initialize the field
@@ -108,6 +114,8 @@ public:
         prop=p;
         fiMirror=0;
         fiMirrorSize=0;
+        fiPad=0;
+        fiLinks=0;
     }
     
     /// destructor
@@ -115,6 +123,8 @@ public:
     {
         if ( fiMirror )
             delete[] fiMirror;
+        if ( fiLinks )
+            delete[] fiLinks;
     }
     
     /// initialize with squares of size 'step'
@@ -155,11 +165,20 @@ public:
     real sumValues() { return FieldGrid::sumValues(); }
     
     /// simulation step 
-    void step(FiberSet&, real) {}
+    void step(FiberSet&, real, ThreadPool&) {}
     
-    /// initialize diffusion matrix (only for FieldScalar)
+    /// initialize diffusion stencil (only for FieldScalar)
     void prepare() {}
     
+    /// dst = decay * src + theta * Laplacian(src) for the cells in [start, stop[, where `src` must be padded like fiMirror
+    void diffuse(const real* src, real* dst, real theta, real decay, unsigned start, unsigned stop) const;
+    
+    /// dst = decay * src + theta * Laplacian(src) for all cells, using the threads of `pool`
+    void diffuse(const real* src, real* dst, real theta, real decay, ThreadPool& pool) const;
+    
+    /// bit fields indicating for each cell with which neighbors diffusion occurs
+    const unsigned char * links() const { return fiLinks; }
+    
     //------------------------------ read/write --------------------------------
     #pragma mark -
 
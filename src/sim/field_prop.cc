@@ -13,6 +13,9 @@ void FieldProp::clear()
     confine_space         = "first";
     confine_space_ptr     = 0;
     diffusion             = 0;
+    diffusion_method      = DIFFUSION_EXPLICIT;
+    diffusion_steps       = 1;
+    diffusion_tolerance   = 1e-6;
     diffusion_theta       = 0;
     decay_rate            = 0;
     decay_rate_dt         = 0;
@@ -27,6 +30,12 @@ void FieldProp::read(Glossary& glos)
     glos.set(step,               "step");
     glos.set(confine_space,      "space");
     glos.set(diffusion,          "diffusion");
+    glos.set(diffusion_method,   "diffusion_method",
+             KeyList<int>("explicit",       DIFFUSION_EXPLICIT,
+                          "implicit",       DIFFUSION_IMPLICIT,
+                          "crank_nicolson", DIFFUSION_CRANK_NICOLSON));
+    glos.set(diffusion_steps,    "diffusion_steps");
+    glos.set(diffusion_tolerance, "diffusion_tolerance");
     glos.set(decay_rate,         "decay_rate");
 
     glos.set(positive,           "positive");
@@ -45,13 +54,19 @@ void FieldProp::complete(SimulProp const* sp, PropertyList*)
     if ( diffusion < 0 )
         throw InvalidParameter("field:diffusion must be >= 0");
     
-    diffusion_theta = sp->time_step * diffusion / ( step * step );
+    if ( diffusion_steps < 1 )
+        throw InvalidParameter("field:diffusion_steps must be >= 1");
     
-    if ( diffusion_theta * 2 * DIM > sp->acceptable_rate )
+    if ( diffusion_tolerance <= 0 )
+        throw InvalidParameter("field:diffusion_tolerance must be > 0");
+    
+    diffusion_theta = sp->time_step * diffusion / ( diffusion_steps * step * step );
+    
+    if ( diffusion_method == DIFFUSION_EXPLICIT  &&  diffusion_theta * 2 * DIM > sp->acceptable_rate )
     {
         std::cerr << "field:diffusion CFL condition = " << diffusion_theta * 2 * DIM << std::endl;
         std::cerr << "This number must be below 1/2." << std::endl;
-        throw InvalidParameter("field:diffusion (diffusion*time_step/step^2) is too high");
+        throw InvalidParameter("field:diffusion (diffusion*time_step/(diffusion_steps*step^2)) is too high: use more diffusion_steps or diffusion_method=implicit");
     }
 
     if ( decay_rate < 0 )
@@ -71,6 +86,9 @@ void FieldProp::write_data(std::ostream & os) const
     write_param(os, "step",        step);
     write_param(os, "space",       confine_space);
     write_param(os, "diffusion",   diffusion);
+    write_param(os, "diffusion_method", diffusion_method);
+    write_param(os, "diffusion_steps", diffusion_steps);
+    write_param(os, "diffusion_tolerance", diffusion_tolerance);
     write_param(os, "decay_rate",  decay_rate);
     write_param(os, "positive",    positive);
     write_param(os, "save",        save);
@@ -35,6 +35,38 @@ public:
     /// diffusion constant
     real          diffusion;
     
+    /// methods that can be used to integrate diffusion
+    enum DiffusionMethod
+    {
+        DIFFUSION_EXPLICIT,         ///< forward Euler
+        DIFFUSION_IMPLICIT,         ///< backward Euler
+        DIFFUSION_CRANK_NICOLSON    ///< trapezoidal rule
+    };
+    
+    /// method used to integrate diffusion
+    /**
+     The accepted values are:
+     - `explicit` : forward Euler, which is only stable for small time steps
+     - `implicit` : backward Euler, which is unconditionally stable and keeps the field positive
+     - `crank_nicolson` : second order in time, unconditionally stable, 
+        but may oscillate if `diffusion * time_step / step^2` is large
+     .
+     The implicit methods solve a linear system with the Conjugate Gradient method.
+     
+     <em>default value = explicit</em>
+     */
+    int           diffusion_method;
+    
+    /// number of diffusion steps done at each time step (default = 1)
+    /**
+     The explicit diffusion is stable if `diffusion * time_step / ( diffusion_steps * step^2 )`
+     is small enough, and increasing `diffusion_steps` allows a smaller `step`.
+     */
+    unsigned      diffusion_steps;
+    
+    /// relative precision of the solution, for the implicit methods (default = 1e-6)
+    real          diffusion_tolerance;
+    
     /// decay rate per unit time
     real          decay_rate;
     
@@ -25,7 +25,7 @@ void FieldSet::step()
         if ( f->hasField() )
         {
             MSG_ONCE("!!!! Field is active\n");
-            f->step(simul.fibers, simul.prop->time_step);
+            f->step(simul.fibers, simul.prop->time_step, simul.threadPool());
         }
     }
 }
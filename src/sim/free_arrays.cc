@@ -0,0 +1,119 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "free_arrays.h"
+#include "assert_macro.h"
+#include "random.h"
+#include "space.h"
+
+
+void FreeArrays::clearClasses()
+{
+    for ( unsigned k = 0; k < classes.size(); ++k )
+        classes[k].used = false;
+}
+
+
+void FreeArrays::setClass(const unsigned k, Class const& c)
+{
+    if ( k >= classes.size() )
+    {
+        unsigned n = classes.size();
+        classes.resize(k+1);
+        for ( ; n < k; ++n )
+            classes[n].used = false;
+    }
+    classes[k] = c;
+}
+
+
+void FreeArrays::add(Object * obj, Vector const& p, const unsigned k, const real t[])
+{
+    assert_true( accepts(k) );
+    objs.push_back(obj);
+    pos.push_back(p);
+    cls.push_back(k);
+    for ( unsigned h = 0; h < nbHands; ++h )
+        times.push_back(t[h]);
+}
+
+
+void FreeArrays::remove(const unsigned i)
+{
+    const unsigned last = objs.size() - 1;
+    assert_true( i <= last );
+
+    if ( i < last )
+    {
+        objs[i] = objs[last];
+        pos[i]  = pos[last];
+        cls[i]  = cls[last];
+        for ( unsigned h = 0; h < nbHands; ++h )
+            times[nbHands*i+h] = times[nbHands*last+h];
+    }
+
+    objs.truncate(last);
+    pos.truncate(last);
+    cls.truncate(last);
+    times.truncate(nbHands*last);
+}
+
+
+void FreeArrays::clear()
+{
+    objs.clear();
+    pos.clear();
+    cls.clear();
+    times.clear();
+}
+
+
+/**
+ This is equivalent to Couple::diffuse() and Single::diffuse(),
+ using the parameters of the class of each object.
+ */
+void FreeArrays::diffuse(Random& rng)
+{
+    const unsigned cnt = objs.size();
+    Vector * ptr = pos.addr();
+
+    for ( unsigned i = 0; i < cnt; ++i )
+    {
+        Class const& c = classes[cls[i]];
+        ptr[i].addRand(c.diffusion_dt, rng);
+
+        if ( c.confine == CONFINE_INSIDE )
+        {
+            if ( ! c.space->inside(ptr[i]) )
+                c.space->bounce(ptr[i]);
+        }
+        else if ( c.confine == CONFINE_SURFACE )
+            c.space->project(ptr[i]);
+    }
+}
+
+
+/**
+ This is equivalent to the countdown done by Hand::stepFree().
+ The times that became negative are not reset, and the caller should
+ draw new times for them, as well as trying to attach the Hands.
+ */
+void FreeArrays::countdown(Array<unsigned>& fired)
+{
+    fired.clear();
+
+    const unsigned cnt = objs.size();
+    real * ptr = times.addr();
+
+    for ( unsigned i = 0; i < cnt; ++i )
+    {
+        Class const& c = classes[cls[i]];
+        for ( unsigned h = 0; h < nbHands; ++h )
+        {
+            real & t = ptr[nbHands*i+h];
+            t -= c.rate_dt[h];
+            if ( t <= 0 )
+                fired.push_back(nbHands*i+h);
+        }
+    }
+}
+
@@ -0,0 +1,112 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef FREE_ARRAYS_H
+#define FREE_ARRAYS_H
+
+#include "real.h"
+#include "vector.h"
+#include "array.h"
+#include "common.h"
+
+class Object;
+class Space;
+class Random;
+
+
+/// Position and attachment times of free diffusing objects, stored in contiguous arrays
+/**
+ FreeArrays holds the state of free Couples or Singles that only diffuse and wait
+ for their Hands to bind: the position, the index of the class (the Property index),
+ and the Gillespie normalized times of the Hands, Hand::attachTime().
+ Diffusion, confinement and the countdown of the times are done by loops over the
+ arrays, without accessing the objects, which are scattered in memory.
+ The objects are only accessed when the time of a Hand becomes negative,
+ as reported by countdown(), or when their state is copied back.
+
+ Each object has `nbHands` times, that are stored contiguously.
+ The parameters of each class are set by setClass(), and only the objects
+ of the classes that were set can be added.
+
+ This is used by CoupleSet and SingleSet if simul:free_arrays is true.
+ */
+class FreeArrays
+{
+public:
+
+    /// parameters shared by the objects of one class
+    struct Class
+    {
+        bool         used;          ///< true if objects of this class can be added
+        real         diffusion_dt;  ///< displacement in one time step
+        Confinement  confine;       ///< confinement mode
+        Space const* space;         ///< confining Space
+        real         rate_dt[2];    ///< HandProp::binding_rate_dt of each Hand
+    };
+
+private:
+
+    /// number of Hands of each object
+    unsigned         nbHands;
+
+    /// the objects
+    Array<Object*>   objs;
+
+    /// position of each object
+    Array<Vector>    pos;
+
+    /// class of each object
+    Array<unsigned>  cls;
+
+    /// times of the Hands, with `nbHands` values for each object
+    Array<real>      times;
+
+    /// parameters of the classes
+    Array<Class>     classes;
+
+    /// disabled default constructor
+    FreeArrays();
+
+public:
+
+    /// constructor for objects with `n` Hands (1 or 2)
+    FreeArrays(unsigned n) : nbHands(n) {}
+
+    /// number of objects
+    unsigned size()                          const { return objs.size(); }
+
+    /// object `i`
+    Object * object(unsigned i)              const { return objs[i]; }
+
+    /// position of object `i`
+    Vector const& position(unsigned i)       const { return pos[i]; }
+
+    /// time of Hand `h` of object `i`
+    real&    time(unsigned i, unsigned h)          { return times[nbHands*i+h]; }
+
+    /// forbid all classes
+    void     clearClasses();
+
+    /// set the parameters of class `k`
+    void     setClass(unsigned k, Class const&);
+
+    /// true if objects of class `k` can be added
+    bool     accepts(unsigned k)             const { return k < classes.size() && classes[k].used; }
+
+    /// add object of class `k` at position `p`, with the `nbHands` times given in `t`
+    void     add(Object *, Vector const& p, unsigned k, const real t[]);
+
+    /// remove object `i`, which is replaced by the last object
+    void     remove(unsigned i);
+
+    /// remove all objects
+    void     clear();
+
+    /// move all objects randomly and apply the confinement
+    void     diffuse(Random&);
+
+    /// decrease all times, and record `nbHands*i+h` for each time that became negative
+    void     countdown(Array<unsigned>& fired);
+};
+
+#endif
+
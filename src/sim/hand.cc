@@ -6,6 +6,7 @@
 #include "exceptions.h"
 #include "iowrapper.h"
 #include "fiber_prop.h"
+#include "attachment_sweep.h"
 #include "simul.h"
 #include "sim.h"
 extern Random RNG;
@@ -227,6 +228,25 @@ void Hand::stepFree(const FiberGrid& grid, Vector const & pos)
 }
 
 
+/**
+ This is called from several threads simultaneously by AttachmentSweep.
+ The sites within reach are recorded, and the Hand is attached later.
+ */
+void Hand::sweepFree(AttachmentBuffer& buf, Vector const & pos)
+{
+    assert_true( !attached() );
+    assert_true( nextAttach >= 0 );
+    
+    nextAttach -= prop->binding_rate_dt;
+    
+    if ( nextAttach <= 0 )
+    {
+        nextAttach = buf.rng.exponential();
+        buf.search(this, pos);
+    }
+}
+
+
 //------------------------------------------------------------------------------
 /**
  Test for spontaneous detachment at rate HandProp::unbinding_rate, 
@@ -275,3 +295,17 @@ void Hand::read(InputWrapper & in, Simul& sim)
     
     FiberBinder::read(in, sim);
 }
+
+
+void Hand::writeState(OutputWrapper& out) const
+{
+    out.writeDouble(nextAttach);
+    out.writeDouble(nextDetach);
+}
+
+
+void Hand::readState(InputWrapper& in)
+{
+    nextAttach = in.readDouble();
+    nextDetach = in.readDouble();
+}
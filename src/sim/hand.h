@@ -7,6 +7,7 @@
 
 class HandMonitor;
 class FiberGrid;
+class AttachmentBuffer;
 class FiberProp;
 class HandProp;
 class Simul;
@@ -86,8 +87,17 @@ public:
     /// detach
     virtual void   detach();
     
+    /// Gillespie normalized time for attachment
+    real           attachTime() const { return nextAttach; }
+    
+    /// set the Gillespie normalized time for attachment
+    void           attachTime(real t) { nextAttach = t; }
+    
     /// simulate when the Hand is not attached
     virtual void   stepFree(const FiberGrid&, Vector const & pos);
+    
+    /// equivalent of stepFree() that records the binding attempt in the buffer, without attaching
+    virtual void   sweepFree(AttachmentBuffer&, Vector const & pos);
 
     /// simulate when the Hand is attached but not under load
     virtual void   stepUnloaded();
@@ -111,6 +121,12 @@ public:
     /// write
     void           write(OutputWrapper&) const;
     
+    /// write the Gillespie times, which are not saved by write()
+    virtual void   writeState(OutputWrapper&) const;
+    
+    /// read the Gillespie times written by writeState()
+    virtual void   readState(InputWrapper&);
+    
 };
 
 #endif
@@ -245,6 +245,22 @@ void HandProp::checkStiffness(real stiff, real len, real mul, real kT) const
     }
 }
 
+
+/**
+ Estimate attachment propensity per unit length of fiber,
+ as used by couple:fast_diffusion and single:fast_diffusion
+ */
+real HandProp::attachDensity() const
+{
+    real density = binding_rate_dt;
+#if ( DIM == 2 )
+    density *= 2 * binding_range;
+#elif ( DIM == 3 )
+    density *= M_PI * binding_range * binding_range;
+#endif
+    return density;
+}
+
 //------------------------------------------------------------------------------
 
 void HandProp::write_data(std::ostream & os) const
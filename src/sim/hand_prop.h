@@ -202,6 +202,9 @@ public:
     /// perform more checks, knowing the elasticity
     virtual void checkStiffness(real stiff, real len, real mul, real kT) const;
     
+    /// attachment propensity per unit length of fiber, for a unit concentration of Hands
+    real attachDensity() const;
+    
     /// write all values
     void write_data(std::ostream &) const;
     
@@ -8,6 +8,7 @@
 #include "fiber_prop.h"
 #include "fiber_set.h"
 #include "hand_monitor.h"
+#include "attachment_sweep.h"
 #include "simul.h"
 
 extern Random RNG;
@@ -153,6 +154,11 @@ void Nucleator::stepFree(const FiberGrid&, Vector const & pos)
 }
 
 
+void Nucleator::sweepFree(AttachmentBuffer& buf, Vector const & pos)
+{
+    buf.defer(this, pos);
+}
+
 
 void Nucleator::stepUnloaded()
 {
@@ -232,4 +238,16 @@ void Nucleator::detach()
 }
 
 
+void Nucleator::writeState(OutputWrapper& out) const
+{
+    Hand::writeState(out);
+    out.writeDouble(gspTime);
+}
+
+
+void Nucleator::readState(InputWrapper& in)
+{
+    Hand::readState(in);
+    gspTime = in.readDouble();
+}
 
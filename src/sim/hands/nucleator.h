@@ -54,6 +54,9 @@ public:
     
     /// simulate when is not attached
     void   stepFree(const FiberGrid&, Vector const & pos);
+    
+    /// defer the call to stepFree(), since nucleate() cannot be called in parallel
+    void   sweepFree(AttachmentBuffer&, Vector const & pos);
 
     /// simulate when \a this is attached but not under load
     void   stepUnloaded();
@@ -63,6 +66,12 @@ public:
     
     /// detach from Fiber
     void   detach();
+    
+    /// write the Gillespie times
+    void   writeState(OutputWrapper&) const;
+    
+    /// read the Gillespie times
+    void   readState(InputWrapper&);
 
 };
 
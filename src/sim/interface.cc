@@ -6,7 +6,11 @@
 #include "glossary.h"
 #include "filepath.h"
 #include "tictoc.h"
+#include "frame_index.h"
 #include <fstream>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
 
 extern Random RNG;
 
@@ -15,7 +19,7 @@ extern Random RNG;
 //------------------------------------------------------------------------------
 
 Interface::Interface(Simul& s)
-: simul(s)
+: simul(s), resuming(false)
 {
 }
 
@@ -46,6 +50,7 @@ Property* Interface::execute_set(std::string const& kind, std::string const& nam
     
     p->read(def);
     p->complete(simul.prop, &simul.properties);
+    simul.properties.modified();
     
     return p;
 }
@@ -55,6 +60,7 @@ void Interface::execute_change(Property * p, Glossary& def)
 {
     p->read(def);
     p->complete(simul.prop, &simul.properties);
+    simul.properties.modified();
     
     if ( p->kind() == "space" )
     {
@@ -123,6 +129,7 @@ void Interface::change_display(std::string const& kind, std::string const& name,
         if ( p )
             p->read(opt);
     }
+    simul.properties.modified();
 }
 
 
@@ -421,12 +428,32 @@ void reportCPUtime(int frame, real stime)
 }
 
 
+/// append the Profile of `sim` to the file specified by simul:profile_file
+static void writeProfile(Simul const& sim, int frame)
+{
+    FILE * file = fopen(sim.prop->profile_file.c_str(), "a");
+    if ( file )
+    {
+        fseek(file, 0, SEEK_END);
+        if ( ftell(file) == 0 )
+            sim.profile().writeHeader(file);
+        sim.writeProfile(file, frame);
+        fclose(file);
+    }
+}
+
+
 void Interface::execute_run(Glossary& opt, unsigned nb_steps, bool do_write)
 {
     unsigned int nb_frames  = 0;
     int          solve      = 1;
     bool         prune      = true;
-    bool         binary     = true;
+    int          binary     = 1;
+    real         precision  = 0.0001;
+    bool         async      = false;
+    unsigned     keyframe   = 0;
+    unsigned     checkpoint = 0;
+    std::string  checkpoint_file = "checkpoint.cmc";
     real         event_rate = 0;
     std::string  event_code;
     
@@ -436,6 +463,16 @@ void Interface::execute_run(Glossary& opt, unsigned nb_steps, bool do_write)
     opt.set(solve,      "solve", KeyList<int>("off", 0, "on", 1, "horizontal", 2, "flux", 3));
     opt.set(prune,      "prune");
     opt.set(binary,     "binary");
+    opt.set(precision,  "precision");
+    opt.set(async,      "async");
+    opt.set(keyframe,   "keyframe");
+    opt.set(checkpoint, "checkpoint");
+    opt.set(checkpoint_file, "checkpoint", 1);
+    
+    // with `binary = 2`, the coordinates are compressed:
+    real quantum = ( binary > 1 ? precision : 0 );
+    if ( binary > 1 && precision <= 0 )
+        throw InvalidParameter("run:precision must be > 0");
     
     int           frame = 1;
     real          delta = nb_steps;
@@ -457,26 +494,64 @@ void Interface::execute_run(Glossary& opt, unsigned nb_steps, bool do_write)
     simul.prop->strict = 1;
     simul.prepare();
     
+    // a new profile file is started with the trajectory:
+    Profile& profile = simul.profile();
+    profile.enable(simul.prop->profile);
+    profile.clear();
+    if ( do_write  &&  simul.prop->profile  &&  !simul.prop->append_file )
+        remove(simul.prop->profile_file.c_str());
+    
     // Gillespie time at which next event will occur:
-    real etime = RNG.exponential();
+    real etime = 0;
     // decrement of Gillespie time for one time-step
     real event_rate_dt = event_rate * simul.prop->time_step;
     
     unsigned int n = 0;
+    
+    if ( resuming )
+    {
+        // continue the run that was saved in the checkpoint:
+        if ( resume.nb_steps != nb_steps  ||  resume.nb_frames != nb_frames )
+            throw InvalidParameter("the checkpoint was written by a different `run' command");
+        resuming = false;
+        n     = resume.step;
+        frame = resume.frame;
+        etime = resume.etime;
+        if ( nb_frames > 0 )
+            stop = (int)( frame * delta );
+    }
+    else
+        etime = RNG.exponential();
+    
     while ( 1 )
     {
         if ( n >= stop )
         {
             if ( do_write  &&  nb_frames > 0 )
             {
+                profile.tic();
                 simul.relax();
-                simul.writeObjects(simul.prop->trajectory_file, binary, simul.prop->append_file);
+                if ( async )
+                    simul.writeObjectsAsync(simul.prop->trajectory_file, binary, simul.prop->append_file, quantum, keyframe);
+                else
+                    simul.writeObjects(simul.prop->trajectory_file, binary, simul.prop->append_file, quantum, keyframe);
                 simul.prop->append_file = true;
+                profile.toc(Profile::WRITE);
                 reportCPUtime(frame, simul.simTime());
+                if ( profile.enabled() )
+                    writeProfile(simul, frame);
             }
             if ( n >= nb_steps )
                 break;
             stop = (int)( ++frame * delta );
+            
+            if ( do_write  &&  checkpoint > 0  &&  ( frame - 1 ) % checkpoint == 0 )
+            {
+                profile.tic();
+                RunProgress run = { nb_steps, nb_frames, n, (uint32_t)frame, etime };
+                writeCheckpoint(checkpoint_file, &run);
+                profile.toc(Profile::WRITE);
+            }
         }
         
         simul.step();
@@ -501,7 +576,12 @@ void Interface::execute_run(Glossary& opt, unsigned nb_steps, bool do_write)
         ++n;
     }
     
+    // the trajectory should be complete when the run terminates:
+    if ( async )
+        simul.flushObjects();
+    
     simul.relax();
+    profile.enable(false);
     
 #if ( VERBOSE_INTERFACE > 1 )
     std::cerr << "-RUN COMPLETED"<<std::endl;
@@ -584,10 +664,15 @@ void Interface::execute_import(std::string const& file, Glossary& opt)
 void Interface::execute_export(std::string& file, std::string const& what, Glossary& opt)
 {
     bool append = true;
-    bool binary = true;
+    int binary = 1;
+    real precision = 0.0001;
     
     opt.set(append, "append");
     opt.set(binary, "binary");
+    opt.set(precision, "precision");
+    
+    if ( binary > 1 && precision <= 0 )
+        throw InvalidParameter("export:precision must be > 0");
     
 #if ( VERBOSE_INTERFACE > 0 )
     std::clog << "-EXPORT " << what << " to " << file << std::endl;
@@ -599,7 +684,7 @@ void Interface::execute_export(std::string& file, std::string const& what, Gloss
         if ( file == "*" )
             file = simul.prop->trajectory_file;
         
-        simul.writeObjects(file, binary, append);
+        simul.writeObjects(file, binary, append, binary > 1 ? precision : 0);
     }
     else if ( what == "properties" )
     {
@@ -614,6 +699,154 @@ void Interface::execute_export(std::string& file, std::string const& what, Gloss
 }
 
 
+/// header of a checkpoint file, which is followed by the data of Simul::writeCheckpoint()
+struct CheckpointHeader
+{
+    char     magic[8];     ///< "cytockpt"
+    uint32_t endian;       ///< 0x01020304, to identify the byte order
+    uint32_t dim;          ///< dimensionality of the simulation
+    uint32_t real_size;    ///< sizeof(real)
+    uint32_t running;      ///< 1 if the checkpoint was written by `run`
+    Interface::RunProgress run;
+    uint64_t trajectory;   ///< size of the trajectory file
+    uint64_t index;        ///< size of the index of the trajectory file
+    uint32_t append;       ///< value of simul:append_file
+    uint32_t unused;
+};
+
+
+/// size of `file`, or zero if it does not exist
+static uint64_t fileSize(std::string const& file)
+{
+    struct stat st;
+    if ( 0 == stat(file.c_str(), &st) )
+        return st.st_size;
+    return 0;
+}
+
+
+/// remove the bytes of `file` that are beyond `size`
+static void truncateFile(std::string const& file, uint64_t size)
+{
+    if ( fileSize(file) > size  &&  truncate(file.c_str(), size) )
+        Cytosim::warning("could not truncate `%s'\n", file.c_str());
+}
+
+
+/**
+ The checkpoint is first written to a temporary file, which then replaces `file`,
+ such that a complete checkpoint remains available if the program is interrupted.
+ */
+void Interface::writeCheckpoint(std::string const& file, RunProgress const* run)
+{
+    // the trajectory should be complete, to record its size:
+    simul.flushObjects();
+    
+    CheckpointHeader head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, "cytockpt", 8);
+    head.endian     = 0x01020304;
+    head.dim        = DIM;
+    head.real_size  = sizeof(real);
+    if ( run )
+    {
+        head.running = 1;
+        head.run     = *run;
+    }
+    head.trajectory = fileSize(simul.prop->trajectory_file);
+    head.index      = fileSize(FrameIndex::path(simul.prop->trajectory_file));
+    head.append     = simul.prop->append_file;
+    
+    std::string tmp = file + ".tmp";
+    FILE * f = fopen(tmp.c_str(), "wb");
+    if ( !f )
+        throw InvalidIO("could not create file `"+tmp+"'");
+    
+    try {
+        if ( 1 != fwrite(&head, sizeof(head), 1, f) )
+            throw InvalidIO("could not write checkpoint");
+        simul.writeCheckpoint(f);
+    }
+    catch( Exception & ) {
+        fclose(f);
+        remove(tmp.c_str());
+        throw;
+    }
+    
+    if ( fclose(f)  ||  rename(tmp.c_str(), file.c_str()) )
+        throw InvalidIO("could not write checkpoint `"+file+"'");
+}
+
+
+/**
+ see Parser::parse_checkpoint
+ */
+void Interface::execute_checkpoint(std::string const& file, Glossary&)
+{
+#if ( VERBOSE_INTERFACE > 0 )
+    std::clog << "-CHECKPOINT to " << file << std::endl;
+#endif
+    writeCheckpoint(file, 0);
+}
+
+
+/**
+ see Parser::parse_restart
+ */
+void Interface::execute_restart(std::string const& file, Glossary& opt)
+{
+    bool required = true;
+    opt.set(required, "required");
+    
+    FILE * f = fopen(file.c_str(), "rb");
+    if ( !f )
+    {
+        if ( required )
+            throw InvalidIO("could not open checkpoint `"+file+"'");
+        return;
+    }
+    
+    // read the entire file at once:
+    std::vector<char> data;
+    size_t size = 0;
+    if ( 0 == fseeko(f, 0, SEEK_END) )
+    {
+        size = ftello(f);
+        data.resize(size+1);
+        rewind(f);
+        if ( size != fread(&data[0], 1, size, f) )
+            size = 0;
+    }
+    fclose(f);
+    
+    CheckpointHeader head;
+    if ( size < sizeof(head) )
+        throw InvalidIO("could not read checkpoint `"+file+"'");
+    memcpy(&head, &data[0], sizeof(head));
+    
+    if ( memcmp(head.magic, "cytockpt", 8) || head.endian != 0x01020304 )
+        throw InvalidIO("`"+file+"' is not a checkpoint written on this type of computer");
+    if ( head.dim != DIM  ||  head.real_size != sizeof(real) )
+        throw InvalidIO("`"+file+"' was written by a different executable");
+    
+#if ( VERBOSE_INTERFACE > 0 )
+    std::clog << "-RESTART from " << file << std::endl;
+#endif
+    
+    simul.readCheckpoint(&data[sizeof(head)], size-sizeof(head));
+    
+    resuming = head.running;
+    if ( resuming )
+    {
+        resume = head.run;
+        // discard the frames written after the checkpoint:
+        truncateFile(simul.prop->trajectory_file, head.trajectory);
+        truncateFile(FrameIndex::path(simul.prop->trajectory_file), head.index);
+        simul.prop->append_file = head.append;
+    }
+}
+
+
 /**
  see Parser::parse_report
  */
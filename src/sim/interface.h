@@ -20,11 +20,32 @@ private:
     /// disabled default constructor
     Interface();
 
+public:
+    
+    /// progress of a `run`, which is saved in checkpoints
+    struct RunProgress
+    {
+        uint32_t nb_steps;   ///< total number of steps of the `run`
+        uint32_t nb_frames;  ///< total number of frames of the `run`
+        uint32_t step;       ///< number of steps already performed
+        uint32_t frame;      ///< index of the next frame
+        double   etime;      ///< Gillespie time of the next event
+    };
+
 protected:
     
     /// associated Simul
     Simul& simul;
     
+    /// progress restored by `restart`, to be continued by the next `run`
+    RunProgress resume;
+    
+    /// true if `resume` should be used by the next `run`
+    bool        resuming;
+    
+    /// write a checkpoint, including the progress of the current `run` if `run != 0`
+    void        writeCheckpoint(std::string const& file, RunProgress const* run);
+    
 public:
     
     /// associates with given Simul
@@ -85,6 +106,12 @@ public:
     /// export objects from another file
     void       execute_export(std::string& file, std::string const& what, Glossary&);
     
+    /// save the complete state of the simulation to a file
+    void       execute_checkpoint(std::string const& file, Glossary&);
+    
+    /// restore the state saved by `checkpoint`
+    void       execute_restart(std::string const& file, Glossary&);
+    
     /// write output file with object coordinates or information on objects
     void       execute_report(std::string& file, std::string const& what, Glossary&);
     
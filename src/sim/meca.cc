@@ -21,8 +21,17 @@
 #define DEBUG_MECA 0
 
 
+/**
+ Keep the pattern of non-zero elements of mB and mC from one step to the next.
+ Elements that are set again do not need to be inserted, and the index arrays
+ used for the multiplication are only rebuilt if the pattern has changed.
+ */
+#define MECA_REUSE_PATTERN 1
+
+
 #include "meca.h"
 #include "mecable.h"
+#include "profile.h"
 #include "messages.h"
 #include "cblas.h"
 #include "clapack.h"
@@ -30,6 +39,8 @@
 #include <fstream>
 #include "allot.h"
 #include "vecprint.h"
+#include "gmres.h"
+#include "idrs.h"
 
 #include "meca_inter.cc"
 
@@ -48,6 +59,9 @@ Meca::Meca()
     vTMP = 0;
     use_mB = false;
     use_mC = false;
+    precondIterations = 0;
+    precondTimeStep = 0;
+    profile = 0;
 }
 
 
@@ -84,6 +98,15 @@ void Meca::add(Mecable* o)
 //==========================================================================
 #pragma mark -
 
+/// arguments passed to the threads by multiply() and precondition()
+struct MulArg
+{
+    Meca const* meca;
+    const real* X;
+    real*       Y;
+};
+
+
 /**
  Compute the linear part of the forces.
  The forces in a system with coordinates X are:
@@ -158,6 +181,13 @@ void Meca::multiply( const real* X, real* Y ) const
 {
     // vTMP is a temporary storage !
     assert_true( X != Y  &&  X != vTMP  &&  Y != vTMP );
+    
+    if ( pool.size() > 1 )
+    {
+        MulArg arg = { this, X, Y };
+        const_cast<ThreadPool&>(pool).run(multiplyJob, &arg);
+        return;
+    }
 
     // vTMP <= Forces = ( mB + mC ) * X
     blas_xzero(DIM*nbPts, vTMP);
@@ -180,6 +210,114 @@ void Meca::multiply( const real* X, real* Y ) const
     blas_xaxpy(DIM*nbPts, 1.0, X, 1, Y, 1);
 }
 
+//------------------------------------------------------------------------------
+#pragma mark - Multithreading
+
+/**
+ Distribute the Mecables into contiguous slices, one per thread, 
+ trying to balance the number of operations done by each thread in multiply().
+ The cost of a Mecable is estimated from its number of points and from
+ the number of matrix elements on the corresponding lines of mB and mC.
+ This must be called after MatrixSparseSymmetric1::prepareForMultiplyLines()
+ */
+void Meca::makeSlices()
+{
+    const unsigned nbo = objs.size();
+    Allot<real> cost(nbo+1, 0);
+    
+    real sum = 0;
+    for ( unsigned n = 0; n < nbo; ++n )
+    {
+        Mecable const* mec = objs[n];
+        const index_type inx = mec->matIndex();
+        const unsigned nbp = mec->nbPoints();
+        real c = 4 * DIM * nbp;
+        if ( use_mB )
+            c += DIM * mB.nbElementsInLines(inx, inx+nbp);
+        if ( use_mC )
+            c += mC.nbElementsInLines(DIM*inx, DIM*(inx+nbp));
+        sum += c;
+        cost[n] = sum;
+    }
+    
+    const unsigned nbt = pool.size();
+    slices.resize(nbt+1);
+    slices[0] = 0;
+    unsigned n = 0;
+    for ( unsigned t = 1; t < nbt; ++t )
+    {
+        const real lim = sum * t / nbt;
+        while ( n < nbo  &&  cost[n] < lim )
+            ++n;
+        slices[t] = n;
+    }
+    slices[nbt] = nbo;
+}
+
+
+void Meca::multiplyJob(void* arg, unsigned rank, unsigned)
+{
+    MulArg const* mul = static_cast<MulArg*>(arg);
+    Meca const* meca = mul->meca;
+    meca->multiply(mul->X, mul->Y, meca->slices[rank], meca->slices[rank+1]);
+}
+
+
+/**
+ This is equivalent to multiply(), for the Mecables objs[k] with start <= k < stop.
+ It only writes to the section of vTMP and Y that corresponds to these Mecables,
+ and can thus be called concurrently for non-overlapping ranges.
+ */
+void Meca::multiply( const real* X, real* Y, const unsigned start, const unsigned stop ) const
+{
+    if ( start >= stop )
+        return;
+    
+    Mecable ** const beg = objs.begin() + start;
+    Mecable ** const end = objs.begin() + stop;
+    
+    // range of points corresponding to the Mecables:
+    const index_type inx = (*beg)->matIndex();
+    const index_type sup = end[-1]->matIndex() + end[-1]->nbPoints();
+    const unsigned sz = DIM * ( sup - inx );
+    
+    blas_xzero(sz, vTMP+DIM*inx);
+    
+#if ( DIM > 1 )
+    for ( Mecable ** mci = beg; mci < end; ++mci )
+    {
+        const index_type indx = DIM * (*mci)->matIndex();
+        (*mci)->addRigidity( X+indx, vTMP+indx );
+    }
+#endif
+    
+    if ( use_mB )
+    {
+#if ( DIM == 1 )
+        mB.vecMulAdd( X, vTMP, inx, sup );
+#elif ( DIM == 2 )
+        mB.vecMulAddIso2D( X, vTMP, inx, sup );
+#elif ( DIM == 3 )
+        mB.vecMulAddIso3D( X, vTMP, inx, sup );
+#endif
+    }
+    
+    if ( use_mC )
+        mC.vecMulAdd( X, vTMP, DIM*inx, DIM*sup );
+    
+    for ( Mecable ** mci = beg; mci < end; ++mci )
+    {
+        Mecable const * mec = *mci;
+        const index_type indx = DIM * mec->matIndex();
+#ifdef PROJECTION_DIFF
+        mec->addProjectionDiff( X+indx, vTMP+indx );
+#endif
+        mec->setSpeedsFromForces( vTMP+indx, Y+indx, -time_step );
+    }
+    
+    blas_xaxpy(sz, 1.0, X+DIM*inx, 1, Y+DIM*inx, 1);
+}
+
 //==========================================================================
 //======================   PRECONDITIONNING   ==============================
 //==========================================================================
@@ -402,14 +540,46 @@ int Meca::computePreconditionner(Mecable* mec, int* ipiv, real* work, int worksi
 }
 
 
+/**
+ This is the sum of the absolute values of the diagonal elements of mB and mC,
+ for the points of the Mecable. It is used to detect when the preconditioner
+ block of the Mecable has become outdated.
+ */
+real Meca::diagonalNorm(const Mecable * mec) const
+{
+    real res = 0;
+    const index_type inx = mec->matIndex();
+    const index_type sup = inx + mec->nbPoints();
+    
+    for ( index_type ii = inx; ii < sup; ++ii )
+    {
+        real * a = mB.addr(ii, ii);
+        if ( a ) res += DIM * fabs(*a);
+    }
+    for ( index_type ii = DIM*inx; ii < DIM*sup; ++ii )
+    {
+        real * a = mC.addr(ii, ii);
+        if ( a ) res += fabs(*a);
+    }
+    return res;
+}
+
+
 // Using dynamic memory to compute preconditionner
 /**
+ If `all == false`, the block of a Mecable is only recalculated if it is 
+ outdated, according to SimulProp::precondition_lifetime and precondition_drift.
+ 
  The code can be parallelized here:
  - allocate temporary memory for each thread
  - distribute block calculation to different threads
  */
-int Meca::computePreconditionner()
+int Meca::computePreconditionner(SimulProp const* prop, bool all)
 {
+    const unsigned lifetime = prop->precondition_lifetime;
+    if ( lifetime == 0 )
+        all = true;
+
     int work_size = 2048;
     
     if ( 1 )
@@ -434,8 +604,22 @@ int Meca::computePreconditionner()
     {
         Mecable * mec = *mci;
         assert_true( mec->nbPoints() <= largestBlock );
+        real diag = 0;
+        if ( lifetime > 0 )
+            diag = diagonalNorm(mec);
+        
+        if ( !all  &&  mec->useBlock()  &&  mec->blockPoints() == mec->nbPoints()
+            &&  mec->blockAge() < lifetime
+            &&  fabs(diag-mec->blockDiag()) <= prop->precondition_drift * mec->blockDiag() )
+        {
+            // reuse the block calculated previously:
+            mec->blockAging();
+            continue;
+        }
+        
         int res = computePreconditionner(mec, ipiv, work, work_size);
         mec->useBlock(res==0);
+        mec->blockStamp(diag);
     }
     
     delete[] ipiv;
@@ -445,9 +629,65 @@ int Meca::computePreconditionner()
 
 
 //------------------------------------------------------------------------------
-void Meca::precondition(const real* X, real* Y) const
+/**
+ The displacements recorded at the previous step are copied in vSOL,
+ and scaled by a factor `s` that minimizes the residual | vRHS - s * M * vSOL |.
+ The guess is set to zero if no displacement was recorded, or if s <= 0.
+ This uses one multiplication by the matrix.
+ */
+void Meca::setInitialGuess()
 {
+    const unsigned sz = DIM * nbPts;
+    bool any = false;
     for ( Mecable ** mci = objs.begin(); mci < objs.end(); ++mci )
+    {
+        Mecable const * mec = *mci;
+        real * X = vSOL + DIM * mec->matIndex();
+        if ( mec->putDisplacement(X) )
+            any = true;
+        else
+            blas_xzero(DIM*mec->nbPoints(), X);
+    }
+    
+    if ( any )
+    {
+        Allot<real> tmp(sz, 0);
+        multiply(vSOL, tmp);
+        real n = blas_xdot(sz, tmp, 1, tmp, 1);
+        real s = blas_xdot(sz, tmp, 1, vRHS, 1);
+        if ( n > 0  &&  s > 0 )
+            blas_xscal(sz, s/n, vSOL, 1);
+        else
+            blas_xzero(sz, vSOL);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void Meca::precondition(const real* X, real* Y) const
+{
+    if ( pool.size() > 1 )
+    {
+        MulArg arg = { this, X, Y };
+        const_cast<ThreadPool&>(pool).run(preconditionJob, &arg);
+    }
+    else
+        precondition(X, Y, 0, objs.size());
+}
+
+
+void Meca::preconditionJob(void* arg, unsigned rank, unsigned)
+{
+    MulArg const* mul = static_cast<MulArg*>(arg);
+    Meca const* meca = mul->meca;
+    meca->precondition(mul->X, mul->Y, meca->slices[rank], meca->slices[rank+1]);
+}
+
+
+void Meca::precondition(const real* X, real* Y, const unsigned start, const unsigned stop) const
+{
+    Mecable ** const end = objs.begin() + stop;
+    for ( Mecable ** mci = objs.begin() + start; mci < end; ++mci )
     {
         Mecable const* mec = *mci;
         const unsigned bs = DIM * mec->nbPoints();
@@ -502,8 +742,13 @@ void Meca::prepare(SimulProp const* prop)
     mC.allocate( DIM*nbPts );
     
     //reset matrices:
+#if MECA_REUSE_PATTERN
+    mB.resetValues();
+    mC.resetValues();
+#else
     mB.makeZero();
     mC.makeZero();
+#endif
     
     //allocate the vectors
     if ( nbPts > allocated )
@@ -581,6 +826,49 @@ void Meca::computeForces()
 
 
 
+/**
+ Solve MAT * vSOL = vRHS, using the method specified by `simul:solver`,
+ and vSOL as initial guess.
+ The preconditionner must have been computed if `precondition` is true.
+ */
+void Meca::iterativeSolve(SimulProp const* prop, bool precondition,
+                          Solver::Monitor& monitor, Solver::Allocator& allocator)
+{
+    Solver::Unpreconditioned<Meca> plain(*this);
+    
+    switch ( prop->solver )
+    {
+        case SimulProp::SOLVER_GMRES:
+            if ( precondition )
+                Solver::GMRES(*this, vRHS, vSOL, monitor, allocator, prop->solver_dim);
+            else
+                Solver::GMRES(plain, vRHS, vSOL, monitor, allocator, prop->solver_dim);
+            break;
+            
+        case SimulProp::SOLVER_IDRS:
+            if ( precondition )
+                Solver::IDRS(*this, vRHS, vSOL, monitor, allocator, prop->solver_dim);
+            else
+                Solver::IDRS(plain, vRHS, vSOL, monitor, allocator, prop->solver_dim);
+            break;
+            
+        case SimulProp::SOLVER_PIPELINED_BICGSTAB:
+            if ( precondition )
+                Solver::PBCGSP(*this, vRHS, vSOL, monitor, allocator);
+            else
+                Solver::PBCGSP(plain, vRHS, vSOL, monitor, allocator);
+            break;
+            
+        default:
+            if ( precondition )
+                Solver::BCGSP(*this, vRHS, vSOL, monitor, allocator);
+            else
+                Solver::BCGS(*this, vRHS, vSOL, monitor, allocator);
+            break;
+    }
+}
+
+
 #define not_a_number(x) ((x) != (x))
 
 /**
@@ -602,6 +890,9 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
     if ( objs.size() == 0 )
         return;
     
+    if ( profile )
+        profile->tic();
+
     if ( mB.nonZero() )
     {
         use_mB = true;
@@ -617,6 +908,22 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
     }
     else
         use_mC = false;
+    
+    // distribute the work for multiply() and precondition():
+    pool.resize(prop->threads);
+    if ( pool.size() > 1 )
+    {
+        if ( use_mB ) mB.prepareForMultiplyLines();
+        if ( use_mC ) mC.prepareForMultiplyLines();
+        makeSlices();
+    }
+    
+    if ( profile )
+    {
+        profile->toc(Profile::MATRIX);
+        if ( profile->enabled() )
+            profile->set(Profile::ELEMENTS, mB.nbNonZeroElements() + mC.nbNonZeroElements());
+    }
 
     // calculate forces before constraints in vFOR:
     computeForces(vPTS, vFOR, true);
@@ -699,9 +1006,14 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
      somehow continuous. However, the system is without inertia. In addition,
      objects are considered in a random order to build the linear system, such
      that the blocks from two consecutive iterations do not match.
-     Using zero for the initial guess seems a safe bet:
+     Using zero for the initial guess seems a safe bet.
+     With SimulProp::warm_start, the displacements are recorded per Mecable,
+     and thus independently of the order of the objects in the system.
      */
-    blas_xzero(DIM*nbPts, vSOL);
+    if ( prop->warm_start )
+        setInitialGuess();
+    else
+        blas_xzero(DIM*nbPts, vSOL);
 
     /*
      We now solve the system MAT * vSOL = vRHS  by an iterative method:
@@ -726,18 +1038,47 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
     /*
      With exact arithmetic, biConjugate Gradient should converge at most
      in a number of iterations equal to the size of the linear system.
-     This is the max limit that is set here to the number of iterations:
+     This is the max limit that is set here to the number of iterations.
+     GMRES and IDR(s) count one iteration per matrix-vector product, while
+     BiCGStab does two products per iteration, so their limit is doubled
+     to give them the same budget of products:
      */
-    Solver::Monitor monitor(DIM*nbPts, prop->tolerance*noiseLevel);
+    unsigned max_iter = DIM * nbPts;
+    if ( prop->solver == SimulProp::SOLVER_GMRES  ||  prop->solver == SimulProp::SOLVER_IDRS )
+        max_iter *= 2;
+    Solver::Monitor monitor(max_iter, prop->tolerance*noiseLevel);
 
     //------- call the iterative solver:
-    //@todo: we may not need to calculate the preconditioner at every step
     //std::cerr << "Solve: " << DIM*nbPts << "  " << residual_ask << std::endl;
 
-    if ( precondition  &&  0 == computePreconditionner() ) 
-        Solver::BCGSP(*this, vRHS, vSOL, monitor, allocator);
+    // recalculate all the blocks of the preconditioner if necessary:
+    const bool all = ( precondIterations == 0  ||  precondTimeStep != time_step );
+
+    if ( profile )
+        profile->toc(Profile::FORCES);
+    
+    const bool use_precond = ( precondition  &&  0 == computePreconditionner(prop, all) );
+    
+    if ( profile )
+        profile->toc(Profile::PRECONDITION);
+
+    if ( use_precond )
+    {
+        iterativeSolve(prop, true, monitor, allocator);
+        
+        if ( all )
+        {
+            precondIterations = std::max(1, monitor.iterations());
+            precondTimeStep = time_step;
+        }
+        else if ( monitor.iterations() > 2 * precondIterations )
+        {
+            // the preconditioner is outdated: recalculate everything at the next step
+            precondIterations = 0;
+        }
+    }
     else
-        Solver::BCGS(*this, vRHS, vSOL, monitor, allocator);
+        iterativeSolve(prop, false, monitor, allocator);
     
 #if ( 0 )
     std::cerr << "BCGS" << precondition << "  " << code;
@@ -757,11 +1098,16 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
         //---reset tolerance and iteration counters:
         monitor.reset();
         
-        //---try the same method again:
+        //---try the same method again, with an up-to-date preconditioner:
         if ( precondition )
-            Solver::BCGSP(*this, vRHS, vSOL, monitor, allocator);
+        {
+            precondIterations = 0;
+            if ( !all )
+                computePreconditionner(prop, true);
+            iterativeSolve(prop, true, monitor, allocator);
+        }
         else
-            Solver::BCGS(*this, vRHS, vSOL, monitor, allocator);
+            iterativeSolve(prop, false, monitor, allocator);
         
         //---check again for convergence:
         if ( monitor.converged() )
@@ -776,11 +1122,11 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
             
             //---try the other method:
             if ( precondition ) {
-                Solver::BCGS(*this, vRHS, vSOL, monitor, allocator);
+                iterativeSolve(prop, false, monitor, allocator);
             }
             else {
-                if ( 0 == computePreconditionner() )
-                    Solver::BCGSP(*this, vRHS, vSOL, monitor, allocator);
+                if ( 0 == computePreconditionner(prop, true) )
+                    iterativeSolve(prop, true, monitor, allocator);
                 else
                     Cytosim::MSG("Failed to compute precondionner");
             }
@@ -798,9 +1144,21 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
         }
     }
     
+    if ( profile )
+    {
+        profile->toc(Profile::SOLVER);
+        profile->add(Profile::ITERATIONS, monitor.iterations());
+    }
+
     //add the solution of the system (=dPTS) to the points coordinates
     blas_xaxpy(DIM*nbPts, 1., vSOL, 1, vPTS, 1);
     
+    if ( prop->warm_start )
+    {
+        for ( Mecable ** mci = objs.begin(); mci < objs.end(); ++mci )
+            (*mci)->getDisplacement(vSOL+DIM*(*mci)->matIndex());
+    }
+    
     
 #ifndef NDEBUG
     
@@ -834,6 +1192,9 @@ void Meca::solve(SimulProp const* prop, const bool precondition)
         mec->getForces(vFOR+DIM*mec->matIndex());
     }
     
+    if ( profile )
+        profile->toc(Profile::FORCES);
+    
     //report on the matrix type and size, sparsity, and the number of iterations
     if ( prop->verbose )
     {
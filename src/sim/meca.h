@@ -10,12 +10,27 @@
 #include "matsparse.h"
 #include "matsparsesym.h"
 #include "matsparsesym1.h"
+#include "matsparsesymblk.h"
+#include "thread_pool.h"
+
+
+/// Selects the type of sparse matrix used for mB and mC
+/**
+ If MECA_USES_BLOCK_MATRIX is 1, mC uses MatrixSparseSymmetricBlock<DIM>,
+ in which the elements are stored by blocks of size DIM*DIM,
+ while mB uses MatrixSparseSymmetricBlock<1>.
+ Otherwise, both matrices use MatrixSparseSymmetric1, as before the block format was added.
+ The block format changes the order of the floating-point operations, and the results
+ are thus not identical to the default format.
+ */
+#define MECA_USES_BLOCK_MATRIX 0
 
 class Mecable;
 class PointExact;
 class PointInterpolated;
 class SimulProp;
 class Modulo;
+class Profile;
 
 
 /// A class to calculate the motion of objects in Cytosim
@@ -66,6 +81,12 @@ Meca solves the motion of point-objects defined by the dynamic equation:
  .
  
  
+ Multithreading: if SimulProp::threads > 1, the Mecables are distributed into
+ contiguous slices of similar cost, and multiply() and precondition() process 
+ each slice in a different thread. For this, the sparse matrices are stored
+ by lines (see prepareForMultiplyLines), such that each
+ thread only writes to the part of the vectors corresponding to its own slice.
+ 
  Note: All Links are disabled if the given PointExacts or PointInterpolated have a point 
  in common, because the matrix elements are not calcuated correctly in that case. 
  Generally, such interactions are anyway not desirable. It would correspond for 
@@ -113,12 +134,33 @@ private:
     /// true if the matrix mC is non-zero and used
     bool   use_mC;
     
+    //--------------------------------------------------------------------------
+    
+    /// threads used to parallelize multiply() and precondition()
+    ThreadPool       pool;
+    
+    /// Mecables objs[k] with slices[i] <= k < slices[i+1] are handled by thread i
+    Array<unsigned>  slices;
+    
+    /// number of iterations of the solver, after all blocks of the preconditioner were calculated
+    int              precondIterations;
+    
+    /// time_step used to calculate the blocks of the preconditioner
+    real             precondTimeStep;
+    
+    /// record of the time spent in the different phases of solve(), or zero
+    Profile *        profile;
+    
 public:
     /// isotropic symmetric part of the dynamic, size (nbPts)^2
     /** 
         For interactions which have identical coefficients on the X, Y, Z subspaces
     */
+#if MECA_USES_BLOCK_MATRIX
+    MatrixSparseSymmetricBlock<1>    mB;
+#else
     MatrixSparseSymmetric1  mB;
+#endif
 
     
     /// non-isotropic symmetric part of the dynamic, size (DIM*nbPts)^2
@@ -126,7 +168,11 @@ public:
         For interactions which have different coefficients on the X, Y, Z subspaces,
         or which create interactions between two different subspaces.
     */
+#if MECA_USES_BLOCK_MATRIX
+    MatrixSparseSymmetricBlock<DIM>  mC;
+#else
     MatrixSparseSymmetric1  mC;
+#endif
 
     /// base for force
     real&   base(index_type ix) { return vBAS[ix]; }
@@ -151,12 +197,36 @@ private:
     /// extract the matrix diagonal block corresponding to a Mecable
     void  getBlockS(const Mecable *, real*) const;
 
+    /// norm of the diagonal of the matrix block corresponding to a Mecable
+    real  diagonalNorm(const Mecable *) const;
+
+    /// set initial guess vSOL from the displacements recorded by the Mecables
+    void  setInitialGuess();
+
     /// allocate memory, compute preconditionner and return true if completed
-    int   computePreconditionner();
+    int   computePreconditionner(SimulProp const*, bool all);
     
     /// compute preconditionner using the provided temporary memory
     int   computePreconditionner(Mecable*, int*, real*, int);
     
+    /// solve the system with the method specified by `simul:solver`
+    void  iterativeSolve(SimulProp const*, bool precondition, Solver::Monitor&, Solver::Allocator&);
+    
+    /// distribute the Mecables into slices of similar cost, one for each thread
+    void  makeSlices();
+    
+    /// calculate Y = M*X, only for Mecables objs[k] with start <= k < stop
+    void  multiply(const real* X, real* Y, unsigned start, unsigned stop) const;
+    
+    /// apply preconditionner Y = P*X, only for Mecables objs[k] with start <= k < stop
+    void  precondition(const real* X, real* Y, unsigned start, unsigned stop) const;
+    
+    /// entry point for the threads executing multiply()
+    static void multiplyJob(void*, unsigned, unsigned);
+    
+    /// entry point for the threads executing precondition()
+    static void preconditionJob(void*, unsigned, unsigned);
+    
 public:
     
 
@@ -172,6 +242,9 @@ public:
     /// Number of Mecable
     unsigned nbMecables() const { return objs.size(); }
     
+    /// the threads used by Meca, which can also be used for other tasks
+    ThreadPool& threadPool() { return pool; }
+    
     /// number of points in the system
     unsigned nbPoints() const { return nbPts; }
     
@@ -304,6 +377,12 @@ public:
     /// Calculate motion of the system
     void  solve(SimulProp const*, bool precondition);
     
+    /// recalculate all the blocks of the preconditioner at the next call to solve()
+    void  renewPreconditioner() { precondIterations = 0; }
+    
+    /// record the time spent in solve() in `p`, which can be zero
+    void  setProfile(Profile * p) { profile = p; }
+    
     /// calculate Forces on objects and Lagrange multipliers for Fiber, without thermal motion
     void  computeForces();
     
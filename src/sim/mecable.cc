@@ -7,7 +7,8 @@
 #include "organizer.h"
 
 
-Mecable::Mecable() : mIndex(0), pBlock(0), pBlockSize(0), pBlockUse(false)
+Mecable::Mecable() : mIndex(0), pBlock(0), pBlockSize(0), pBlockUse(false),
+pBlockPoints(0), pBlockAge(0), pBlockDiag(0), pDisp(0), pDispSize(0), pDispPoints(0), pForce(0), pForceSize(0)
 {
 }
 
@@ -38,5 +39,86 @@ Mecable::~Mecable()
 {
     if ( pBlock )
         delete[] pBlock;
+    if ( pDisp )
+        delete[] pDisp;
+    if ( pForce )
+        delete[] pForce;
+}
+
+
+void Mecable::getDisplacement(const real X[])
+{
+    const unsigned size = DIM * nbPoints();
+    if ( size > pDispSize )
+    {
+        if ( pDisp )
+            delete[] pDisp;
+        pDispSize = size;
+        pDisp = new real[size];
+    }
+    blas_xcopy(size, X, 1, pDisp, 1);
+    pDispPoints = nbPoints();
+}
+
+
+/**
+ The displacement is not available if the number of points has changed,
+ since the last call to getDisplacement()
+ */
+bool Mecable::putDisplacement(real X[]) const
+{
+    if ( pDispPoints == 0  ||  pDispPoints != nbPoints() )
+        return false;
+    blas_xcopy(DIM*pDispPoints, pDisp, 1, X, 1);
+    return true;
+}
+
+
+/**
+ The forces calculated by Meca are used at the next time step,
+ for example to set the growth speed of the fibers.
+ */
+void Mecable::writeState(OutputWrapper& out) const
+{
+    out.writeUInt32(pDispPoints);
+    for ( unsigned i = 0; i < DIM*pDispPoints; ++i )
+        out.writeDouble(pDisp[i]);
+    
+    out.writeUInt32(nbPoints());
+    for ( unsigned p = 0; p < nbPoints(); ++p )
+    {
+        Vector f = netForce(p);
+        for ( int d = 0; d < DIM; ++d )
+            out.writeDouble(f[d]);
+    }
+}
+
+
+void Mecable::readState(InputWrapper& in)
+{
+    const unsigned pts = in.readUInt32();
+    const unsigned size = DIM * pts;
+    if ( size > pDispSize )
+    {
+        if ( pDisp )
+            delete[] pDisp;
+        pDispSize = size;
+        pDisp = new real[size];
+    }
+    for ( unsigned i = 0; i < size; ++i )
+        pDisp[i] = in.readDouble();
+    pDispPoints = pts;
+    
+    const unsigned nbf = DIM * in.readUInt32();
+    if ( nbf > pForceSize )
+    {
+        if ( pForce )
+            delete[] pForce;
+        pForceSize = nbf;
+        pForce = new real[nbf];
+    }
+    for ( unsigned i = 0; i < nbf; ++i )
+        pForce[i] = in.readDouble();
+    getForces(pForce);
 }
 
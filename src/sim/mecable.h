@@ -37,6 +37,30 @@ private:
     /// flag for preconditionning
     bool          pBlockUse;
     
+    /// number of points of the object when pBlock was calculated
+    unsigned int  pBlockPoints;
+    
+    /// number of steps since pBlock was calculated
+    unsigned int  pBlockAge;
+    
+    /// norm of the diagonal of the dynamic matrix when pBlock was calculated
+    real          pBlockDiag;
+    
+    /// displacement of the points during the last time step
+    real *        pDisp;
+    
+    /// allocated size of pDisp
+    unsigned int  pDispSize;
+    
+    /// number of points of the object when pDisp was recorded
+    unsigned int  pDispPoints;
+    
+    /// forces restored by readState(), until Meca calculates new ones
+    real *        pForce;
+    
+    /// allocated size of pForce
+    unsigned int  pForceSize;
+    
     ///\todo add Mecable copy constructor and copy assignment
     
     /// Disabled copy constructor
@@ -102,6 +126,35 @@ public:
     /// return allocated block
     real *        block()          const { return pBlock; }
     
+    /// record that the block was just calculated, with given norm of the diagonal
+    void          blockStamp(real d)    { pBlockPoints = nbPoints(); pBlockAge = 0; pBlockDiag = d; }
+    
+    /// increment the age of the block, if it is used for one more step
+    void          blockAging()          { ++pBlockAge; }
+
+    /// number of points of the object when the block was calculated
+    unsigned      blockPoints()   const { return pBlockPoints; }
+
+    /// number of steps since the block was calculated
+    unsigned      blockAge()      const { return pBlockAge; }
+    
+    /// norm of the diagonal of the dynamic matrix when the block was calculated
+    real          blockDiag()     const { return pBlockDiag; }
+    
+    //--------------------------------------------------------------------------
+    
+    /// record the displacement of the points calculated by Meca, from the provided array
+    void          getDisplacement(const real[]);
+    
+    /// copy the last recorded displacement to the provided array, and return true if this was possible
+    bool          putDisplacement(real[]) const;
+    
+    /// write the recorded displacement and the forces of the last time step
+    void          writeState(OutputWrapper&) const;
+    
+    /// read the displacement and forces written by writeState()
+    void          readState(InputWrapper&);
+    
     //--------------------------------------------------------------------------
     /// Calculate the mobility coefficient
     virtual void  setDragCoefficient() = 0;
@@ -71,6 +71,12 @@ public:
     /// read Object from file, within the Simul
     virtual void    read(InputWrapper&, Simul&) = 0;
     
+    /// write variables that are not saved by write(), but are needed to continue a simulation exactly
+    virtual void    writeState(OutputWrapper&) const {}
+    
+    /// read the variables written by writeState()
+    virtual void    readState(InputWrapper&) {}
+    
     
     /// concatenation of [ tag(), property()->index(), number() ] in plain ascii
     std::string     reference() const;
@@ -422,6 +422,7 @@ void ObjectSet::readObject(InputWrapper& in, const Tag tag, const char pretag)
     else
     {
         //std::cerr << "creating " << tag << nb << std::endl;
+        simul.creating();
         w = newObjectT(tag, ix);
         w->number(nb);
         w->mark(mk);
@@ -402,3 +402,21 @@ Vector Aster::posLink2(const unsigned x) const
         return fib->pos(asClamp[ii].clampA, prop->focus);
 }
 
+
+void Aster::writeState(OutputWrapper& out) const
+{
+    out.writeUInt32(asClamp.size());
+    for ( unsigned ii = 0; ii < asClamp.size(); ++ii )
+        out.writeDouble(asClamp[ii].clampA);
+}
+
+
+void Aster::readState(InputWrapper& in)
+{
+    unsigned nc = in.readUInt32();
+    if ( nc != asClamp.size() )
+        throw InvalidIO("invalid number of clamps in Aster::readState()");
+    for ( unsigned ii = 0; ii < nc; ++ii )
+        asClamp[ii].clampA = in.readDouble();
+}
+
@@ -140,6 +140,12 @@ public:
     /// write to IO
     void          write(OutputWrapper&) const;
     
+    /// write the distances of the clamps, which are not saved by write()
+    void          writeState(OutputWrapper&) const;
+    
+    /// read the state written by writeState()
+    void          readState(InputWrapper&);
+    
 };
 
 
@@ -566,6 +566,11 @@ void Parser::parse_cut(std::istream & is)
    event     = RATE, ( CODE )
    nb_frames = INTEGER
    prune     = BOOL
+   binary    = 0, 1 or 2
+   precision = REAL
+   async     = BOOL
+   keyframe  = INTEGER
+   checkpoint = INTEGER, FILE_NAME
  }
  @endcode
  
@@ -581,6 +586,11 @@ void Parser::parse_cut(std::istream & is)
  `event`       |  none     | custom code executed stochastically with prescribed rate
  `nb_frames`   |  0        | number of states written to trajectory file
  `prune`       |  true     | Print only parameters that are different from default
+ `binary`      |  1        | Trajectory format: 0 = text, 1 = binary, 2 = compressed binary
+ `precision`   |  0.0001   | Precision of coordinates, with `binary = 2`
+ `async`       |  false    | Write frames to the trajectory file from a separate thread
+ `keyframe`    |  0        | Period of complete frames; the others only contain changed objects
+ `checkpoint`  |  0        | Period of checkpoints in frames, and name of the checkpoint file
  \n
   
  If set, `event` defines an event occuring at a rate specified by the positive real \c RATE.
@@ -592,6 +602,24 @@ void Parser::parse_cut(std::istream & is)
  event = 10, ( new fiber actin { position=(rectangle 1 6); length=0.1; } )
  @endcode
  
+ With `binary = 2`, the coordinates of the fiber points are rounded to multiples of
+ `precision`, and stored as differences between consecutive points, with a variable
+ number of bytes. This reduces the size of trajectory files that contain many fibers.
+ 
+ With `async = 1`, each frame is formatted in memory, and written to file by a separate
+ thread while the simulation continues. The trajectory file is identical, and it is
+ complete when `run` terminates.
+ 
+ With `keyframe = K > 1`, a complete frame is written every K frames,
+ and the intermediate frames only contain the objects that have changed since
+ the previous frame, and the list of objects that were deleted.
+ Reading such a frame requires reading the frames preceding it, up to the last
+ complete frame, which is done automatically by `play` and `report`.
+ 
+ With `checkpoint = P, FILE_NAME`, the state of the simulation is saved to FILE_NAME
+ (default `checkpoint.cmc`) after every P frames, together with the progress of `run`.
+ The run can then be continued with `restart` (see Parser::parse_restart).
+ 
  Calling `run` will not output the initial state, but this can be done with `write`:
  @code
  write state objects.cmo { append = 0 }
@@ -749,11 +777,13 @@ void Parser::parse_import(std::istream & is)
  export WHAT FILE_NAME
  {
  append = BOOL
- binary = BOOL
+ binary = 0, 1 or 2
+ precision = REAL
  }
  @endcode
  
  WHAT must be ``objects``, and by default, `binary` and `append` are both `true`.
+ With `binary = 2`, coordinates are compressed with the given `precision` (see `run`).
  If `*` is specified instead of a file name, the current trajectory file will be used.
  
  
@@ -795,6 +825,94 @@ void Parser::parse_export(std::istream & is)
     }
 }
 
+/**
+ Save the complete state of the simulation to a file:
+ 
+ @code
+ checkpoint FILE_NAME
+ @endcode
+ 
+ In addition to the objects, which are saved without rounding, the checkpoint
+ contains the state of the random number generator and the variables that are not
+ saved in trajectory files, such as the Gillespie times of the Hands.
+ The simulation can be continued from this state with `restart`, and the result
+ is then identical to the one obtained without interruption.
+ 
+ Checkpoints can also be written periodically by `run` (see Parser::parse_run).
+ 
+ Attention: this command is disabled for `play`.
+ */
+
+void Parser::parse_checkpoint(std::istream & is)
+{
+    std::string file = Tokenizer::get_token(is);
+    
+    if ( file.empty() )
+        throw InvalidSyntax("missing/invalid file name after 'checkpoint'");
+    
+    std::string blok = Tokenizer::get_block(is, '{');
+    Glossary opt(blok);
+    
+    if ( do_write )
+    {
+        execute_checkpoint(file, opt);
+        if ( opt.warnings(std::cerr) )
+            StreamFunc::show_lines(std::cerr, is, spos, is.tellg());
+    }
+}
+
+
+/**
+ Restore the state of the simulation saved by `checkpoint`:
+ 
+ @code
+ restart FILE_NAME
+ {
+   required = BOOL
+ }
+ @endcode
+ 
+ All the objects are replaced by those of the checkpoint.
+ If the checkpoint was written by `run`, the next `run` command continues
+ from the step at which the checkpoint was written, and the frames that were written to the
+ trajectory file after the checkpoint are discarded.
+ This `run` command should be identical to the one that wrote the checkpoint.
+ 
+ With `required = 0`, the command does nothing if the file does not exist.
+ The same config file can then be used to start a simulation, and to continue it:
+ @code
+ restart checkpoint.cmc { required = 0 }
+ 
+ run 100000 simul *
+ {
+   nb_frames  = 1000
+   checkpoint = 10
+ }
+ @endcode
+ 
+ The commands preceding `restart` are executed every time, and they should not
+ modify the trajectory file.
+ */
+
+void Parser::parse_restart(std::istream & is)
+{
+    std::string file = Tokenizer::get_token(is);
+    
+    if ( file.empty() )
+        throw InvalidSyntax("missing/invalid file name after 'restart'");
+    
+    std::string blok = Tokenizer::get_block(is, '{');
+    Glossary opt(blok);
+    
+    if ( do_new )
+    {
+        execute_restart(file, opt);
+        if ( opt.warnings(std::cerr) )
+            StreamFunc::show_lines(std::cerr, is, spos, is.tellg());
+    }
+}
+
+
 /**
  Export formatted data to file. The general syntax is:
  
@@ -964,6 +1082,8 @@ void Parser::parse_stop(std::istream & is)
  `write`        | export formatted data with selected object properties
  `import`       | Import Objects from trajectory file
  `export`       | Export all Objects to file, with their coordinates
+ `checkpoint`   | Save the complete state of the simulation
+ `restart`      | Restore the state saved by `checkpoint`
  
  Other commands:
  
@@ -1052,6 +1172,10 @@ void Parser::parse(std::istream & is, std::string const& msg)
                 parse_import(is);
             else if ( tok == "export" )
                 parse_export(is);
+            else if ( tok == "checkpoint" )
+                parse_checkpoint(is);
+            else if ( tok == "restart" )
+                parse_restart(is);
             else if ( tok == "call" )
                 parse_call(is);
             else if ( tok == "repeat" )
@@ -81,6 +81,12 @@ public:
     /// parse command \b read
     void      parse_export(std::istream&);
     
+    /// parse command \b checkpoint
+    void      parse_checkpoint(std::istream&);
+    
+    /// parse command \b restart
+    void      parse_restart(std::istream&);
+    
     /// parse command \b write
     void      parse_report(std::istream&);
     
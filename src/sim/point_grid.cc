@@ -13,7 +13,7 @@ extern Modulo const* modulo;
 //------------------------------------------------------------------------------
 
 PointGrid::PointGrid()
-: max_diameter(0)
+: max_diameter(0), buffers(0), nbBuffers(0)
 {
 }
 
@@ -132,7 +132,8 @@ void PointGrid::add(const FiberLocus & p, real rd, real rg) const
  The force is applied if the objects are closer than the
  sum of their radiuses.
  */
-void PointGrid::checkPP(Meca& meca, PointGridParam const& pam, FatPoint const& aa, FatPoint const& bb) const
+template < typename MECA >
+void PointGrid::checkPP(MECA& meca, PointGridParam const& pam, FatPoint const& aa, FatPoint const& bb) const
 {
     const real len = aa.radius + bb.radius;
     Vector vab = bb.pos - aa.pos;
@@ -151,7 +152,8 @@ void PointGrid::checkPP(Meca& meca, PointGridParam const& pam, FatPoint const& a
  
  The force is applied if the objects are closer to the sum of their radiuses.
  */
-void PointGrid::checkPL(Meca& meca, PointGridParam const& pam, FatPoint const& aa, FatLocus const& bb) const
+template < typename MECA >
+void PointGrid::checkPL(MECA& meca, PointGridParam const& pam, FatPoint const& aa, FatLocus const& bb) const
 {
     const real len = aa.radius + bb.radius;
     
@@ -203,7 +205,8 @@ void PointGrid::checkPL(Meca& meca, PointGridParam const& pam, FatPoint const& a
  
  The interaction is applied only if the model-point projects 'inside' the segment.
  */
-void PointGrid::checkLL1(Meca& meca, PointGridParam const& pam, FatLocus const& aa, FatLocus const& bb) const
+template < typename MECA >
+void PointGrid::checkLL1(MECA& meca, PointGridParam const& pam, FatLocus const& aa, FatLocus const& bb) const
 {
     const real ran = aa.range + bb.radius;
     
@@ -277,7 +280,8 @@ void PointGrid::checkLL1(Meca& meca, PointGridParam const& pam, FatLocus const&
  
  The interaction is applied only if the model-point projects 'inside' the segment.
  */
-void PointGrid::checkLL2(Meca& meca, PointGridParam const& pam, FatLocus const& aa, FatLocus const& bb) const
+template < typename MECA >
+void PointGrid::checkLL2(MECA& meca, PointGridParam const& pam, FatLocus const& aa, FatLocus const& bb) const
 {
     const real ran = aa.range + bb.radius;
     
@@ -356,7 +360,8 @@ void PointGrid::checkLL2(Meca& meca, PointGridParam const& pam, FatLocus const&
  This is used to check two FiberLocus, that each represent a segment of a Fiber.
  The segments are tested for intersection in 3D.
  */
-void PointGrid::checkLL(Meca& meca, PointGridParam const& pam, FatLocus const& aa, FatLocus const& bb) const
+template < typename MECA >
+void PointGrid::checkLL(MECA& meca, PointGridParam const& pam, FatLocus const& aa, FatLocus const& bb) const
 {
     checkLL1(meca, pam, aa, bb);
     
@@ -396,15 +401,14 @@ void PointGrid::checkLL(Meca& meca, PointGridParam const& pam, FatLocus const& a
 
 
 /**
- Check interactions between the FatPoints contained in Pane `pan1`, and `pan2`.
+ Check interactions between the objects of the cells in [start, stop[,
+ and the objects of the neighbouring cells.
  */
-void  PointGrid::setInteractions(Meca& meca, PointGridParam const& pam) const
+template < typename MECA >
+void PointGrid::checkCells(MECA& meca, PointGridParam const& pam, const unsigned start, const unsigned stop) const
 {
-    assert_true(pam.stiff_push >= 0);
-    assert_true(pam.stiff_pull >= 0);
-
     // scan all cells to examine each pair of particles:
-    for ( unsigned indx = 0; indx < mGrid.nbCells(); ++indx )
+    for ( unsigned indx = start; indx < stop; ++indx )
     {
         int * region;
         int nr = mGrid.getRegion(region, indx);
@@ -458,3 +462,150 @@ void  PointGrid::setInteractions(Meca& meca, PointGridParam const& pam) const
     }
 }
 
+
+/// arguments passed to PointGrid::checkSlice()
+struct PointGridWork
+{
+    PointGrid const*      grid;
+    PointGridParam const* pam;
+    StericLinks         * buffers;
+    unsigned const      * slices;
+};
+
+
+void PointGrid::checkSlice(void * arg, unsigned rank, unsigned)
+{
+    PointGridWork const* w = static_cast<PointGridWork const*>(arg);
+    StericLinks & buf = w->buffers[rank];
+    buf.clear();
+    w->grid->checkCells(buf, *w->pam, w->slices[rank], w->slices[rank+1]);
+}
+
+
+/**
+ Check interactions between all the objects on the grid, using the threads of the Meca
+ */
+void PointGrid::setInteractions(Meca& meca, PointGridParam const& pam) const
+{
+    assert_true(pam.stiff_push >= 0);
+    assert_true(pam.stiff_pull >= 0);
+    
+    const unsigned nbc = mGrid.nbCells();
+    ThreadPool& pool = meca.threadPool();
+    const unsigned nbt = pool.size();
+    
+    if ( nbt < 2 )
+    {
+        checkCells(meca, pam, 0, nbc);
+        return;
+    }
+    
+    if ( nbt != nbBuffers )
+    {
+        delete[] buffers;
+        buffers = new StericLinks[nbt];
+        nbBuffers = nbt;
+    }
+    
+    // divide the cells in slices containing similar numbers of objects:
+    unsigned long total = 0;
+    for ( unsigned c = 0; c < nbc; ++c )
+        total += 1 + point_list(c).size() + locus_list(c).size();
+    
+    slices.resize(nbt+1);
+    slices[0] = 0;
+    unsigned long sum = 0;
+    unsigned r = 1;
+    for ( unsigned c = 0; c < nbc  &&  r < nbt; ++c )
+    {
+        sum += 1 + point_list(c).size() + locus_list(c).size();
+        while ( r < nbt  &&  sum * nbt >= total * r )
+            slices[r++] = c+1;
+    }
+    while ( r <= nbt )
+        slices[r++] = nbc;
+    
+    PointGridWork w;
+    w.grid    = this;
+    w.pam     = &pam;
+    w.buffers = buffers;
+    w.slices  = slices.addr();
+    pool.run(checkSlice, &w);
+    
+    // enter the interactions, in the order of the cells:
+    for ( unsigned n = 0; n < nbt; ++n )
+        buffers[n].apply(meca);
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - StericLinks
+
+void StericLinks::clear()
+{
+    linksEE.clear();
+    linksIE.clear();
+    linksII.clear();
+    order.clear();
+}
+
+
+void StericLinks::interLongLink(PointExact const& a, PointExact const& b, real len, real weight)
+{
+    LinkEE & k = linksEE.new_val();
+    k.a = a;
+    k.b = b;
+    k.len = len;
+    k.weight = weight;
+    order.push_back(0);
+}
+
+
+void StericLinks::interSideSlidingLink(PointInterpolated const& a, PointExact const& b, real len, real weight)
+{
+    LinkIE & k = linksIE.new_val();
+    k.a = a;
+    k.b = b;
+    k.len = len;
+    k.weight = weight;
+    order.push_back(1);
+}
+
+
+void StericLinks::interSideSlidingLink(PointInterpolated const& a, PointInterpolated const& b, real len, real weight)
+{
+    LinkII & k = linksII.new_val();
+    k.a = a;
+    k.b = b;
+    k.len = len;
+    k.weight = weight;
+    order.push_back(2);
+}
+
+
+void StericLinks::apply(Meca& meca) const
+{
+    LinkEE const* ee = linksEE.begin();
+    LinkIE const* ie = linksIE.begin();
+    LinkII const* ii = linksII.begin();
+    
+    for ( unsigned n = 0; n < order.size(); ++n )
+    {
+        switch ( order[n] )
+        {
+            case 0:
+                meca.interLongLink(ee->a, ee->b, ee->len, ee->weight);
+                ++ee;
+                break;
+            case 1:
+                meca.interSideSlidingLink(ie->a, ie->b, ie->len, ie->weight);
+                ++ie;
+                break;
+            case 2:
+                meca.interSideSlidingLink(ii->a, ii->b, ii->len, ii->weight);
+                ++ii;
+                break;
+        }
+    }
+}
+
@@ -8,6 +8,7 @@
 #include "grid.h"
 #include "point_exact.h"
 #include "fiber_locus.h"
+#include "point_interpolated.h"
 #include "array.h"
 
 class Space;
@@ -165,6 +166,62 @@ public:
 };
 
 
+/// Records steric interactions, to enter them later into a Meca
+/**
+ This offers the same interface as Meca for the interactions used by PointGrid,
+ and apply() enters the recorded interactions in the order in which they were made.
+ */
+class StericLinks
+{
+    /// interaction between two PointExact
+    struct LinkEE
+    {
+        PointExact a, b;
+        real len, weight;
+    };
+    
+    /// interaction between a PointInterpolated and a PointExact
+    struct LinkIE
+    {
+        PointInterpolated a;
+        PointExact b;
+        real len, weight;
+    };
+    
+    /// interaction between two PointInterpolated
+    struct LinkII
+    {
+        PointInterpolated a, b;
+        real len, weight;
+    };
+    
+    /// recorded interactions of each type
+    Array<LinkEE> linksEE;
+    Array<LinkIE> linksIE;
+    Array<LinkII> linksII;
+    
+    /// type of each interaction, in the order in which they were recorded
+    Array<unsigned char> order;
+    
+public:
+    
+    /// forget all interactions
+    void clear();
+    
+    /// record Meca::interLongLink()
+    void interLongLink(PointExact const&, PointExact const&, real len, real weight);
+    
+    /// record Meca::interSideSlidingLink()
+    void interSideSlidingLink(PointInterpolated const&, PointExact const&, real len, real weight);
+    
+    /// record Meca::interSideSlidingLink()
+    void interSideSlidingLink(PointInterpolated const&, PointInterpolated const&, real len, real weight);
+    
+    /// enter all interactions into the Meca
+    void apply(Meca&) const;
+};
+
+
 /// Divide-and-Conquer to implement steric interactions
 /**
  A divide-and-conquer algorithm is used to find FatPoints that overlap:
@@ -174,6 +231,12 @@ public:
  - Function setStericInteraction() uses mGrid to find pairs of FatPoints that may overlap.
  It then calculates their actual distance, and set a interaction from Meca if necessary
  .
+ 
+ If the ThreadPool of the Meca has more than one thread, the cells are distributed
+ in contiguous slices of similar content, one for each thread.
+ Each thread records its interactions in its own StericLinks, and these are entered into
+ the Meca sequentially, in the order of the slices. The interactions are thus entered
+ in the same order as with one thread, and the results are identical.
 */
 class PointGrid
 {
@@ -185,22 +248,43 @@ private:
     /// max radius that can be included
     real max_diameter;
     
+    /// one buffer for each thread, used by setInteractions()
+    mutable StericLinks * buffers;
+    
+    /// number of buffers
+    mutable unsigned nbBuffers;
+    
+    /// first cell of the slice handled by each thread, and nbCells()
+    mutable Array<unsigned> slices;
+    
 private:
     
     /// check two Spheres
-    void checkPP(Meca&, PointGridParam const& pam, FatPoint const&, FatPoint const&) const;
+    template < typename MECA >
+    void checkPP(MECA&, PointGridParam const& pam, FatPoint const&, FatPoint const&) const;
     
     /// check Sphere against Line segment
-    void checkPL(Meca&, PointGridParam const& pam, FatPoint const&, FatLocus const&) const;
+    template < typename MECA >
+    void checkPL(MECA&, PointGridParam const& pam, FatPoint const&, FatLocus const&) const;
     
     /// check Line segment against Sphere
-    void checkLL1(Meca&, PointGridParam const& pam, FatLocus const&, FatLocus const&) const;
+    template < typename MECA >
+    void checkLL1(MECA&, PointGridParam const& pam, FatLocus const&, FatLocus const&) const;
     
     /// check Line segment against Sphere
-    void checkLL2(Meca&, PointGridParam const& pam, FatLocus const&, FatLocus const&) const;
+    template < typename MECA >
+    void checkLL2(MECA&, PointGridParam const& pam, FatLocus const&, FatLocus const&) const;
     
     /// check two Line segments
-    void checkLL(Meca&, PointGridParam const& pam, FatLocus const&, FatLocus const&) const;
+    template < typename MECA >
+    void checkLL(MECA&, PointGridParam const& pam, FatLocus const&, FatLocus const&) const;
+    
+    /// check all pairs of objects involving the cells in [start, stop[
+    template < typename MECA >
+    void checkCells(MECA&, PointGridParam const& pam, unsigned start, unsigned stop) const;
+    
+    /// job executed by the threads in setInteractions()
+    static void checkSlice(void * arg, unsigned rank, unsigned size);
 
     
     /// cell corresponding to position `w`
@@ -233,7 +317,7 @@ public:
     PointGrid();
     
     /// destructor
-    virtual ~PointGrid()    { }
+    virtual ~PointGrid()    { delete[] buffers; }
     
     /// create a grid to cover the specified Space, with cell of size min_step at least
     void setGrid(Space const*, Modulo const*, real min_step);
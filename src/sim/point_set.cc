@@ -337,8 +337,13 @@ void PointSet::foldPosition( const Modulo * s )
 void PointSet::write(OutputWrapper& out) const
 {
     out.writeUInt16(psSize);
-    for ( unsigned int p = 0; p < psSize ; ++p )
-        out.writeFloatVector(psPos+DIM*p, DIM, '\n');
+    if ( out.binary() && out.quantum() > 0 )
+        out.writeDeltaVector(psPos, psSize, DIM);
+    else
+    {
+        for ( unsigned int p = 0; p < psSize ; ++p )
+            out.writeFloatVector(psPos+DIM*p, DIM, '\n');
+    }
 }
 
 
@@ -353,12 +358,11 @@ void PointSet::read(InputWrapper & in, Simul&)
         resetPoints();
         
         psSize = nb;
-#if ( 1 )
-        for ( unsigned int p = 0; p < nb ; ++p )
-            in.readFloatVector(psPos+DIM*p, DIM);
-#else
-        in.readFloatVector(psPos, nb, DIM);
-#endif
+        // read all the coordinates at once:
+        if ( in.binary() && in.quantum() > 0 )
+            in.readDeltaVector(psPos, nb, DIM);
+        else
+            in.readFloatVector(psPos, nb, DIM);
     }
     catch( Exception & e ) {
         e << ", in PointSet::read()";
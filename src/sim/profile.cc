@@ -0,0 +1,72 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "profile.h"
+#include <time.h>
+
+
+double Profile::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+const char * Profile::name(Phase p)
+{
+    switch ( p )
+    {
+        case MIX:          return "mix";
+        case OBJECTS:      return "objects";
+        case FIBERS:       return "fibers";
+        case GRID:         return "grid";
+        case COUPLES:      return "couples";
+        case SINGLES:      return "singles";
+        case INTERACTIONS: return "interact";
+        case MATRIX:       return "matrix";
+        case FORCES:       return "forces";
+        case PRECONDITION: return "precond";
+        case SOLVER:       return "solver";
+        case WRITE:        return "write";
+        default:           return "?";
+    }
+}
+
+
+void Profile::clear()
+{
+    for ( int p = 0; p < NB_PHASES; ++p )
+    {
+        time[p] = 0;
+        calls[p] = 0;
+    }
+    for ( int c = 0; c < NB_COUNTERS; ++c )
+        count[c] = 0;
+}
+
+
+/**
+ The times are given in milli-seconds, and the number of steps is the number
+ of times that the first phase was timed.
+ */
+void Profile::writeHeader(FILE * file) const
+{
+    fprintf(file, "%% frame      time  steps  solves   iters   elements    hands");
+    for ( int p = 0; p < NB_PHASES; ++p )
+        fprintf(file, " %9s", name((Phase)p));
+    fprintf(file, "     total\n");
+}
+
+
+void Profile::write(FILE * file, int frame, double stime) const
+{
+    fprintf(file, "%7i %9.3f %6lu %7lu %7lu %10lu %8lu", frame, stime, calls[MIX],
+            calls[SOLVER], count[ITERATIONS], count[ELEMENTS], count[HANDS]);
+    double sum = 0;
+    for ( int p = 0; p < NB_PHASES; ++p )
+    {
+        fprintf(file, " %9.2f", 1000 * time[p]);
+        sum += time[p];
+    }
+    fprintf(file, " %9.2f\n", 1000 * sum);
+}
@@ -0,0 +1,133 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstdio>
+
+
+/// Accumulates the wall-time spent in the different phases of a time step
+/**
+ The time is measured with a monotonic clock, between successive calls to toc(),
+ such that a sequence of phases can be timed with a single reading of the clock
+ for each phase:
+
+     profile.tic();
+     ...
+     profile.toc(Profile::MIX);
+     ...
+     profile.toc(Profile::FIBERS);
+
+ The clock is not read if the Profile is disabled, and the cost is then limited
+ to testing a flag.
+ Counters record other quantities, such as the number of iterations of the solver.
+
+ The values accumulated since the last call to clear() can be written on one line,
+ with write(), for example at every frame of the simulation (see @ref SimulPar).
+ */
+class Profile
+{
+public:
+
+    /// phases of the calculation
+    enum Phase
+    {
+        MIX,           ///< Simul::step(): shuffling the lists of objects
+        OBJECTS,       ///< Simul::step(): Space, Field, Organizer, Sphere, Bead and Solid
+        FIBERS,        ///< Simul::step(): Fiber
+        GRID,          ///< Simul::step(): painting the FiberGrid used for attachment
+        COUPLES,       ///< Simul::step(): Couple
+        SINGLES,       ///< Simul::step(): Single
+        INTERACTIONS,  ///< Simul::setInteractions(): filling the matrices of Meca
+        MATRIX,        ///< Meca::solve(): prepareForMultiply()
+        FORCES,        ///< Meca::solve(): forces, right-hand side and export of the results
+        PRECONDITION,  ///< Meca::solve(): calculation of the preconditioner
+        SOLVER,        ///< Meca::solve(): iterations of the solver
+        WRITE,         ///< writing trajectory frames
+        NB_PHASES
+    };
+
+    /// quantities that are counted
+    enum Counter
+    {
+        ITERATIONS,    ///< total number of iterations made by the solver
+        ELEMENTS,      ///< number of elements in the matrices, at the last solve
+        HANDS,         ///< number of attached Hands, when the profile is written
+        NB_COUNTERS
+    };
+
+private:
+
+    /// true if the times should be recorded
+    bool          on;
+
+    /// time of the last call to tic() or toc()
+    double        mark;
+
+    /// time spent in each phase, in seconds
+    double        time[NB_PHASES];
+
+    /// number of times each phase was timed
+    unsigned long calls[NB_PHASES];
+
+    /// values of the counters
+    unsigned long count[NB_COUNTERS];
+
+public:
+
+    /// the constructor creates a disabled Profile
+    Profile() : on(false), mark(0) { clear(); }
+
+    /// current time in seconds, from a monotonic clock
+    static double now();
+
+    /// name of a phase
+    static const char * name(Phase);
+
+    /// enable or disable the recording of times
+    void enable(bool b)  { on = b; }
+
+    /// true if times are recorded
+    bool enabled() const { return on; }
+
+    /// reset all times and counters
+    void clear();
+
+    /// start timing
+    void tic()           { if ( on ) mark = now(); }
+
+    /// attribute the time elapsed since the last tic() or toc() to phase `p`
+    void toc(Phase p)
+    {
+        if ( on )
+        {
+            double t = now();
+            time[p] += t - mark;
+            ++calls[p];
+            mark = t;
+        }
+    }
+
+    /// add `n` to counter `c`
+    void add(Counter c, unsigned long n)  { if ( on ) count[c] += n; }
+
+    /// set counter `c` to `n`
+    void set(Counter c, unsigned long n)  { if ( on ) count[c] = n; }
+    
+    /// time spent in phase `p`, in seconds
+    double seconds(Phase p)   const { return time[p]; }
+    
+    /// number of times phase `p` was timed
+    unsigned long nbCalls(Phase p) const { return calls[p]; }
+    
+    /// value of counter `c`
+    unsigned long counter(Counter c) const { return count[c]; }
+
+    /// write a line with the names of the columns
+    void writeHeader(FILE *) const;
+
+    /// write the times and counters on one line, starting with `frame` and `time`
+    void write(FILE *, int frame, double time) const;
+};
+
+#endif
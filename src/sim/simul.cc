@@ -15,6 +15,7 @@ extern Modulo * modulo;
 #include "simul_file.cc"
 #include "simul_custom.cc"
 #include "simul_report.cc"
+#include "simul_table.cc"
 #include "simul_solve.cc"
 
 #include "nucleus.h"
@@ -72,8 +73,12 @@ singles(*this), couples(*this), organizers(*this)
     sTime         = 0;
     sReady        = 0;
     sSpace        = 0;
+    sPrimary      = true;
+    sCreating     = 0;
+    sCreatingArg  = 0;
     prop          = new SimulProp("undefined", this);
     prop->index(0);
+    sMeca.setProfile(&sProfile);
 }
 
 Simul::~Simul()
@@ -90,28 +95,46 @@ Simul::~Simul()
 //------------------------------------------------------------------------------
 #pragma mark -
 
+/**
+ A copy of the simulation, for example the one used for display while the primary
+ simulation is running in another thread, shares the global variables with it.
+ It must not modify them: it does not set `modulo`, and it calls `func(arg)`
+ before creating an object, since the constructors of some objects use `RNG`.
+ */
+void Simul::secondary(void (*func)(void*), void * arg)
+{
+    sPrimary     = false;
+    sCreating    = func;
+    sCreatingArg = arg;
+}
+
+
 /**
  set current Space to \a spc. (zero is a valid argument).
  
  This also set the space of all objects to \a spc.
+ The global `modulo` is only changed by the primary simulation.
  */
 void Simul::space(Space * spc)
 {
     //std::cerr << "Simul::space(" << spc << ")\n";
     sSpace = spc;
 
-    if ( modulo )
-    {
-        // modulo is a copy of a Space, and deletion is handled elsewhere
-        modulo = 0;
-    }
-    
     if ( fiberGrid.hasGrid() )
         fiberGrid.clear();
     
     if ( stericGrid.hasGrid() )
         stericGrid.clear();
     
+    if ( !sPrimary )
+        return;
+
+    if ( modulo )
+    {
+        // modulo is a copy of a Space, and deletion is handled elsewhere
+        modulo = 0;
+    }
+    
     if ( spc )
     {
         if ( spc->prop->shape == "periodic" ) 
@@ -194,6 +217,7 @@ void Simul::prepare(Space * spc)
     fields.prepare();
     
     couples.prepare(properties);
+    singles.prepare(properties);
 
     sReady = true;
 }
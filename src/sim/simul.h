@@ -24,9 +24,14 @@
 #include "field_values.h"
 #include "field.h"
 #include "meca.h"
+#include "background_writer.h"
+#include "frame_digest.h"
+#include "profile.h"
 
 
 
+class ColumnTable;
+
 /// the string that defines the start of a frame
 const static char FRAME_TAG[] = "#Cytosim ";
 
@@ -45,6 +50,15 @@ private:
     /// the last Space defined in the simulation
     Space *            sSpace;
     
+    /// false for a copy of the simulation, which must not change the global variables
+    bool               sPrimary;
+    
+    /// function called by a copy before it creates an object, with argument `sCreatingArg`
+    void            (* sCreating)(void*);
+    
+    /// argument given to `sCreating`
+    void *             sCreatingArg;
+    
     /// The Meca used to set and integrate the equations of motion
     mutable Meca       sMeca;
     
@@ -58,6 +72,18 @@ private:
     
     /// a copy of the properties that were stored to file
     mutable std::string properties_saved;
+    
+    /// thread used to write trajectory frames asynchronously
+    mutable BackgroundWriter sWriter;
+    
+    /// digests of the objects in the last frame written to the trajectory
+    mutable FrameDigest sDigest;
+    
+    /// time spent in the different phases of the calculation
+    mutable Profile    sProfile;
+    
+    /// write all objects if `key`, or only those that have changed since the last frame
+    void      writeFrame(OutputWrapper&, bool key) const;
    
 public:
 
@@ -152,7 +178,7 @@ public:
     bool      isReady() const { return sReady; }
     
     /// call after a sequence of step() have been done
-    void      relax() { couples.relax(); }
+    void      relax() { couples.relax(); singles.relax(); }
     
     /// set current Space
     void      space(Space * spc);
@@ -160,6 +186,15 @@ public:
     /// get current Space
     Space *   space() const { return sSpace; }
     
+    /// make this a copy, which does not set `modulo` and calls `func(arg)` before creating an object
+    void      secondary(void (*func)(void*), void * arg);
+    
+    /// false for a copy made with secondary()
+    bool      primary() const { return sPrimary; }
+    
+    /// called before an object is created while reading
+    void      creating() const { if ( sCreating ) sCreating(sCreatingArg); }
+    
     /// return first Space with this name
     Space *   findSpace(const std::string& name) const;
 
@@ -180,6 +215,9 @@ public:
     /// dump matrix and vector from Meca
     void      dump() const { sMeca.dump(); }
     
+    /// threads shared by Meca and the parallel steps of CoupleSet and SingleSet
+    ThreadPool& threadPool() const { return sMeca.threadPool(); }
+    
     //-------------------------------------------------------------------------------
     
     /// call setInteractions(meca) for all objects
@@ -267,8 +305,26 @@ public:
     /// write simulation-state to specified file
     void      writeObjects(OutputWrapper&) const;
     
-    /// write simulation-state in binary or text mode, appending to the file or not
-    void      writeObjects(std::string const& file, bool binary, bool append) const;
+    /// write simulation-state in binary or text mode, appending to the file or not, compressing coordinates if `quantum > 0`
+    void      writeObjects(std::string const& file, bool binary, bool append, real quantum = 0, unsigned keyframe = 0) const;
+    
+    /// write simulation-state to memory, and save it to file from a separate thread
+    void      writeObjectsAsync(std::string const& file, bool binary, bool append, real quantum = 0, unsigned keyframe = 0) const;
+    
+    /// wait until the frames given to writeObjectsAsync() have been written
+    void      flushObjects() const;
+    
+    /// write all objects and the variables needed to continue the simulation exactly, and reload them
+    void      writeCheckpoint(FILE*);
+    
+    /// restore the state written by writeCheckpoint(), from memory
+    void      readCheckpoint(const char * data, size_t size);
+    
+    /// the record of the time spent in the different phases of the calculation
+    Profile&  profile() const { return sProfile; }
+    
+    /// write the Profile accumulated since the last call, on one line
+    void      writeProfile(FILE*, int frame) const;
     
     //-------------------------------------------------------------------------------
     
@@ -278,6 +334,9 @@ public:
     /// call one of the report function
     void      report0(std::ostream&, std::string const&, Glossary&) const;
     
+    /// fill a table with the data of a report, for output in binary format
+    void      report(ColumnTable&, std::string const&, Glossary&) const;
+    
     /// print time
     void      reportTime(std::ostream&) const;
    
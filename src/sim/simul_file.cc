@@ -6,6 +6,10 @@
 #include "tictoc.h"
 #include "iowrapper.h"
 #include "messages.h"
+#include "frame_index.h"
+#include "random.h"
+
+extern Random RNG;
 
 /// Current format version number used for writing object-files.
 /**
@@ -149,6 +153,10 @@ int Simul::loadObjects(InputWrapper & in)
  When the read is complete, the objects that are still on 'ice' are deleted.
  In this way the new state reflects exactly the system that was read from file.
  
+ If the frame only contains the objects that have changed (see writeFrame),
+ the objects that are still on 'ice' are kept, and the positions of the binders
+ are updated, since the fibers might have changed.
+ 
  @returns
  - 0 = success
  - 1 = EOF
@@ -176,12 +184,21 @@ int Simul::reloadObjects(InputWrapper & in)
     
     // flag to erase the older objects
     bool erase = true;
+    bool delta = false;
     
     try
     {
-        if ( readObjects(in) == 0 )
+        int res = readObjects(in);
+        
+        if ( res == 0 )
             erase = false;
         
+        if ( res == 3 )
+        {
+            erase = false;
+            delta = true;
+        }
+        
         in.unlock();
         
         /*
@@ -200,6 +217,15 @@ int Simul::reloadObjects(InputWrapper & in)
         fibers.thaw(erase);
         spaces.thaw(erase);
         fields.thaw(erase);
+        
+        if ( delta )
+        {
+            for ( Fiber * fib = fibers.first(); fib; fib = fib->next() )
+            {
+                for ( FiberBinder * fb = fib->firstBinder(); fb; fb = fb->next() )
+                    fb->updateBinder();
+            }
+        }
     }
     catch(Exception & e)
     {
@@ -236,10 +262,12 @@ int Simul::reloadObjects(InputWrapper & in)
  0 : no sign of a cytosim frame was found
  1 : a frame starting tag (FRAME_TAG) was found, but not the end
  2 : the frame starting and end tags were found
+ 3 : a frame that only contains the objects that have changed was read completely
  */
 int Simul::readObjects(InputWrapper & in)
 {
     int res = 0;
+    bool delta = false;
     char c = '\n', tag, pretag;
     std::string line;
     
@@ -284,6 +312,7 @@ int Simul::readObjects(InputWrapper & in)
                 else {
                     if ( tag!='i'  &&  ( tag!='m' || in.formatID()!=31 ))
                         pi = in.readUInt16();
+                    creating();
                     w = set->newObjectT(tolower(tag), pi);
                     w->number(n);
                     w->read(in, *this);
@@ -319,6 +348,10 @@ int Simul::readObjects(InputWrapper & in)
             //detect frame start
             if ( 0 == line.compare(0, sizeof(FRAME_TAG)-2, 1+FRAME_TAG) )
             {
+                // coordinates are not compressed, unless specified:
+                in.quantum(0);
+                in.doublePrecision(false);
+                delta = false;
                 res = 1;
                 continue;
             }
@@ -366,6 +399,46 @@ int Simul::readObjects(InputWrapper & in)
                 continue;
             }
             
+            //frame containing only the objects that have changed
+            if ( 0 == line.compare(0, 5, "delta") )
+            {
+                delta = true;
+                continue;
+            }
+            
+            //object that was deleted since the previous frame
+            if ( 0 == line.compare(0, 7, "delete ") )
+            {
+                char t = 0;
+                Number n = 0;
+                if ( 2 == sscanf(line.c_str(), "delete %c %lu", &t, &n) )
+                {
+                    ObjectSet * set = findSet(t);
+                    Object * obj = set ? set->find(n) : 0;
+                    if ( obj )
+                    {
+                        // the object may be on 'ice', and is first put back in a normal list:
+                        set->relink(obj);
+                        set->erase(obj);
+                    }
+                }
+                continue;
+            }
+            
+            //precision of compressed coordinates
+            if ( 0 == line.compare(0, 8, "quantum ") )
+            {
+                in.quantum(strtod(line.c_str()+8, 0));
+                continue;
+            }
+            
+            //floating-point values stored on 8 bytes
+            if ( 0 == line.compare(0, 6, "double") )
+            {
+                in.doublePrecision(true);
+                continue;
+            }
+            
             //binary signature
             if ( 0 == line.compare(0, 7, "binary ") )
             {
@@ -375,11 +448,11 @@ int Simul::readObjects(InputWrapper & in)
            
             //detect the mark at the end of the frame
             if ( 0 == line.compare(0, 10, "end frame ") )
-                return 2;
+                return delta ? 3 : 2;
             
             //detect the mark at the end of the frame
             if ( 0 == line.compare(0, 12, "end cytosim ") )
-                return 2;
+                return delta ? 3 : 2;
             
             continue;
         }
@@ -417,6 +490,14 @@ void Simul::writeObjects(OutputWrapper & out) const
     // record the simulated time:
     fprintf(out, "\n#time %.6f, dim %i, format %i", simTime(), DIM, currentFormatID);
     
+    // record the precision of compressed coordinates:
+    if ( out.binary() && out.quantum() > 0 )
+        fprintf(out, "\n#quantum %.9g", out.quantum());
+    
+    // record that floating-point values are not rounded:
+    if ( out.binary() && out.doublePrecision() )
+        fprintf(out, "\n#double");
+    
     // record a signature to identify binary file, and endianess:
     if ( out.binary() )
         out.writeBinarySignature("\n#binary ");
@@ -488,26 +569,431 @@ void Simul::writeObjects(OutputWrapper & out) const
 
 
 
+/// used to collect all the objects of an ObjectSet
+static bool match_all(Object const*, void*)
+{
+    return true;
+}
+
+
+/**
+ Every object is first formatted in memory, and its bytes are compared with those
+ of the previous frame, using the digests recorded in `sDigest`.
+ If `key == false`, only the objects that have changed are written,
+ and the frame is marked with a line `#delta`.
+ The objects that have disappeared since the previous frame are listed on lines
+ `#delete TAG NUMBER`, before the first section.
+ 
+ The frame can only be read after the previous frames, starting from a keyframe,
+ and the objects of a delta frame may be stored in a different order.
+ */
+void Simul::writeFrame(OutputWrapper & out, bool key) const
+{
+    if ( ! out.good() )
+        throw InvalidIO("output file is invalid");
+    
+    char * data = 0;
+    size_t size = 0;
+    
+    FILE * mem = open_memstream(&data, &size);
+    if ( !mem )
+        throw InvalidIO("could not allocate memory");
+
+    const int nbSets = 9;
+    const ObjectSet * sets[nbSets] = { &spaces, &fields, &fibers, &solids, &beads, &spheres, &singles, &couples, &organizers };
+    const char * names[nbSets] = { "space", "field", "fiber", "solid", "bead", "sphere", "single", "couple", "organizer" };
+    
+    // format all objects, recording where each one starts and ends:
+    ObjectList objs[nbSets];
+    std::vector<size_t> edges[nbSets];
+    try {
+        OutputWrapper tmp(mem, out.binary());
+        tmp.quantum(out.quantum());
+        for ( int s = 0; s < nbSets; ++s )
+        {
+            objs[s] = sets[s]->collect(match_all, 0);
+            edges[s].resize(objs[s].size()+1);
+            edges[s][0] = ftello(tmp);
+            for ( unsigned i = 0; i < objs[s].size(); ++i )
+            {
+                Object const* o = objs[s][i];
+                tmp.write('\n');
+                o->writeReference(tmp);
+                o->write(tmp);
+                edges[s][i+1] = ftello(tmp);
+            }
+        }
+        tmp.close();
+    }
+    catch( Exception & ) {
+        free(data);
+        sDigest.clear();
+        throw;
+    }
+    
+    // select the objects that have changed:
+    std::vector<unsigned> picks[nbSets];
+    for ( int s = 0; s < nbSets; ++s )
+    {
+        for ( unsigned i = 0; i < objs[s].size(); ++i )
+        {
+            Object const* o = objs[s][i];
+            size_t a = edges[s][i], b = edges[s][i+1];
+            if ( sDigest.update(o->tag(), o->number(), data+a, b-a) || key )
+                picks[s].push_back(i);
+        }
+    }
+    
+    std::vector<FrameDigest::Key> gone;
+    sDigest.purge(gone);
+    
+    char date[26] = { 0 };
+    TicToc::date(date, sizeof(date));
+    
+    out.lock();
+    fprintf(out, "\n\n%s %s", FRAME_TAG, date);
+    fprintf(out, "\n#time %.6f, dim %i, format %i", simTime(), DIM, currentFormatID);
+    
+    // this line must follow the time, see FrameIndex::build()
+    if ( !key )
+        fprintf(out, "\n#delta");
+    
+    if ( out.binary() && out.quantum() > 0 )
+        fprintf(out, "\n#quantum %.9g", out.quantum());
+    
+    if ( out.binary() )
+        out.writeBinarySignature("\n#binary ");
+    
+    // objects are deleted in the same order as in reloadObjects():
+    const ObjectSet * order[nbSets] = { &organizers, &couples, &singles, &beads, &solids, &spheres, &fibers, &spaces, &fields };
+    for ( int s = 0; s < nbSets; ++s )
+    {
+        for ( unsigned i = 0; i < gone.size(); ++i )
+        {
+            if ( const_cast<Simul*>(this)->findSet(gone[i].first) == order[s] )
+                fprintf(out, "\n#delete %c %lu", gone[i].first, gone[i].second);
+        }
+    }
+    
+    for ( int s = 0; s < nbSets; ++s )
+    {
+        if ( picks[s].size() )
+        {
+            fprintf(out, "\n#section %s", names[s]);
+            for ( unsigned n = 0; n < picks[s].size(); ++n )
+            {
+                unsigned i = picks[s][n];
+                fwrite(data+edges[s][i], 1, edges[s][i+1]-edges[s][i], out);
+            }
+        }
+    }
+    
+    out.put_line("\n#section end");
+    fprintf(out, "\n#end cytosim %s\n\n", date);
+    out.unlock();
+    free(data);
+}
+
+
 /**
  This appends the current state to a trajectory file.
  Normally, this is objects.cmo in the current directory.
  
  If the file does not exist, it is created de novo.
+ The position of the frame is also recorded in the index file (see FrameIndex).
+ 
+ In binary mode, if `quantum > 0`, the coordinates of the points of the Fibers are
+ rounded to multiples of `quantum` and written as differences between consecutive
+ points, using a variable number of bytes (see OutputWrapper::writeDeltaVector).
+ 
+ If `keyframe > 1`, a complete frame is written only every `keyframe` frames,
+ and the other frames only contain the objects that have changed (see writeFrame).
 */
-void Simul::writeObjects(std::string const& file, bool binary, bool append) const
+void Simul::writeObjects(std::string const& file, bool binary, bool append, real quantum, unsigned keyframe) const
 {
+    // frames given to writeObjectsAsync() should be written first:
+    flushObjects();
+    
+    bool key = true;
+    if ( keyframe > 1 )
+        key = sDigest.start(file, append, keyframe);
+    
+    // the frame tag is written after two newlines:
+    FrameIndex::record(file, append, 2, simTime(), key);
+
     try {
 
         OutputWrapper out(file.c_str(), append, binary);
-        writeObjects(out);
+        out.quantum(quantum);
+        if ( keyframe > 1 )
+            writeFrame(out, key);
+        else
+            writeObjects(out);
         
     }
     catch( InvalidIO & e ) {
         std::cerr << "Error writing trajectory file `"<< file <<"':" << e.what() << std::endl;
+        sDigest.clear();
     }
 }
 
 
+/**
+ The frame is formatted in memory, and the buffer is handed to a separate thread,
+ which writes it to file while the simulation continues.
+ Only one frame can be pending, and this will wait if the previous frame is not yet written.
+ The file is identical to the one produced by writeObjects().
+ */
+void Simul::writeObjectsAsync(std::string const& file, bool binary, bool append, real quantum, unsigned keyframe) const
+{
+    char * data = 0;
+    size_t size = 0;
+    
+    FILE * mem = open_memstream(&data, &size);
+    if ( !mem )
+    {
+        writeObjects(file, binary, append, quantum, keyframe);
+        return;
+    }
+    
+    bool key = true;
+    if ( keyframe > 1 )
+        key = sDigest.start(file, append, keyframe);
+
+    try {
+        
+        OutputWrapper out(mem, binary, file.c_str());
+        out.quantum(quantum);
+        if ( keyframe > 1 )
+            writeFrame(out, key);
+        else
+            writeObjects(out);
+        out.close();
+        
+    }
+    catch( InvalidIO & e ) {
+        std::cerr << "Error writing trajectory file `"<< file <<"':" << e.what() << std::endl;
+        sDigest.clear();
+        free(data);
+        return;
+    }
+    
+    flushObjects();
+    FrameIndex::record(file, append, 2, simTime(), key);
+    
+    try {
+        
+        sWriter.write(file, append, data, size);
+        
+    }
+    catch( InvalidIO & e ) {
+        std::cerr << "Error writing trajectory file `"<< file <<"':" << e.what() << std::endl;
+        sDigest.clear();
+    }
+}
+
+
+void Simul::flushObjects() const
+{
+    try {
+        
+        sWriter.wait();
+        
+    }
+    catch( InvalidIO & e ) {
+        std::cerr << "Error writing trajectory file:" << e.what() << std::endl;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Checkpoint
+
+/// write `size` bytes from `data`, preceded by their number
+static void writeBlock(FILE * file, const void * data, uint64_t size)
+{
+    if ( 1 != fwrite(&size, sizeof(size), 1, file) )
+        throw InvalidIO("could not write checkpoint");
+    if ( size > 0 && 1 != fwrite(data, size, 1, file) )
+        throw InvalidIO("could not write checkpoint");
+}
+
+
+/// read a block written by writeBlock(), from memory, advancing `ptr`
+static const char * readBlock(const char *& ptr, const char * end, uint64_t& size)
+{
+    if ( end - ptr < (long)sizeof(size) )
+        throw InvalidIO("truncated checkpoint");
+    memcpy(&size, ptr, sizeof(size));
+    ptr += sizeof(size);
+    if ( (uint64_t)(end - ptr) < size )
+        throw InvalidIO("truncated checkpoint");
+    const char * res = ptr;
+    ptr += size;
+    return res;
+}
+
+
+/**
+ A checkpoint contains three blocks, each preceded by its size in bytes:
+ - the state of the random number generator,
+ - a frame with all the objects, in which floating-point values are not rounded,
+ - the variables of the objects that are not saved in frames (see Object::writeState),
+   for example the Gillespie times of the Hands, or the initial guess of the solver.
+ .
+ 
+ After writing, the simulation is reloaded from the checkpoint data, and the data
+ that is carried from one time step to the next to save time, and that can be
+ recalculated, is discarded: the preconditioner, the attachment grid, the generators
+ used to attach in parallel and the digests of the objects (see writeFrame).
+ In this way, the continuation does not depend on whether the simulation was restarted,
+ even for the cached values that are not saved, such as the interpolation
+ coefficients of the attached Hands.
+ */
+void Simul::writeCheckpoint(FILE * output)
+{
+    relax();
+    
+    char * all = 0;
+    size_t all_size = 0;
+    FILE * file = open_memstream(&all, &all_size);
+    if ( !file )
+        throw InvalidIO("could not allocate memory");
+    
+    char * data = 0;
+    size_t size = 0;
+    
+    // `file` and `all` are released below, also if an exception is thrown:
+    try {
+        std::vector<char> rng(Random::stateSize());
+        RNG.saveState(&rng[0]);
+        writeBlock(file, &rng[0], rng.size());
+        
+        FILE * mem = open_memstream(&data, &size);
+        if ( !mem )
+            throw InvalidIO("could not allocate memory");
+        {
+            OutputWrapper out(mem, true);
+            out.doublePrecision(true);
+            writeObjects(out);
+            out.close();
+        }
+        writeBlock(file, data, size);
+        free(data);
+        data = 0;
+        
+        const int nbSets = 9;
+        ObjectSet * sets[nbSets] = { &spaces, &fields, &fibers, &solids, &beads, &spheres, &singles, &couples, &organizers };
+        
+        mem = open_memstream(&data, &size);
+        if ( !mem )
+            throw InvalidIO("could not allocate memory");
+        {
+            OutputWrapper out(mem, true);
+            out.writeBinarySignature("");
+            out.writeDouble(sTime);
+            for ( int s = 0; s < nbSets; ++s )
+            {
+                ObjectList objs = sets[s]->collect(match_all, 0);
+                out.writeUInt32(objs.size());
+                for ( unsigned i = 0; i < objs.size(); ++i )
+                {
+                    out.writeUInt32(objs[i]->number());
+                    objs[i]->writeState(out);
+                }
+            }
+            out.close();
+        }
+        writeBlock(file, data, size);
+        free(data);
+        data = 0;
+        
+        fclose(file);
+        file = 0;
+        
+        if ( 1 != fwrite(all, all_size, 1, output) )
+            throw InvalidIO("could not write checkpoint");
+        readCheckpoint(all, all_size);
+    }
+    catch( Exception & ) {
+        free(data);
+        if ( file )
+            fclose(file);
+        free(all);
+        throw;
+    }
+    free(all);
+    
+    sMeca.renewPreconditioner();
+    fiberGrid.clear();
+    couples.resetSweep();
+    singles.resetSweep();
+}
+
+
+/**
+ This restores the state saved by writeCheckpoint(), from memory.
+ The objects that are not in the checkpoint are deleted.
+ */
+void Simul::readCheckpoint(const char * data, size_t size)
+{
+    const char * ptr = data, * end = data + size;
+    uint64_t len = 0;
+    
+    const char * rng = readBlock(ptr, end, len);
+    if ( len != Random::stateSize() )
+        throw InvalidIO("incompatible random number generator in checkpoint");
+    
+    const char * frm = readBlock(ptr, end, len);
+    FILE * mem = fmemopen(const_cast<char*>(frm), len, "rb");
+    if ( !mem )
+        throw InvalidIO("could not read checkpoint");
+    {
+        InputWrapper in(mem);
+        // an empty or truncated frame would leave the current objects unchanged:
+        if ( 0 != reloadObjects(in) )
+            throw InvalidIO("incomplete checkpoint");
+    }
+    
+    const int nbSets = 9;
+    ObjectSet * sets[nbSets] = { &spaces, &fields, &fibers, &solids, &beads, &spheres, &singles, &couples, &organizers };
+    
+    const char * var = readBlock(ptr, end, len);
+    mem = fmemopen(const_cast<char*>(var), len, "rb");
+    if ( !mem )
+        throw InvalidIO("could not read checkpoint");
+    {
+        InputWrapper in(mem);
+        char sig[2] = { 0 };
+        sig[0] = in.getUL();
+        sig[1] = in.getUL();
+        in.getUL();
+        in.setBinarySwap(sig);
+        if ( in.binary() != 1 )
+            throw InvalidIO("checkpoint was written with a different byte order");
+        
+        real time = in.readDouble();
+        for ( int s = 0; s < nbSets; ++s )
+        {
+            const unsigned cnt = in.readUInt32();
+            for ( unsigned i = 0; i < cnt; ++i )
+            {
+                Number n = in.readUInt32();
+                Object * obj = sets[s]->find(n);
+                if ( !obj )
+                    throw InvalidIO("unknown object in checkpoint");
+                obj->readState(in);
+            }
+        }
+        setTime(time);
+    }
+    
+    // creating the objects used the generator, which is restored last:
+    RNG.loadState(rng);
+    sDigest.clear();
+}
+
+
 //------------------------------------------------------------------------------
 #pragma mark -
 
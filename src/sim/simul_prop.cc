@@ -26,6 +26,12 @@ void SimulProp::clear()
     tolerance         = 0.05;
     acceptable_rate   = 0.5;
     precondition      = 1;
+    precondition_lifetime = 0;
+    precondition_drift    = 0.1;
+    warm_start        = false;
+    solver            = SOLVER_BICGSTAB;
+    solver_dim        = 8;
+    threads           = 1;
     random_seed       = 0;
     steric            = 0;
  
@@ -36,6 +42,9 @@ void SimulProp::clear()
 
     steric_max_range  = -1;
     binding_grid_step = -1;
+    binding_grid_skin = 0;
+    binding_grid_compact = false;
+    free_arrays       = false;
     
     strict            = 0;
     verbose           = 0;
@@ -44,6 +53,8 @@ void SimulProp::clear()
     trajectory_file   = "objects.cmo";
     property_file     = "properties.cmo";
     append_file       = false;
+    profile           = false;
+    profile_file      = "profile.txt";
     
     display           = "";
     display_fresh     = false;
@@ -62,6 +73,18 @@ void SimulProp::read(Glossary& glos)
     glos.set(tolerance,         "tolerance");
     glos.set(acceptable_rate,   "acceptable_rate");
     glos.set(precondition,      "precondition");
+    glos.set(precondition_lifetime, "precondition_lifetime");
+    glos.set(precondition_drift,    "precondition_drift");
+    glos.set(warm_start,        "warm_start");
+    // the default dimension depends on the method:
+    if ( glos.set(solver,       "solver",
+             KeyList<int>("bicgstab",           SOLVER_BICGSTAB,
+                          "gmres",              SOLVER_GMRES,
+                          "idrs",               SOLVER_IDRS,
+                          "pipelined_bicgstab", SOLVER_PIPELINED_BICGSTAB)) )
+        solver_dim = ( solver == SOLVER_GMRES ) ? 30 : 8;
+    glos.set(solver_dim,        "solver", 1);
+    glos.set(threads,           "threads");
     
     glos.set(steric,                   "steric");
     glos.set(steric_stiffness_push[0], "steric", 1);
@@ -71,6 +94,9 @@ void SimulProp::read(Glossary& glos)
     glos.set(steric_max_range,         "steric_max_range");
 
     glos.set(binding_grid_step, "binding_grid_step");
+    glos.set(binding_grid_skin, "binding_grid_skin");
+    glos.set(binding_grid_compact, "binding_grid_compact");
+    glos.set(free_arrays,       "free_arrays");
 
     // these parameters are not written:
     glos.set(strict,            "strict");
@@ -94,6 +120,8 @@ void SimulProp::read(Glossary& glos)
     glos.set(trajectory_file,   ".cmo");
     
     glos.set(append_file,       "append_file");
+    glos.set(profile,           "profile");
+    glos.set(profile_file,      "profile_file");
     
     real t;
     if ( glos.set(t, "time") )
@@ -123,6 +151,21 @@ void SimulProp::complete(SimulProp const* sp, PropertyList* plist)
         if ( kT <= 0 )
             throw InvalidParameter("simul:kT must be > 0");
 
+        if ( threads < 1 )
+            throw InvalidParameter("simul:threads must be >= 1");
+
+        if ( precondition_drift < 0 )
+            throw InvalidParameter("simul:precondition_drift must be >= 0");
+
+        if ( solver_dim < 1 )
+            throw InvalidParameter("simul:solver[1] must be >= 1");
+
+        if ( binding_grid_skin < 0 )
+            throw InvalidParameter("simul:binding_grid_skin must be >= 0");
+
+        if ( binding_grid_compact  &&  binding_grid_skin > 0 )
+            throw InvalidParameter("simul:binding_grid_compact cannot be used with binding_grid_skin > 0");
+
         // set a valid seed if necessary:
         if ( random_seed == 0 )
         {
@@ -153,11 +196,19 @@ void SimulProp::write_data(std::ostream & os) const
     write_param(os, "tolerance",       tolerance);
     write_param(os, "acceptable_rate", acceptable_rate);
     write_param(os, "precondition",    precondition);
+    write_param(os, "precondition_lifetime", precondition_lifetime);
+    write_param(os, "precondition_drift",    precondition_drift);
+    write_param(os, "warm_start",      warm_start);
+    write_param(os, "solver",          solver, solver_dim);
+    write_param(os, "threads",         threads);
     write_param(os, "random_seed",     random_seed);
     os << std::endl;
     write_param(os, "steric", steric, steric_stiffness_push[0], steric_stiffness_pull[0]);
     write_param(os, "steric_max_range",  steric_max_range);
     write_param(os, "binding_grid_step", binding_grid_step);
+    write_param(os, "binding_grid_skin", binding_grid_skin);
+    write_param(os, "binding_grid_compact", binding_grid_compact);
+    write_param(os, "free_arrays", free_arrays);
     write_param(os, "verbose", verbose);
     os << std::endl;
 
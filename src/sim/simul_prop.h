@@ -145,8 +145,103 @@ public:
      <em>default value = 1</em>
      */
     int       precondition;
+    
+    
+    /// Maximum number of time steps during which a block of the preconditioner is reused
+    /**
+     The preconditioner is made of one block for each Mecable, which is calculated
+     by LU factorization. A block can be reused at the next time step if:
+     - it is younger than \a precondition_lifetime,
+     - the number of points of the Mecable has not changed,
+     - the norm of the diagonal of the Mecable's matrix block has not changed by
+       more than \a precondition_drift, in relative terms.
+     .
+     All the blocks are recalculated if the solver needed more than twice as many
+     iterations as it did when the blocks were last all calculated,
+     or if \a time_step was changed.
+     With \a precondition_lifetime = 0, all the blocks are recalculated at every step.
+     
+     <em>default value = 0</em>
+     */
+    unsigned  precondition_lifetime;
+    
+    
+    /// Relative change in the diagonal of the matrix that triggers a recalculation of the preconditioner
+    /**
+     See \a precondition_lifetime.
+     
+     <em>default value = 0.1</em>
+     */
+    real      precondition_drift;
+    
+    
+    /// A flag to use the displacement of the previous step as initial guess for the solver
+    /**
+     If \a warm_start is true, each Mecable records its displacement, and this is
+     used to form the initial guess of the iterative solver at the next time step.
+     The guess is scaled to minimize the initial residual, such that it cannot be
+     worse than using zero. This reduces the number of iterations if the motion
+     is dominated by a slowly varying drift, rather than by Brownian motion.
+     
+     <em>default value = false</em>
+     */
+    bool      warm_start;
+    
+    
+    /// iterative methods that can be used to solve the system of equations
+    enum SolverMethod
+    {
+        SOLVER_BICGSTAB,            ///< Bi-Conjugate Gradient Stabilized
+        SOLVER_GMRES,               ///< restarted Generalized Minimal Residual
+        SOLVER_IDRS,                ///< Induced Dimension Reduction
+        SOLVER_PIPELINED_BICGSTAB   ///< pipelined BiCGStab with fused dot products
+    };
+    
+    
+    /// Iterative method used to solve the system of equations (`solver[0]`)
+    /**
+     The accepted values of \a solver are:
+     - `bicgstab` : Bi-Conjugate Gradient Stabilized
+     - `gmres` : Generalized Minimal Residual, restarted after \a solver_dim iterations
+     - `idrs` : Induced Dimension Reduction, with \a solver_dim shadow vectors
+     - `pipelined_bicgstab` : a variant of BiCGStab that groups the dot products,
+        which are then calculated in the same pass as the vector updates
+     .
+     The dimension is given as second value, for example: `solver = gmres, 16`.
+     All methods use the same preconditionner and the same convergence criteria.
+     
+     <em>default value = bicgstab</em>
+     */
+    int       solver;
+    
+    
+    /// Restart period of GMRES, or dimension of the shadow space of IDR(s) (`solver[1]`)
+    /**
+     A short restart period can make GMRES stagnate, and the default is larger for this method.
+     
+     <em>default value = 30 for `gmres`, and 8 for `idrs`</em>
+     */
+    unsigned  solver_dim;
 
     
+    /// Number of threads used to solve the system of equations, and to step the free Couples and Singles
+    /**
+     If \a threads > 1, the matrix-vector multiplications done by the iterative solver
+     are distributed over several threads, each thread handling a different set
+     of Mecables. This is only useful for large systems, as the threads need to be
+     synchronized for every multiplication.
+     
+     The diffusion of the free Couples and Singles, and the search for binding sites,
+     are also distributed over the threads, each thread using its own random generator.
+     The attachments are then made sequentially, such that a simulation is reproducible
+     for a given \a random_seed and number of \a threads, but different values of
+     \a threads give different results.
+     
+     <em>default value = 1</em>
+     */
+    unsigned  threads;
+    
+    
     /// A flag to control the engine that implement steric interactions between objects
     int       steric;
     
@@ -196,6 +291,44 @@ public:
      */
     real      binding_grid_step;
     
+    /// Distance by which Fibers may move before the grid used for attachment is repainted (<em>default = 0</em>)
+    /**
+     If \a binding_grid_skin is zero, the grid used to determine the attachment of Hand
+     is cleared and painted again entirely at every time step.
+     
+     If \a binding_grid_skin > 0, the area painted around each segment is extended by this
+     distance, and only the segments that have moved by more than \a binding_grid_skin are
+     painted again, which can save considerable time, in particular in 3D.
+     The Fibers for which the number of points has changed are always repainted.
+     Larger values increase the number of false positives that need to be tested
+     for attachment, as for \a binding_grid_step. The results are statistically
+     identical, but the sequence of random numbers is changed.
+     */
+    real      binding_grid_skin;
+    
+    /// if true, the grid used for attachment stores its cells contiguously (<em>default = false</em>)
+    /**
+     If \a binding_grid_compact is true, the segments of the Fibers are copied with the position
+     of their ends, and the list of segments of all cells are stored in one contiguous array.
+     This representation is rebuilt at every time step, and reduces the memory accesses
+     when Hands look for a Fiber to bind. It cannot be combined with \a binding_grid_skin.
+     The results are identical to the default representation.
+     */
+    bool      binding_grid_compact;
+    
+    /// if true, the free Couples and Singles are stepped from contiguous arrays (<em>default = false</em>)
+    /**
+     If \a free_arrays is true, the position and the attachment times of the free Couples
+     and Singles are copied to contiguous arrays (see FreeArrays), where diffusion,
+     confinement and the countdown to the next binding attempt are calculated.
+     The objects themselves are only accessed when one of their Hands tries to bind.
+     This applies to Couple and Single with `activity = diffuse`, without `fast_diffusion`,
+     and that do not have a Nucleator. The objects are returned to the normal lists
+     before any output or event, by Simul::relax().
+     The results are statistically identical, but the sequence of random numbers is changed.
+     */
+    bool      free_arrays;
+    
     /// level of verbosity
     int           verbose;
 
@@ -211,6 +344,22 @@ public:
     /// If false, any pre-existing trajectory_file will be erased (<em>default = false</em>)
     bool          append_file;
     
+    /// If true, the time spent in the different phases of the calculation is recorded
+    /**
+     The times are accumulated by Profile, and written to \a profile_file
+     at every frame of the `run` command, on one line, in milli-seconds.
+     The number of iterations made by the solver, the number of elements in the
+     matrices and the number of attached Hands are also indicated.
+     Recording the times has a very small cost, and
+     it is not necessary to compile with profiling options to get this information.
+     
+     <em>default value = false</em>
+     */
+    bool          profile;
+    
+    /// Name of output profile file (<em>default = profile.txt</em>)
+    std::string   profile_file;
+    
     /// Display parameters (see @ref DisplayPar)
     std::string   display;
 
@@ -25,6 +25,29 @@ void remove_plural(std::string & str)
 }
 
 
+/// split the argument string into 3 parts separated by ':'
+void split_report(std::string const& arg, std::string& what, std::string& who, std::string& which)
+{
+    what = arg;
+    std::string::size_type pos = arg.find(':');
+    if ( pos != std::string::npos )
+    {
+        what = arg.substr(0, pos);
+        who  = arg.substr(pos+1);
+        std::string::size_type pas = who.find(':');
+        if ( pas != std::string::npos )
+        {
+            which = who.substr(pas+1);
+            who.resize(pas);
+        }
+    }
+    
+    // allow for approximate English:
+    remove_plural(who);
+    remove_plural(what);
+}
+
+
 /**
  @copydetails Simul::report0
  */
@@ -93,25 +116,8 @@ void Simul::report(std::ostream& out, std::string const& str, Glossary& opt) con
  */
 void Simul::report0(std::ostream& out, std::string const& arg, Glossary& opt) const
 {
-    std::string what = arg, who, which;
-    
-    // split the argument string into 3 parts separated by ':':
-    std::string::size_type pos = arg.find(':');
-    if ( pos != std::string::npos )
-    {
-        what = arg.substr(0, pos);
-        who  = arg.substr(pos+1);
-        std::string::size_type pas = who.find(':');
-        if ( pas != std::string::npos )
-        {
-            which = who.substr(pas+1);
-            who.resize(pas);
-        }
-    }
-    
-    // allow for approximate English:
-    remove_plural(who);
-    remove_plural(what);
+    std::string what, who, which;
+    split_report(arg, what, who, which);
 
     //std::clog << "report("<< what << "|" << who << "|" << which << ")\n";
 
@@ -1348,3 +1354,16 @@ void Simul::reportCustom(std::ostream& out) const
     out << std::endl;
 }
 
+
+/**
+ The number of attached Hands is counted when the line is written,
+ and the Profile is then cleared, such that each line covers the time
+ since the previous line.
+ */
+void Simul::writeProfile(FILE * file, int frame) const
+{
+    sProfile.set(Profile::HANDS, singles.sizeA() + couples.sizeAF() + couples.sizeFA() + 2 * couples.sizeAA());
+    sProfile.write(file, frame, sTime);
+    sProfile.clear();
+}
+
@@ -247,7 +247,9 @@ void Simul::setInteractions(Meca & meca) const
 //------------------------------------------------------------------------------
 void Simul::solve()
 {
+    sProfile.tic();
     setInteractions(sMeca);
+    sProfile.toc(Profile::INTERACTIONS);
 
     sMeca.solve(prop, prop->precondition);
 }
@@ -66,6 +66,7 @@ void Simul::step()
     assert_true(sReady);
     
     sTime += prop->time_step;
+    sProfile.tic();
         
     /* 
      Lists of objects are mixed, to ensure that objects are
@@ -80,6 +81,7 @@ void Simul::step()
     couples.mix();
     singles.mix();
     // Spaces are not mixed
+    sProfile.toc(Profile::MIX);
     
     /*
      Step for every Objects
@@ -90,17 +92,23 @@ void Simul::step()
     spheres.step();
     beads.step();
     solids.step();
+    sProfile.toc(Profile::OBJECTS);
     fibers.step();
+    sProfile.toc(Profile::FIBERS);
     
     /*
      Prepare the Grid for Hand binding interactions.
-     Note: if Fibers never move, we could do this only once
+     If simul:binding_grid_skin > 0, only the segments that have moved are repainted
      */
     if ( !fiberGrid.hasGrid() )
         setFiberGrid(space());
     
     //Cytosim::MSG(9, "grid range = %.2f nm\n", 1000 * HandProp::binding_range_max);
-    fiberGrid.paintGrid(fibers.first(), 0, HandProp::binding_range_max);
+    if ( prop->binding_grid_compact )
+        fiberGrid.paintCompact(fibers.first(), 0, HandProp::binding_range_max);
+    else
+        fiberGrid.paintGrid(fibers.first(), 0, HandProp::binding_range_max, prop->binding_grid_skin);
+    sProfile.toc(Profile::GRID);
     
     
 #ifdef TEST_BINDING
@@ -122,7 +130,16 @@ void Simul::step()
     
 #endif
        
+    // the threads can be used to step the free Couples and Singles:
+    threadPool().resize(prop->threads);
+    
+    // the sites used by fast_diffusion must follow the changes made to the Fibers,
+    // which are not modified by the Couples and Singles:
+    if ( couples.fastDiffusion() || singles.fastDiffusion() )
+        fibers.uniPrepare();
     couples.step(fibers, fiberGrid);
+    sProfile.toc(Profile::COUPLES);
     singles.step(fibers, fiberGrid);
+    sProfile.toc(Profile::SINGLES);
 }
 
@@ -0,0 +1,316 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "column_table.h"
+
+/*
+ These functions fill a ColumnTable with the same data as the corresponding
+ text reports in simul_report.cc, for output in binary format.
+ */
+
+/// add DIM columns of floating-point values for a vector called `name`
+static unsigned addVectorColumns(ColumnTable& tab, std::string const& name)
+{
+    unsigned c = tab.addColumn(name+"_x", ColumnTable::FLOAT64);
+#if ( DIM > 1 )
+    tab.addColumn(name+"_y", ColumnTable::FLOAT64);
+#endif
+#if ( DIM > 2 )
+    tab.addColumn(name+"_z", ColumnTable::FLOAT64);
+#endif
+    return c;
+}
+
+/// add vector `vec` in columns `c` to `c+DIM-1`
+static void addVector(ColumnTable& tab, unsigned c, Vector const& vec)
+{
+    for ( int d = 0; d < DIM; ++d )
+        tab.addReal(c+d, vec[d]);
+}
+
+
+static void tableFiber(ColumnTable& tab, FiberSet const& fibers)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned len = tab.addColumn("length", ColumnTable::FLOAT64);
+    unsigned pos = addVectorColumns(tab, "position");
+    unsigned dir = addVectorColumns(tab, "direction");
+    unsigned ete = tab.addColumn("end_to_end", ColumnTable::FLOAT64);
+    unsigned cos = tab.addColumn("cosinus", ColumnTable::FLOAT64);
+
+    for ( Fiber * obj=fibers.first(); obj; obj=obj->next() )
+    {
+        tab.addInt(cls, obj->prop->index());
+        tab.addInt(ide, obj->number());
+        tab.addReal(len, obj->length());
+        addVector(tab, pos, obj->posEnd(CENTER));
+        addVector(tab, dir, obj->dirEnd(CENTER));
+        tab.addReal(ete, (obj->posEnd(MINUS_END)-obj->posEnd(PLUS_END)).norm());
+        tab.addReal(cos, obj->dirEnd(MINUS_END) * obj->dirEnd(PLUS_END));
+    }
+}
+
+
+static void tableFiberPoints(ColumnTable& tab, FiberSet const& fibers)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned pti = tab.addColumn("point", ColumnTable::INT32);
+    unsigned pos = addVectorColumns(tab, "pos");
+
+    // we print Fibers in the order of the inventory:
+    Fiber * fib = static_cast<Fiber*>(fibers.inventory.first());
+    while ( fib )
+    {
+        for ( unsigned p = 0; p < fib->nbPoints(); ++p )
+        {
+            tab.addInt(cls, fib->prop->index());
+            tab.addInt(ide, fib->number());
+            tab.addInt(pti, p);
+            addVector(tab, pos, fib->posPoint(p));
+        }
+        fib = static_cast<Fiber*>(fibers.inventory.next(fib));
+    }
+}
+
+
+static void tableFiberEnds(ColumnTable& tab, FiberSet const& fibers)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned len = tab.addColumn("length", ColumnTable::FLOAT64);
+    unsigned stM = tab.addColumn("stateM", ColumnTable::INT32);
+    unsigned posM = addVectorColumns(tab, "positionM");
+    unsigned dirM = addVectorColumns(tab, "directionM");
+    unsigned stP = tab.addColumn("stateP", ColumnTable::INT32);
+    unsigned posP = addVectorColumns(tab, "positionP");
+    unsigned dirP = addVectorColumns(tab, "directionP");
+
+    for ( Fiber * obj=fibers.first(); obj; obj=obj->next() )
+    {
+        tab.addInt(cls, obj->prop->index());
+        tab.addInt(ide, obj->number());
+        tab.addReal(len, obj->length());
+        tab.addInt(stM, obj->dynamicState(MINUS_END));
+        addVector(tab, posM, obj->posEnd(MINUS_END));
+        addVector(tab, dirM, obj->dirEnd(MINUS_END));
+        tab.addInt(stP, obj->dynamicState(PLUS_END));
+        addVector(tab, posP, obj->posEnd(PLUS_END));
+        addVector(tab, dirP, obj->dirEnd(PLUS_END));
+    }
+}
+
+
+/// export Singles of class `prop`, or all Singles if `prop == 0`
+static void tableSingle(ColumnTable& tab, SingleSet const& singles, Property const* prop, bool free)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned sta = tab.addColumn("state", ColumnTable::INT32);
+    unsigned pos = addVectorColumns(tab, "position");
+    unsigned frc = addVectorColumns(tab, "force");
+
+    for ( int s = !free; s < 2; ++s )
+    {
+        for ( Single * obj = ( s ? singles.firstA() : singles.firstF() ); obj ; obj = obj->next() )
+        {
+            if ( prop == 0  ||  obj->property() == prop )
+            {
+                tab.addInt(cls, obj->property()->index());
+                tab.addInt(ide, obj->number());
+                tab.addInt(sta, s);
+                addVector(tab, pos, obj->position());
+                addVector(tab, frc, s ? obj->force() : Vector(0,0,0));
+            }
+        }
+    }
+}
+
+
+/// export Couples of class `prop`, or all Couples if `prop == 0`
+static void tableCouple(ColumnTable& tab, CoupleSet const& couples, Property const* prop)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned st1 = tab.addColumn("state1", ColumnTable::INT32);
+    unsigned st2 = tab.addColumn("state2", ColumnTable::INT32);
+    unsigned pos = addVectorColumns(tab, "position");
+
+    Couple * first[4] = { couples.firstFF(), couples.firstAF(), couples.firstFA(), couples.firstAA() };
+
+    for ( int s = 0; s < 4; ++s )
+    {
+        for ( Couple * obj = first[s]; obj ; obj = obj->next() )
+        {
+            if ( prop == 0  ||  obj->property() == prop )
+            {
+                tab.addInt(cls, obj->property()->index());
+                tab.addInt(ide, obj->number());
+                tab.addInt(st1, s & 1);
+                tab.addInt(st2, s >> 1);
+                addVector(tab, pos, obj->position());
+            }
+        }
+    }
+}
+
+
+/// export Couples bound twice, of class `prop`, or all of them if `prop == 0`
+static void tableCoupleLink(ColumnTable& tab, CoupleSet const& couples, Property const* prop)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned fb1 = tab.addColumn("fiber1", ColumnTable::INT32);
+    unsigned ab1 = tab.addColumn("abscissa1", ColumnTable::FLOAT64);
+    unsigned fb2 = tab.addColumn("fiber2", ColumnTable::INT32);
+    unsigned ab2 = tab.addColumn("abscissa2", ColumnTable::FLOAT64);
+    unsigned cos = tab.addColumn("cos_angle", ColumnTable::FLOAT64);
+
+    for ( Couple * obj=couples.firstAA(); obj ; obj = obj->next() )
+    {
+        if ( prop == 0  ||  obj->property() == prop )
+        {
+            tab.addInt(cls, obj->property()->index());
+            tab.addInt(ide, obj->number());
+            tab.addInt(fb1, obj->fiber1()->number());
+            tab.addReal(ab1, obj->hand1()->abscissa());
+            tab.addInt(fb2, obj->fiber2()->number());
+            tab.addReal(ab2, obj->hand2()->abscissa());
+            tab.addReal(cos, obj->hand1()->dir() * obj->hand2()->dir());
+        }
+    }
+}
+
+
+static void tableBead(ColumnTable& tab, BeadSet const& beads)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned pos = addVectorColumns(tab, "position");
+
+    for ( Bead * obj=beads.first(); obj; obj=obj->next() )
+    {
+        tab.addInt(cls, obj->property()->index());
+        tab.addInt(ide, obj->number());
+        addVector(tab, pos, obj->position());
+    }
+}
+
+
+static void tableSolid(ColumnTable& tab, SolidSet const& solids)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned cen = addVectorColumns(tab, "centroid");
+    unsigned pt0 = addVectorColumns(tab, "point0");
+
+    for ( Solid * obj=solids.first(); obj; obj=obj->next() )
+    {
+        tab.addInt(cls, obj->property()->index());
+        tab.addInt(ide, obj->number());
+        addVector(tab, cen, obj->centroid());
+        addVector(tab, pt0, obj->posPoint(0));
+    }
+}
+
+
+static void tableSphere(ColumnTable& tab, SphereSet const& spheres)
+{
+    unsigned cls = tab.addColumn("class", ColumnTable::INT32);
+    unsigned ide = tab.addColumn("id", ColumnTable::INT32);
+    unsigned pos = addVectorColumns(tab, "position");
+
+    for ( Sphere * obj=spheres.first(); obj; obj=obj->next() )
+    {
+        tab.addInt(cls, obj->property()->index());
+        tab.addInt(ide, obj->number());
+        addVector(tab, pos, obj->posPoint(0));
+    }
+}
+
+
+/**
+ This supports the reports that list objects, one per line:
+
+ WHAT                |   columns
+ --------------------|------------------------------------------------------
+ `fiber`             | class, id, length, position, direction, end_to_end, cosinus
+ `fiber:points`      | class, id, point, pos
+ `fiber:ends`        | class, id, length, stateM, positionM, directionM, stateP, positionP, directionP
+ `bead`              | class, id, position
+ `solid`             | class, id, centroid, point0
+ `sphere`            | class, id, position
+ `single:all`        | class, id, state, position, force
+ `single:force`      | class, id, state, position, force
+ `single:NAME`       | class, id, state, position, force
+ `couple:all`        | class, id, state1, state2, position
+ `couple:NAME`       | class, id, state1, state2, position
+ `couple:link`       | class, id, fiber1, abscissa1, fiber2, abscissa2, cos_angle
+ `couple:link:NAME`  | class, id, fiber1, abscissa1, fiber2, abscissa2, cos_angle
+
+ Vectors are stored in DIM columns with suffix `_x`, `_y` and `_z`.
+ */
+void Simul::report(ColumnTable& tab, std::string const& arg, Glossary& opt) const
+{
+    std::string what, who, which;
+    split_report(arg, what, who, which);
+
+    tab.clear();
+
+    if ( what == "fiber" )
+    {
+        if ( who.empty() )
+            tableFiber(tab, fibers);
+        else if ( who == "point" )
+            tableFiberPoints(tab, fibers);
+        else if ( who == "end" )
+            tableFiberEnds(tab, fibers);
+        else
+            throw InvalidSyntax("In binary format, I only know fiber, fiber:point, fiber:end");
+    }
+    else if ( what == "bead" && ( who.empty() || who == "position" || who == "all" ) )
+        tableBead(tab, beads);
+    else if ( what == "solid" && who.empty() )
+        tableSolid(tab, solids);
+    else if ( what == "sphere" && who.empty() )
+        tableSphere(tab, spheres);
+    else if ( what == "single" && who.size() )
+    {
+        Property const* prop = 0;
+        if ( who != "position" && who != "all" && who != "force" )
+        {
+            prop = properties.find("single", who);
+            if ( prop == 0 )
+                throw InvalidParameter("Unknown single `"+who+"'");
+        }
+        tableSingle(tab, singles, prop, who != "force");
+    }
+    else if ( what == "couple" && who.size() )
+    {
+        Property const* prop = 0;
+        if ( who == "bridge" || who == "link" )
+        {
+            if ( which.size() )
+                prop = properties.find_or_die("couple", which);
+            tableCoupleLink(tab, couples, prop);
+        }
+        else
+        {
+            if ( who != "position" && who != "all" )
+            {
+                prop = properties.find("couple", who);
+                if ( prop == 0 )
+                    throw InvalidParameter("Unknown couple `"+who+"'");
+            }
+            tableCouple(tab, couples, prop);
+        }
+    }
+    else
+        throw InvalidSyntax("I do not know how to write `"+arg+"' in binary format");
+
+    /// check that all options have been used:
+    std::stringstream ss;
+    if ( opt.warnings(ss) > 1 )
+        throw InvalidParameter(ss.str());
+}
+
@@ -11,6 +11,9 @@
 #include "space.h"
 #include "modulo.h"
 #include "meca.h"
+#include "attachment_sweep.h"
+
+extern Random RNG;
 
 
 //------------------------------------------------------------------------------
@@ -99,12 +102,16 @@ void Single::foldPosition(const Modulo * s)
 }
 
 
-void Single::stepFree(const FiberGrid& grid)
+void Single::randomizePosition()
 {
-    assert_false( sHand->attached() );
+    sPos = prop->confine_space_ptr->randomPlace();
+}
 
+
+void Single::diffuse(Random& rng)
+{
     // diffusion:
-    sPos.addRand( prop->diffusion_dt );
+    sPos.addRand(prop->diffusion_dt, rng);
     
     // confinement
     if ( prop->confine == CONFINE_INSIDE )
@@ -120,11 +127,29 @@ void Single::stepFree(const FiberGrid& grid)
         assert_true(spc);
         spc->project(sPos);
     }
+}
+
+
+void Single::stepFree(const FiberGrid& grid)
+{
+    assert_false( sHand->attached() );
+
+    diffuse(RNG);
     
     sHand->stepFree(grid, sPos);
 }
 
 
+void Single::sweepFree(AttachmentBuffer& buf)
+{
+    assert_false( sHand->attached() );
+    
+    diffuse(buf.rng);
+    
+    sHand->sweepFree(buf, sPos);
+}
+
+
 void Single::stepAttached()
 {
     assert_true( sHand->attached() );
@@ -170,3 +195,15 @@ void Single::read(InputWrapper & in, Simul& sim)
 }
 
 
+void Single::writeState(OutputWrapper& out) const
+{
+    sHand->writeState(out);
+}
+
+
+void Single::readState(InputWrapper& in)
+{
+    sHand->readState(in);
+}
+
+
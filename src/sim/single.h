@@ -16,6 +16,7 @@ class Meca;
 class Modulo;
 class Glossary;
 class FiberGrid;
+class AttachmentBuffer;
 class Fiber;
 
 
@@ -128,6 +129,9 @@ public:
     /// modulo the position of the grafted
     virtual void    foldPosition(const Modulo * s);
     
+    /// set the position randomly inside the confining Space
+    void            randomizePosition();
+    
     //--------------------------------------------------------------------------
     
     /// the Mecable to which this is attached, or zero
@@ -142,9 +146,15 @@ public:
     /// force = zero for a diffusible Single
     virtual Vector  force()                      const  { return Vector(0,0,0); }
 
+    /// diffusion and confinement of a free Single, using the given generator
+    void            diffuse(Random&);
+    
     /// Monte-Carlo step for a free Single
     virtual void    stepFree(const FiberGrid&);
     
+    /// equivalent of stepFree() called in parallel by AttachmentSweep
+    virtual void    sweepFree(AttachmentBuffer&);
+    
     /// Monte-Carlo step for a bound Single
     virtual void    stepAttached();
     
@@ -179,6 +189,12 @@ public:
     /// write to file
     virtual void    write(OutputWrapper&) const;
     
+    /// write the state of the Hand that is not saved by write()
+    void            writeState(OutputWrapper&) const;
+    
+    /// read the state written by writeState()
+    void            readState(InputWrapper&);
+    
 };
 
 
@@ -81,6 +81,7 @@ void SingleProp::clear()
     stiffness         = 0;
     length            = 0;
     diffusion         = 0;
+    fast_diffusion    = false;
     activity          = "diffuse";
     
     confine           = CONFINE_INSIDE;
@@ -96,6 +97,7 @@ void SingleProp::read(Glossary& glos)
     glos.set(stiffness, "stiffness");
     glos.set(length,    "length");
     glos.set(diffusion, "diffusion");
+    glos.set(fast_diffusion, "fast_diffusion");
     glos.set(activity,  "activity");
 
     glos.set(confine,   "confine", 
@@ -128,6 +130,9 @@ void SingleProp::complete(SimulProp const* sp, PropertyList* plist)
 
     diffusion_dt = sqrt( 6.0 * diffusion * sp->time_step );
     
+    if ( fast_diffusion  &&  activity != "diffuse" )
+        throw InvalidParameter("single:fast_diffusion requires activity = diffuse");
+    
     if ( stiffness < 0 )
         throw InvalidParameter("single:stiffness must be >= 0");
 
@@ -153,6 +158,7 @@ void SingleProp::write_data(std::ostream & os) const
     write_param(os, "stiffness", stiffness);
     write_param(os, "length",    length);
     write_param(os, "diffusion", diffusion);
+    write_param(os, "fast_diffusion", fast_diffusion);
     write_param(os, "confine",   confine, confine_stiff, confine_space);
     write_param(os, "activity",  activity);
 }
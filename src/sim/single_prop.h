@@ -23,6 +23,7 @@ class SingleProp : public Property
     friend class Single;
     friend class Wrist;
     friend class WristLong;
+    friend class SingleSet;
 
 public:
     
@@ -45,6 +46,14 @@ public:
     /// diffusion coefficient
     real         diffusion;
     
+    /// if true, an algorithm is used that assumes uniform concentration of diffusing Single
+    /**
+     The free Singles are then not moved, and their attachments are distributed 
+     uniformly along the fibers, as for couple:fast_diffusion.
+     This is only possible for `activity = diffuse`.
+     */
+    bool         fast_diffusion;
+    
     /// Confinement can be \c none, \c inside (default) or \c surface
     Confinement  confine;
     
@@ -106,6 +115,8 @@ public:
     /// write all values
     void write_data(std::ostream &) const;
     
+    /// return confining Space
+    Space const* confineSpace() const { return confine_space_ptr; }
 };
 
 #endif
@@ -22,8 +22,23 @@ Property* SingleSet::newProperty(const std::string& kd, const std::string& nm, G
 }
 
 //------------------------------------------------------------------------------
-void SingleSet::step(FiberSet const&, FiberGrid const& fgrid)
+
+void SingleSet::prepare(PropertyList& properties)
+{
+    uni = uniPrepare(properties);
+}
+
+
+void SingleSet::step(FiberSet const& fibers, FiberGrid const& fgrid)
 {
+    // use alternate attachment strategy:
+    if ( uni )
+        uniAttach(fibers);
+    
+    // transfer the diffusing Singles to the arrays:
+    if ( simul.prop->free_arrays )
+        arraysCollect(simul.properties);
+    
     /*
      ATTENTION: we have multiple lists, and Objects are automatically 
      transfered from one list to another if their Hand bind or unbind.
@@ -36,7 +51,21 @@ void SingleSet::step(FiberSet const&, FiberGrid const& fgrid)
     const Node *const fLast = fList.last();
     const Node *const aLast = aList.last();
     
-    if ( fLast )
+    ThreadPool& pool = simul.threadPool();
+    
+    if ( fLast && pool.size() > 1 )
+    {
+        sweepObjs.clear();
+        Single * obj = firstF();
+        while ( obj )
+        {
+            sweepObjs.push_back(obj);
+            if ( obj == fLast ) break;
+            obj = obj->next();
+        }
+        sweep.run(pool, fgrid, sweepObjs.addr(), sweepObjs.size(), &Single::sweepFree);
+    }
+    else if ( fLast )
     {
         Single * obj = firstF(), * nxt;
         do {
@@ -47,6 +76,10 @@ void SingleSet::step(FiberSet const&, FiberGrid const& fgrid)
             nxt->stepFree(fgrid);
         } while ( nxt != fLast );
     }
+    
+    // the Singles that attach are linked after aLast:
+    if ( arrays.size() )
+        arraysStep(fgrid);
 
     if ( aLast )
     {
@@ -61,9 +94,19 @@ void SingleSet::step(FiberSet const&, FiberGrid const& fgrid)
     }
 }
 
+//------------------------------------------------------------------------------
+void SingleSet::relax()
+{
+    uniRelax();
+    arraysRelax();
+}
+
 //------------------------------------------------------------------------------
 void SingleSet::erase()
 {
+    uni = false;
+    uniRelax();
+    arraysRelax();
     fList.erase();
     aList.erase();
     inventory.clear();
@@ -307,6 +350,8 @@ void SingleSet::mix()
 
 void SingleSet::freeze()
 {
+    uniRelax();
+    arraysRelax();
     fIce.transfer(fList);
     aIce.transfer(aList);
 }
@@ -372,3 +417,237 @@ int SingleSet::bad() const
     return code;
 }
 
+
+//------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Fast Diffusion
+
+/**
+ Implements the Monte-Carlo approach of CoupleSet::uniAttach() for free Singles,
+ under the assumption that diffusion is sufficiently fast to maintain
+ a uniform spatial distribution.
+ 
+ The number of binding events is drawn from a Poisson distribution,
+ and each event attaches a Single from the reserve at a random position,
+ chosen uniformly along the fibers with FiberSet::uniFiberSite().
+ */
+void SingleSet::uniAttach(FiberSet const& fibers, SingleList& reserve)
+{
+    const size_t rsize = reserve.size();
+    Single * obj = reserve.top();
+    assert_true( obj );
+    
+    SingleProp const * sp = static_cast<SingleProp const*>(obj->property());
+    assert_true( sp->fast_diffusion );
+    
+    if ( sp->confineSpace() == 0 )
+        throw InvalidParameter("could not get Space necessary for single:fast_diffusion");
+    
+    // get Volume in which Single are confined:
+    const real volume = sp->confineSpace()->volume();
+    
+    if ( volume <= 0 )
+        throw InvalidParameter("single:fast_diffusion requires a non-zero space::volume");
+    
+    // length of fiber per unit volume:
+    const real fiber_density = fibers.uniLength() / volume;
+    
+    real density = rsize * obj->hand()->prop->attachDensity();
+    if ( density > 0 )
+    {
+        unsigned cnt = RNG.poisson(density * fiber_density);
+        
+        for ( ; cnt > 0; --cnt )
+        {
+            FiberBinder site = fibers.uniFiberSite();
+            if ( obj->hand()->attachmentAllowed(site) )
+            {
+                obj->attach(site);
+                reserve.pop();
+                link(obj);
+                if ( reserve.empty() )
+                    return;
+                obj = reserve.top();
+            }
+        }
+    }
+}
+
+
+/**
+ Alternative attachment algorithm assuming fast diffusion,
+ used if ( single:fast_diffusion == true )
+ 
+ See SingleSet::uniAttach
+ */
+void SingleSet::uniAttach(FiberSet const& fibers)
+{
+    // transfer free Singles that fast-diffuse to the reserve
+    Single * obj = firstF(), * nxt = obj;
+    while ( nxt )
+    {
+        nxt = nxt->next();
+        SingleProp const* sp = static_cast<SingleProp const*>(obj->property());
+        if ( sp->fast_diffusion  &&  obj->tag() == Single::TAG )
+        {
+            fList.pop(obj);
+            assert_true((size_t)sp->index() < uniLists.size());
+            uniLists[sp->index()].push(obj);
+        }
+        obj = nxt;
+    }
+    
+    if ( fibers.uniLength() <= 0 )
+        return;
+    
+    // uniform attachment for reserved singles:
+    for ( SingleReserve::iterator s = uniLists.begin(); s < uniLists.end(); ++s )
+        if ( ! (*s).empty() )
+            uniAttach(fibers, *s);
+}
+
+
+/**
+ Return true if at least one single:fast_diffusion is true,
+ and in this case allocate uniLists.
+ 
+ The Volume of the Space is assumed to remain constant until the next uniPrepare() 
+ */
+bool SingleSet::uniPrepare(PropertyList& properties)
+{
+    int inx = 0;
+    bool res = false;
+    
+    PropertyList plist = properties.find_all("single");
+    
+    for ( PropertyList::const_iterator n = plist.begin(); n != plist.end(); ++n )
+    {
+        SingleProp const * p = static_cast<SingleProp const*>(*n);
+        if ( p->fast_diffusion )
+            res = true;
+        
+        if ( p->index() > inx )
+            inx = p->index();
+    }
+    
+    if ( res )
+        uniLists.resize(inx+1);
+    
+    return res;
+}
+
+
+/**
+ empty uniLists, returning all Singles in the normal lists.
+ This is useful if ( single:fast_diffusion == true )
+ */
+void SingleSet::uniRelax()
+{
+    for ( SingleReserve::iterator res = uniLists.begin(); res != uniLists.end(); ++res )
+    {
+        SingleList& reserve = *res;
+        while( ! reserve.empty() )
+        {
+            Single * s = reserve.top();
+            s->randomizePosition();
+            reserve.pop();
+            fList.push_front(s);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+#pragma mark -
+#pragma mark Free Arrays
+
+/**
+ Set the classes of `arrays` from the current properties,
+ and transfer the free Singles that can be stepped by FreeArrays.
+ 
+ This applies to the plain Single (single:activity = diffuse), but not to the Wrist.
+ The Singles with fast_diffusion are handled by uniAttach(),
+ and a Nucleator redefines Hand::stepFree().
+ */
+void SingleSet::arraysCollect(PropertyList const& properties)
+{
+    arrays.clearClasses();
+    
+    PropertyList plist = properties.find_all("single");
+    
+    for ( PropertyList::const_iterator n = plist.begin(); n != plist.end(); ++n )
+    {
+        SingleProp const * p = static_cast<SingleProp const*>(*n);
+        if ( p->activity == "diffuse"  &&  !p->fast_diffusion
+            &&  p->hand_prop->activity != "nucleate" )
+        {
+            FreeArrays::Class c;
+            c.used         = true;
+            c.diffusion_dt = p->diffusion_dt;
+            c.confine      = p->confine;
+            c.space        = p->confine_space_ptr;
+            c.rate_dt[0]   = p->hand_prop->binding_rate_dt;
+            c.rate_dt[1]   = 0;
+            arrays.setClass(p->index(), c);
+        }
+    }
+    
+    Single * obj = firstF(), * nxt = obj;
+    while ( nxt )
+    {
+        nxt = nxt->next();
+        const unsigned k = obj->property()->index();
+        if ( obj->tag() == Single::TAG  &&  arrays.accepts(k) )
+        {
+            real t = obj->hand()->attachTime();
+            fList.pop(obj);
+            arrays.add(obj, obj->position(), k, &t);
+        }
+        obj = nxt;
+    }
+}
+
+
+/**
+ This is equivalent to Single::stepFree() for all the Singles in `arrays`.
+ The Singles whose Hand binds are removed from `arrays` and linked.
+ 
+ The fired times are processed from the end, such that removing a Single,
+ which is replaced by the last one, does not affect the times not yet processed.
+ */
+void SingleSet::arraysStep(FiberGrid const& fgrid)
+{
+    arrays.diffuse(RNG);
+    arrays.countdown(arraysFired);
+    
+    for ( unsigned n = arraysFired.size(); n > 0; --n )
+    {
+        const unsigned i = arraysFired[n-1];
+        Single * obj = static_cast<Single*>(arrays.object(i));
+        obj->setPosition(arrays.position(i));
+        arrays.time(i, 0) = RNG.exponential();
+        if ( fgrid.tryToAttach(arrays.position(i), *obj->hand()) )
+        {
+            obj->hand()->attachTime(arrays.time(i, 0));
+            arrays.remove(i);
+            link(obj);
+        }
+    }
+}
+
+
+/**
+ Copy the position and the attachment time back to the Singles,
+ and return them to fList.
+ */
+void SingleSet::arraysRelax()
+{
+    for ( unsigned i = 0; i < arrays.size(); ++i )
+    {
+        Single * obj = static_cast<Single*>(arrays.object(i));
+        obj->setPosition(arrays.position(i));
+        obj->hand()->attachTime(arrays.time(i, 0));
+        fList.push_front(obj);
+    }
+    arrays.clear();
+}
+
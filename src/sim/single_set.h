@@ -5,7 +5,10 @@
 
 #include "object_set.h"
 #include "single.h"
+#include "attachment_sweep.h"
+#include "free_arrays.h"
 #include "single_prop.h"
+#include <stack>
 
 /// Set for Single
 /**
@@ -13,6 +16,9 @@
  - fList = free,
  - aList = attached.
  .
+ If simul:free_arrays is true, the free Singles that only diffuse are removed from fList,
+ and stepped from the contiguous arrays of a FreeArrays, until their Hand binds,
+ or until relax() is called.
  Each list is accessible via its head firstF() and firstA().
  This way, the state of the Single are known when accessing them.
  
@@ -38,10 +44,55 @@ private:
     /// register a Single into the list
     void         link(Object *);
     
+    /// used to step the free Singles in parallel
+    AttachmentSweep  sweep;
+    
+    /// the free Singles, in the order of fList
+    Array<Single*>   sweepObjs;
+    
+    /// a list to hold Singles of one class
+    typedef std::stack<Single*> SingleList;
+    
+    /// an array of SingleList
+    typedef std::vector<SingleList> SingleReserve;
+    
+    /// uniLists[p] contains the Singles with ( property()->index() == p ) that are diffusing
+    SingleReserve    uniLists;
+    
+    /// flag to enable single:fast_diffusion attachment algorithm
+    bool             uni;
+    
+    /// initialize single:fast_diffusion attachment algorithm
+    bool          uniPrepare(PropertyList& properties);
+    
+    /// implements single:fast_diffusion attachment algorithm for one class of Single
+    void          uniAttach(FiberSet const&, SingleList&);
+    
+    /// single:fast_diffusion attachment algorithm; assumes free Singles are uniformly distributed
+    void          uniAttach(FiberSet const&);
+    
+    /// return Singles in uniLists to the normal lists
+    void          uniRelax();
+    
+    /// state of the free Singles that are stepped from arrays, if simul:free_arrays is true
+    FreeArrays       arrays;
+    
+    /// times of arrays that became negative during the current step
+    Array<unsigned>  arraysFired;
+    
+    /// transfer the eligible Singles from fList to `arrays`
+    void          arraysCollect(PropertyList const&);
+    
+    /// step the Singles stored in `arrays`, linking those that have attached
+    void          arraysStep(FiberGrid const&);
+    
+    /// return the Singles stored in `arrays` to fList
+    void          arraysRelax();
+    
 public:
         
     ///creator
-    SingleSet(Simul& s) : ObjectSet(s), fList(this), aList(this) {}
+    SingleSet(Simul& s) : ObjectSet(s), fList(this), aList(this), uni(false), arrays(1) {}
     
     ///destructor
     virtual      ~SingleSet() {}
@@ -71,12 +122,21 @@ public:
     /// remove all Wrists anchored on Object 'obj'
     void          removeWrists(Object * obj);
     
+    /// true if single:fast_diffusion is used, in which case FiberSet::uniPrepare() must be called before step()
+    bool          fastDiffusion() const { return uni; }
+    
     ///returns the first free Single
     Single *      firstF()     const { return static_cast<Single*>(fList.first()); }
     
     ///returns the first bound Single
     Single *      firstA()     const { return static_cast<Single*>(aList.first()); }
     
+    /// number of free Singles
+    unsigned int  sizeF()      const { return fList.size(); }
+    
+    /// number of attached Singles
+    unsigned int  sizeA()      const { return aList.size(); }
+    
     /// return pointer to the Object of given Number, or zero if not found
     Single *      find(Number n)  const { return static_cast<Single*>(inventory.get(n)); }
     
@@ -91,6 +151,9 @@ public:
     
     /// mix order of elements
     void          mix();
+    
+    /// discard the generators used to step the free Singles in parallel
+    void          resetSweep() { sweep.reset(); }
 
     /// transfer all object to ice
     void          freeze();
@@ -98,9 +161,15 @@ public:
     /// delete objects, or put them back in normal list
     void          thaw(bool erase);
 
+    /// prepare for step()
+    void          prepare(PropertyList& properties);
+    
     /// Monte-Carlo step
     void          step(FiberSet const&, FiberGrid const&);
     
+    /// cleanup at end of simulation period
+    void          relax();
+    
     /// write
     void          write(OutputWrapper&) const;
     
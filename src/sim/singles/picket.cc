@@ -4,6 +4,7 @@
 #include "simul.h"
 #include "meca.h"
 #include "modulo.h"
+#include "attachment_sweep.h"
 
 
 extern Modulo * modulo;
@@ -32,6 +33,14 @@ void Picket::stepFree(const FiberGrid& grid)
     sHand->stepFree(grid, sPos);
 }
 
+
+void Picket::sweepFree(AttachmentBuffer& buf)
+{
+    assert_false( sHand->attached() );
+    
+    sHand->sweepFree(buf, sPos);
+}
+
 //------------------------------------------------------------------------------
 void Picket::stepAttached()
 {
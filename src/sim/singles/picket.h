@@ -42,6 +42,9 @@ public:
     /// Monte-Carlo step for a free Single
     void    stepFree(const FiberGrid&);
     
+    /// equivalent of stepFree() called in parallel by AttachmentSweep
+    void    sweepFree(AttachmentBuffer&);
+    
     /// Monte-Carlo step for a bound Single
     void    stepAttached();
     
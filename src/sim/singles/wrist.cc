@@ -4,6 +4,7 @@
 #include "simul.h"
 #include "meca.h"
 #include "modulo.h"
+#include "attachment_sweep.h"
 
 
 extern Modulo * modulo;
@@ -51,6 +52,14 @@ void Wrist::stepFree(const FiberGrid& grid)
     sHand->stepFree(grid, sBase.pos());
 }
 
+
+void Wrist::sweepFree(AttachmentBuffer& buf)
+{
+    assert_false( sHand->attached() );
+    
+    sHand->sweepFree(buf, sBase.pos());
+}
+
 //------------------------------------------------------------------------------
 void Wrist::stepAttached()
 {
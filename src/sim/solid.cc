@@ -928,3 +928,29 @@ void Solid::read(InputWrapper & in, Simul&)
     
     fixShape();
 }
+
+
+void Solid::writeState(OutputWrapper& out) const
+{
+    PointSet::writeState(out);
+    out.writeUInt32(soShapeSize);
+    for ( unsigned int pp = 0; pp < DIM * soShapeSize; ++pp )
+        out.writeDouble(soShape[pp]);
+    out.writeDouble(soShapeSqr);
+    out.writeUInt32(soReshapeTimer);
+}
+
+
+void Solid::readState(InputWrapper& in)
+{
+    PointSet::readState(in);
+    unsigned int nbp = in.readUInt32();
+    if ( nbp != nbPoints() )
+        throw InvalidIO("invalid number of points in Solid::readState()");
+    soShapeSize = nbp;
+    for ( unsigned int pp = 0; pp < DIM * soShapeSize; ++pp )
+        soShape[pp] = in.readDouble();
+    soShapeSqr = in.readDouble();
+    soReshapeTimer = in.readUInt32();
+}
+
@@ -184,6 +184,12 @@ public:
     
     ///write to file
     void        write(OutputWrapper&) const;
+    
+    ///write the reference shape, which is not saved by write()
+    void        writeState(OutputWrapper&) const;
+    
+    ///read the state written by writeState()
+    void        readState(InputWrapper&);
 
 };
 
@@ -0,0 +1,347 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+/**
+ Benchmark of the simulation engine, using a fixed set of configurations.
+
+ Each configuration is read without executing its `run` commands, and the
+ simulation is then stepped by this program. The time spent in the phases of
+ Simul::step() and Simul::solve() is recorded by the Profile of the Simul.
+ The kernels that dominate these phases are then timed separately,
+ on the state that was reached at the end of the steps.
+
+ The results are written on one line per measurement, for regression tracking.
+ The canonical workloads are in `cym/bench/`.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "glossary.h"
+#include "messages.h"
+#include "exceptions.h"
+#include "parser.h"
+#include "simul.h"
+#include "meca.h"
+#include "fiber_grid.h"
+#include "hand_monitor.h"
+#include "hand_prop.h"
+#include "hand.h"
+#include "profile.h"
+#include "random.h"
+#include "modulo.h"
+#include "tictoc.h"
+
+extern Random RNG;
+extern Modulo * modulo;
+
+/// number of steps done before measuring
+unsigned warmup = 10;
+
+/// number of steps measured
+unsigned nb_steps = 100;
+
+/// number of calls made to time each kernel
+unsigned repeat = 32;
+
+/// number of positions tested by tryToAttach() in each call
+const unsigned nb_places = 1024;
+
+
+void help(std::ostream& os)
+{
+    os << "Synopsis:\n";
+    os << "       Measures the speed of Cytosim on given configuration files\n";
+    os << "       for DIM = " << DIM << "\n";
+    os << "Syntax:\n";
+    os << "       bench FILE.cym [FILE.cym ...] [OPTIONS]\n";
+    os << "Options:\n";
+    os << "       warmup=INTEGER   steps done before measuring (default 10)\n";
+    os << "       steps=INTEGER    steps measured (default 100)\n";
+    os << "       repeat=INTEGER   calls made to time each kernel (default 32)\n";
+    os << "       output=FILE_NAME\n";
+    os << "\n";
+    os << "  The `run` commands of the files are ignored: the simulation is stepped by bench.\n";
+    os << "  One line is written for each measurement, with the name of the configuration,\n";
+    os << "  the item measured, the number of calls, the total time in milli-seconds,\n";
+    os << "  and the time per call in micro-seconds.\n";
+    os << "  The phases are `step`, `setInteractions` and `solve`, and their subdivisions\n";
+    os << "  as recorded by Profile. The kernels are the multiplication by the isotropic\n";
+    os << "  matrix of Meca, RigidFiber::projectForces, FiberGrid::paintGrid\n";
+    os << "  and FiberGrid::tryToAttach.\n";
+    os << "Example:\n";
+    os << "       bench cym/bench/*.cym steps=200 > bench.txt\n";
+}
+
+//------------------------------------------------------------------------------
+
+/// write one line of results
+void result(FILE * out, std::string const& work, std::string const& item, unsigned long calls, double sec)
+{
+    fprintf(out, "%-16s %-22s %8lu %12.3f %12.3f\n", work.c_str(), item.c_str(),
+            calls, 1000 * sec, calls ? 1e6 * sec / calls : 0);
+}
+
+
+/// write the times recorded by the Profile of the simulation
+void reportPhases(FILE * out, std::string const& work, Profile const& pro)
+{
+    double step = 0, solve = 0;
+    for ( int p = Profile::MIX; p <= Profile::SINGLES; ++p )
+        step += pro.seconds((Profile::Phase)p);
+    for ( int p = Profile::MATRIX; p <= Profile::SOLVER; ++p )
+        solve += pro.seconds((Profile::Phase)p);
+
+    result(out, work, "step", pro.nbCalls(Profile::MIX), step);
+    result(out, work, "setInteractions", pro.nbCalls(Profile::INTERACTIONS), pro.seconds(Profile::INTERACTIONS));
+    result(out, work, "solve", pro.nbCalls(Profile::SOLVER), solve);
+
+    for ( int p = 0; p < Profile::WRITE; ++p )
+    {
+        Profile::Phase ph = (Profile::Phase)p;
+        result(out, work, std::string("phase:")+Profile::name(ph), pro.nbCalls(ph), pro.seconds(ph));
+    }
+    result(out, work, "solver:iterations", pro.counter(Profile::ITERATIONS), pro.seconds(Profile::SOLVER));
+}
+
+
+/// time the multiplication by the isotropic matrix, and the projection of the fibers
+void benchMeca(FILE * out, std::string const& work, Simul const& simul)
+{
+    Meca meca;
+    simul.setInteractions(meca);
+
+    const unsigned nbp = meca.nbPoints();
+    if ( nbp == 0 )
+        return;
+
+    std::vector<real> X(3*nbp), Y(3*nbp, 0);
+    for ( unsigned i = 0; i < X.size(); ++i )
+        X[i] = RNG.sreal();
+
+    meca.mB.prepareForMultiply();
+
+    double t = Profile::now();
+    for ( unsigned n = 0; n < repeat; ++n )
+    {
+#if ( DIM == 3 )
+        meca.mB.vecMulAddIso3D(&X[0], &Y[0]);
+#elif ( DIM == 2 )
+        meca.mB.vecMulAddIso2D(&X[0], &Y[0]);
+#else
+        meca.mB.vecMulAdd(&X[0], &Y[0]);
+#endif
+    }
+    t = Profile::now() - t;
+#if ( DIM == 3 )
+    result(out, work, "vecMulAddIso3D", repeat, t);
+#elif ( DIM == 2 )
+    result(out, work, "vecMulAddIso2D", repeat, t);
+#else
+    result(out, work, "vecMulAdd", repeat, t);
+#endif
+
+    // the projections were prepared by setInteractions():
+    if ( simul.fibers.size() == 0 )
+        return;
+
+    std::vector<real> work_space(nbp);
+    t = Profile::now();
+    for ( unsigned n = 0; n < repeat; ++n )
+    {
+        for ( Fiber * fib = simul.fibers.first(); fib; fib = fib->next() )
+        {
+            const unsigned inx = DIM * fib->matIndex();
+            fib->projectForces(&X[inx], &Y[inx], 1.0, &work_space[0]);
+        }
+    }
+    t = Profile::now() - t;
+    result(out, work, "projectForces", repeat * simul.fibers.size(), t);
+}
+
+
+/// time the distribution of the fibers on a grid, and the attachment of a Hand
+void benchGrid(FILE * out, std::string const& work, Simul const& simul)
+{
+    Space const* spc = simul.space();
+    const real range = HandProp::binding_range_max;
+
+    if ( !spc  ||  range <= 0  ||  simul.fibers.size() == 0 )
+        return;
+
+    // use the cell size that was chosen by the simulation:
+    FiberGrid grid;
+    real step = simul.prop->binding_grid_step;
+    while ( grid.setGrid(spc, modulo, step, 1e5) )
+        step *= 2;
+
+    const bool compact = simul.prop->binding_grid_compact;
+
+    double t = Profile::now();
+    for ( unsigned n = 0; n < repeat; ++n )
+    {
+        if ( compact )
+            grid.paintCompact(simul.fibers.first(), 0, range);
+        else
+            grid.paintGrid(simul.fibers.first(), 0, range);
+    }
+    t = Profile::now() - t;
+    result(out, work, compact ? "paintCompact" : "paintGrid", repeat, t);
+
+    // a Hand with a dummy HandMonitor, as in FiberGrid::testAttach()
+    HandProp hp("bench");
+    hp.binding_rate  = 10;
+    hp.binding_range = range;
+    hp.bind_also_ends = true;
+    hp.complete(simul.prop, 0);
+
+    HandMonitor hm;
+    Hand ha(&hp, &hm);
+
+    std::vector<Vector> places(nb_places);
+    for ( unsigned i = 0; i < nb_places; ++i )
+        places[i] = spc->randomPlace();
+
+    unsigned long hits = 0;
+    t = Profile::now();
+    for ( unsigned n = 0; n < repeat; ++n )
+    {
+        for ( unsigned i = 0; i < nb_places; ++i )
+        {
+            if ( grid.tryToAttach(places[i], ha) )
+            {
+                ++hits;
+                ha.detach();
+            }
+        }
+    }
+    t = Profile::now() - t;
+    result(out, work, "tryToAttach", repeat * nb_places, t);
+    result(out, work, "tryToAttach:hits", hits, 0);
+}
+
+
+/// run the benchmark for one configuration file
+int bench(FILE * out, std::string const& file)
+{
+    // name of the workload, without the directory and extension:
+    std::string work = file;
+    size_t pos = work.rfind('/');
+    if ( pos != std::string::npos )
+        work = work.substr(pos+1);
+    pos = work.rfind('.');
+    if ( pos != std::string::npos )
+        work = work.substr(0, pos);
+
+    Simul simul;
+    // this value is accumulated by HandProp::complete() over all simulations:
+    HandProp::binding_range_max = 0;
+    try {
+        // the parser can create objects, but it does not run or write:
+        Parser(simul, 1, 1, 1, 0, 0).readConfig(file);
+
+        simul.prop->strict = 1;
+        simul.prepare();
+
+        double t = Profile::now();
+        for ( unsigned n = 0; n < warmup; ++n )
+        {
+            simul.step();
+            simul.solve();
+        }
+        result(out, work, "warmup", warmup, Profile::now() - t);
+
+        Profile& pro = simul.profile();
+        pro.clear();
+        pro.enable(true);
+        t = Profile::now();
+        for ( unsigned n = 0; n < nb_steps; ++n )
+        {
+            simul.step();
+            simul.solve();
+        }
+        t = Profile::now() - t;
+        pro.enable(false);
+
+        result(out, work, "total", nb_steps, t);
+        reportPhases(out, work, pro);
+        benchMeca(out, work, simul);
+        benchGrid(out, work, simul);
+        simul.relax();
+    }
+    catch( Exception & e )
+    {
+        std::cerr << "Error in " << file << ": " << e.what() << '\n';
+        return 1;
+    }
+    fflush(out);
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> files;
+    std::vector<char*> args;
+    args.push_back(argv[0]);
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strchr(argv[i], '=') )
+            args.push_back(argv[i]);
+        else if ( strstr(argv[i], "help") )
+        {
+            help(std::cout);
+            return EXIT_SUCCESS;
+        }
+        else
+            files.push_back(argv[i]);
+    }
+
+    if ( files.empty() )
+    {
+        help(std::cout);
+        return EXIT_FAILURE;
+    }
+
+    Glossary arg;
+    arg.readStrings(args.size(), &args[0]);
+    arg.set(warmup, "warmup");
+    arg.set(nb_steps, "steps");
+    arg.set(repeat, "repeat");
+    if ( repeat < 1 )
+        repeat = 1;
+
+    FILE * out = stdout;
+    std::string str;
+    if ( arg.set(str, "output") )
+    {
+        out = fopen(str.c_str(), "w");
+        if ( !out )
+        {
+            std::cerr << "Cannot open output file\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ( arg.warnings(std::cerr) )
+        return EXIT_FAILURE;
+
+    Cytosim::silent();
+
+    char date[26];
+    TicToc::date(date, sizeof(date));
+    fprintf(out, "%% bench %s dim %i warmup %u steps %u repeat %u\n", date, DIM, warmup, nb_steps, repeat);
+    fprintf(out, "%% workload        item                      calls     total_ms  us_per_call\n");
+
+    int err = 0;
+    for ( unsigned i = 0; i < files.size(); ++i )
+        err |= bench(out, files[i]);
+
+    if ( out != stdout )
+        fclose(out);
+
+    return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
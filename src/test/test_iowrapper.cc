@@ -0,0 +1,80 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#include "iowrapper.h"
+#include "exceptions.h"
+#include <cstdio>
+#include <cmath>
+
+/*
+ Writes compressed coordinates with OutputWrapper::writeDeltaVector(),
+ and reads them back with InputWrapper::readDeltaVector().
+ Each vector array is followed by a marker, which verifies that the
+ reader consumes exactly what the writer has written, including for n = 0.
+ */
+
+const char file_name[] = "test_iowrapper.bin";
+
+const double quantum = 0.001;
+
+const int marker = 12345;
+
+
+int round_trip(const unsigned n, const unsigned D)
+{
+    double src[3*16], dst[3*16];
+    for ( unsigned i = 0; i < n * D; ++i )
+        src[i] = 0.25 * i - 1.5 + 0.0001 * ( i % 3 );
+
+    OutputWrapper out(file_name, false, true);
+    out.quantum(quantum);
+    out.writeDeltaVector(src, n, D);
+    out.writeVarInt(marker);
+    out.writeDeltaVector(src, n, D);
+    out.writeVarInt(-marker);
+    out.close();
+
+    InputWrapper in(file_name, true);
+    in.inputDIM(D);
+    in.quantum(quantum);
+    for ( int r = 0; r < 2; ++r )
+    {
+        in.readDeltaVector(dst, n, D);
+        int64_t m = in.readVarInt();
+        if ( m != ( r ? -marker : marker ) )
+        {
+            printf("n = %u D = %u : marker %i read as %li\n", n, D, marker, (long)m);
+            return 1;
+        }
+        for ( unsigned i = 0; i < n * D; ++i )
+        {
+            if ( fabs(dst[i] - src[i]) > quantum )
+            {
+                printf("n = %u D = %u : value %u is %f instead of %f\n", n, D, i, dst[i], src[i]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int err = 0;
+    try {
+        for ( unsigned D = 1; D <= 3; ++D )
+        {
+            err |= round_trip(0, D);
+            err |= round_trip(1, D);
+            err |= round_trip(16, D);
+        }
+    }
+    catch( Exception & e )
+    {
+        printf("Error: %s\n", e.what());
+        err = 1;
+    }
+    remove(file_name);
+    printf(err ? "test_iowrapper: FAILED\n" : "test_iowrapper: passed\n");
+    return err;
+}
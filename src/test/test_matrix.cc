@@ -0,0 +1,203 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+/*
+ Compares the sparse matrix formats that can be used in Meca,
+ by filling them with the same random elements, checking that they
+ give the same results, and timing the multiplications.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "real.h"
+#include "random.h"
+#include "tictoc.h"
+#include "matsparsesym1.h"
+#include "matsparsesymblk.h"
+
+extern Random RNG;
+
+/// number of multiplications done to time each format
+const int repeat = 64;
+
+
+/// the interactions between points: a chain of neighbors, and random links
+void makeLinks(unsigned nbp, unsigned nbl, unsigned*& ii, unsigned*& jj, unsigned& cnt)
+{
+    cnt = ( nbp - 1 ) + nbl;
+    ii = new unsigned[cnt];
+    jj = new unsigned[cnt];
+    for ( unsigned n = 0; n+1 < nbp; ++n )
+    {
+        ii[n] = n;
+        jj[n] = n+1;
+    }
+    for ( unsigned n = nbp-1; n < cnt; ++n )
+    {
+        ii[n] = RNG.pint_exc(nbp);
+        jj[n] = RNG.pint_exc(nbp);
+    }
+}
+
+
+/// fill the matrix of size D*nbp, with dense DxD blocks for each link
+template < typename MATRIX >
+void fill(MATRIX& mat, unsigned D, unsigned nbp, const unsigned* ii, const unsigned* jj, unsigned cnt)
+{
+    mat.allocate(D*nbp);
+    mat.makeZero();
+
+    for ( unsigned p = 0; p < nbp; ++p )
+        for ( unsigned a = 0; a < D; ++a )
+            mat(D*p+a, D*p+a) -= 1.0;
+
+    for ( unsigned n = 0; n < cnt; ++n )
+    {
+        if ( ii[n] == jj[n] )
+            continue;
+        for ( unsigned a = 0; a < D; ++a )
+            for ( unsigned b = 0; b < D; ++b )
+            {
+                // same random value for all matrices:
+                real v = 0.01 * ( ( 7 * n + 3 * a + b ) % 17 );
+                mat(D*ii[n]+a, D*jj[n]+b) += v;
+                if ( a <= b )
+                {
+                    mat(D*ii[n]+a, D*ii[n]+b) -= v;
+                    mat(D*jj[n]+a, D*jj[n]+b) -= v;
+                }
+            }
+    }
+    mat.prepareForMultiply();
+}
+
+
+real difference(unsigned size, const real* X, const real* Y)
+{
+    real res = 0;
+    for ( unsigned n = 0; n < size; ++n )
+    {
+        real d = X[n] - Y[n];
+        if ( d < 0 ) d = -d;
+        if ( d > res ) res = d;
+    }
+    return res;
+}
+
+
+/// time `repeat` multiplications using function `func` of the matrix
+template < typename MATRIX >
+double time(MATRIX const& mat, void (MATRIX::*func)(const real*, real*) const,
+            const real* X, real* Y, unsigned size)
+{
+    for ( unsigned n = 0; n < size; ++n )
+        Y[n] = 0;
+    TicToc::tic();
+    for ( int r = 0; r < repeat; ++r )
+        (mat.*func)(X, Y);
+    return TicToc::toc();
+}
+
+
+/// compare the matrices used for mC, of size DIM * nbp
+template < unsigned D >
+void testMatrix(unsigned nbp, unsigned nbl)
+{
+    unsigned *ii, *jj, cnt;
+    makeLinks(nbp, nbl, ii, jj, cnt);
+
+    const unsigned size = D * nbp;
+    real * X = new real[size];
+    real * Y = new real[size];
+    real * Z = new real[size];
+    for ( unsigned n = 0; n < size; ++n )
+        X[n] = RNG.sreal();
+
+    MatrixSparseSymmetric1 mat1;
+    MatrixSparseSymmetricBlock<D> matB;
+
+    fill(mat1, D, nbp, ii, jj, cnt);
+    fill(matB, D, nbp, ii, jj, cnt);
+
+    double t1 = time(mat1, &MatrixSparseSymmetric1::vecMulAdd, X, Y, size);
+    double tB = time(matB, &MatrixSparseSymmetricBlock<D>::vecMulAdd, X, Z, size);
+
+    printf("DIM %u  %-32s %8.0f ms\n", D, mat1.what().c_str(), t1);
+    printf("DIM %u  %-32s %8.0f ms  error %.2e\n", D, matB.what().c_str(), tB, difference(size, Y, Z));
+
+    delete[] X;
+    delete[] Y;
+    delete[] Z;
+    delete[] ii;
+    delete[] jj;
+}
+
+
+/// compare the matrices used for mB, of size nbp, with isotropic multiplication
+template < unsigned D >
+void testMatrixIso(unsigned nbp, unsigned nbl)
+{
+    unsigned *ii, *jj, cnt;
+    makeLinks(nbp, nbl, ii, jj, cnt);
+
+    const unsigned size = D * nbp;
+    real * X = new real[size];
+    real * Y = new real[size];
+    real * Z = new real[size];
+    for ( unsigned n = 0; n < size; ++n )
+        X[n] = RNG.sreal();
+
+    MatrixSparseSymmetric1 mat1;
+    MatrixSparseSymmetricBlock<1> matB;
+
+    fill(mat1, 1, nbp, ii, jj, cnt);
+    fill(matB, 1, nbp, ii, jj, cnt);
+
+    double t1, tB;
+    if ( D == 2 )
+    {
+        t1 = time(mat1, &MatrixSparseSymmetric1::vecMulAddIso2D, X, Y, size);
+        tB = time(matB, &MatrixSparseSymmetricBlock<1>::vecMulAddIso2D, X, Z, size);
+    }
+    else
+    {
+        t1 = time(mat1, &MatrixSparseSymmetric1::vecMulAddIso3D, X, Y, size);
+        tB = time(matB, &MatrixSparseSymmetricBlock<1>::vecMulAddIso3D, X, Z, size);
+    }
+
+    printf("Iso%uD   %-32s %8.0f ms\n", D, mat1.what().c_str(), t1);
+    printf("Iso%uD   %-32s %8.0f ms  error %.2e\n", D, matB.what().c_str(), tB, difference(size, Y, Z));
+
+    delete[] X;
+    delete[] Y;
+    delete[] Z;
+    delete[] ii;
+    delete[] jj;
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned nbp = 20000;
+    unsigned nbl = 20000;
+
+    if ( argc > 1 ) nbp = strtoul(argv[1], 0, 10);
+    if ( argc > 2 ) nbl = strtoul(argv[2], 0, 10);
+
+    if ( nbp < 2 )
+    {
+        printf("Usage: test_matrix NB_POINTS NB_LINKS\n");
+        return EXIT_FAILURE;
+    }
+
+    RNG.seedTimer();
+    printf("%u points, %u links, %i multiplications\n", nbp, nbl, repeat);
+
+    testMatrixIso<2>(nbp, nbl);
+    testMatrixIso<3>(nbp, nbl);
+    testMatrix<2>(nbp, nbl);
+    testMatrix<3>(nbp, nbl);
+
+    return EXIT_SUCCESS;
+}
+
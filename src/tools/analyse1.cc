@@ -12,12 +12,13 @@
 #include "messages.h"
 #include "parser.h"
 #include "simul.h"
+#include "parallel_frames.h"
 
 Simul simul;
 
 //------------------------------------------------------------------------------
 
-void analyse(std::ostream& os, std::string const& what, Glossary& opt, int frm)
+void analyse(std::ostream& os, std::string const& what, int frm, Glossary& opt)
 {
     os << "% frame " << frm << std::endl;
     os << "% time " << simul.simTime() << std::endl;
@@ -32,11 +33,12 @@ void help(std::ostream& os)
     os << "Generate reports/statistics on the simulation objects\n";
     os << "\n";
     os << "Syntax:\n";
-    os << "       analyse WHAT [prefix='time'] [frame=INTEGER]\n";
+    os << "       analyse WHAT [prefix='time'] [frame=INTEGER] [threads=INTEGER]\n";
     os << "\n";
     os << "Analyse will generate the same reports as Simul::report()\n";
     os << "The documentation of Simul::report() has a list of possible values for WHAT\n";
     os << "\n";
+    os << "With `threads=N`, the frames are processed by N processes in parallel\n";
     os << "The report is send to the standard output";
     
     os << std::endl;
@@ -68,18 +70,27 @@ int main(int argc, char* argv[])
         reader.openFile(simul.prop->trajectory_file);
         
         int frame = 0;
+        unsigned threads = 1;
+        opt.set(threads, "threads");
         if ( opt.set(frame, "frame") )
         {
             if ( 0 == reader.readFrame(simul, frame) )
-                analyse(std::cout, what, opt, frame);
+                analyse(std::cout, what, frame, opt);
             else
                 std::cerr << "Error: missing frame " << frame << std::endl;
         }
+        else if ( threads > 1 )
+        {
+            std::vector<int> list(countFrames(reader));
+            for ( size_t i = 0; i < list.size(); ++i )
+                list[i] = i;
+            processFrames(simul, simul.prop->trajectory_file, list, threads, analyse, what, opt, std::cout);
+        }
         else
         {
             while ( 0 == reader.readNextFrame(simul) )
             {
-                analyse(std::cout, what, opt, frame);
+                analyse(std::cout, what, frame, opt);
                 ++frame;
             }
         }
@@ -16,6 +16,7 @@
 #include <cstdlib>
 #include <sys/types.h>
 #include "iowrapper.h"
+#include "frame_index.h"
 
 enum { SKIP, COPY, LAST };
 
@@ -128,6 +129,27 @@ void extract(FILE* file, const int action[], int max)
 }
 
 
+/**
+ copy the frames specified in `action[]`, using the index to locate them
+ */
+void extractIndexed(FILE* file, FrameIndex const& index, const int action[], int max)
+{
+    for ( int f = 0; f < max && f < (int)index.size(); ++f )
+    {
+        if ( action[f] == LAST )
+            return;
+        if ( action[f] == SKIP )
+            continue;
+        
+        clearerr(file);
+        fseeko(file, index[f].offset, SEEK_SET);
+        // copy the lines until the end of the frame:
+        while ( !feof(file) && 2 != whatline(file, true) );
+        printf("\n");
+    }
+}
+
+
 void extractLast(FILE* file)
 {
     fpos_t pos, start;
@@ -172,6 +194,10 @@ void help()
     printf("    START:INCREMENT:END\n");
     printf("    START:INCREMENT:\n");
     printf("    last\n");
+    printf("The index file of the trajectory can be rebuilt with:\n");
+    printf("    frametool FILENAME index\n");
+    printf("If the index file is valid, it is used to locate the frames\n");
+    printf("A frame marked `#delta' is incomplete without the frames preceding it\n");
     printf("Examples:\n");
     printf("    frametool objects.cmo 0:2:\n");
     printf("    frametool objects.cmo 0:10\n");
@@ -280,10 +306,16 @@ int main(int argc, char* argv[])
     
     filename = argv[1];
     int mode = SKIP;
+    bool make_index = false;
     
     //get the list of frame from the command line arguments:
     for ( int ar = 2; ar < argc; ++ar )
     {
+        if ( 0 == strcmp(argv[ar], "index") )
+        {
+            make_index = true;
+            continue;
+        }
         if ( parse(argv[ar], mode, action, MAX_FRAME) )
         {
             printf("Unexpected command line argument `%s'\n", argv[ar]);
@@ -316,6 +348,21 @@ int main(int argc, char* argv[])
     }
 
     //----------------------------------------------
+    FrameIndex index;
+    
+    if ( make_index )
+    {
+        index.build(file, "#Cytosim ");
+        index.save(filename);
+        printf("indexed %lu frames in `%s'\n", index.size(), FrameIndex::path(filename).c_str());
+        fclose(file);
+        return EXIT_SUCCESS;
+    }
+    
+    // use the index only if it matches the file:
+    if ( index.load(filename) || index.check(file, "#Cytosim ") )
+        index.clear();
+
     switch(mode)
     {
         case SKIP:
@@ -323,10 +370,16 @@ int main(int argc, char* argv[])
             break;
             
         case COPY:
-            extract(file, action, MAX_FRAME);
+            if ( index.size() )
+                extractIndexed(file, index, action, MAX_FRAME);
+            else
+                extract(file, action, MAX_FRAME);
             break;
             
         case LAST:
+            // the search can start from the last frame of the index:
+            if ( index.size() )
+                fseeko(file, index[index.size()-1].offset, SEEK_SET);
             extractLast(file);
             break;
     }
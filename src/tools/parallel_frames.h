@@ -0,0 +1,140 @@
+// Cytosim was created by Francois Nedelec. Copyright 2007-2017 EMBL.
+
+#ifndef PARALLEL_FRAMES_H
+#define PARALLEL_FRAMES_H
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <climits>
+#include <cstdio>
+#include <vector>
+#include <sstream>
+#include "frame_reader.h"
+#include "glossary.h"
+#include "simul.h"
+
+
+/// function called for every frame: output, what, frame index, options
+typedef void (*FrameFunc)(std::ostream&, std::string const&, int, Glossary&);
+
+
+/// return the number of frames in the file opened by `reader`
+inline int countFrames(FrameReader& reader)
+{
+    reader.seekFrame(INT_MAX);
+    return 1 + reader.lastFrame();
+}
+
+
+/// process frames specified in `list`, using `nb_workers` processes
+/**
+ The frames are divided in contiguous slices, and each slice is processed by a
+ separate process, which opens the trajectory `file` with its own FrameReader,
+ reads the frames into `sim` and calls `func` for each of them.
+ Each worker writes to a temporary file, and the outputs are copied to `out`
+ in the order of `list`, such that the result is identical to a sequential run.
+
+ Processes are used rather than threads, because the objects read from a file
+ use global variables such as the random number generator.
+ Every worker reads the frames preceding its slice that are needed
+ to reconstruct the first frame (see FrameReader).
+
+ @returns the number of frames processed without error, from the start of `list`
+ */
+inline size_t processFrames(Simul& sim, std::string file, std::vector<int> const& list, unsigned nb_workers,
+                            FrameFunc func, std::string const& what, Glossary& opt, std::ostream& out)
+{
+    const size_t cnt = list.size();
+    if ( nb_workers > cnt )
+        nb_workers = cnt;
+    if ( nb_workers < 1 )
+        return 0;
+
+    std::vector<FILE*> tmp(nb_workers, (FILE*)0);
+    std::vector<pid_t> pid(nb_workers, (pid_t)-1);
+
+    // number of frames processed by each worker, in memory shared with the workers:
+    void * mem = mmap(0, nb_workers*sizeof(size_t), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if ( mem == MAP_FAILED )
+        return 0;
+    size_t * done = static_cast<size_t*>(mem);
+
+    // any buffered output would be duplicated in the workers:
+    out.flush();
+    fflush(0);
+
+    for ( unsigned w = 0; w < nb_workers; ++w )
+    {
+        const size_t start = ( cnt * w ) / nb_workers;
+        const size_t stop = ( cnt * ( w + 1 ) ) / nb_workers;
+
+        tmp[w] = tmpfile();
+        if ( !tmp[w] )
+            break;
+
+        pid[w] = fork();
+        if ( pid[w] == 0 )
+        {
+            int res = 0;
+            try {
+                FrameReader reader;
+                reader.openFile(file);
+                for ( size_t i = start; i < stop; ++i )
+                {
+                    if ( reader.readFrame(sim, list[i]) )
+                    {
+                        res = 1;
+                        break;
+                    }
+                    std::ostringstream oss;
+                    func(oss, what, list[i], opt);
+                    std::string const& str = oss.str();
+                    fwrite(str.data(), 1, str.size(), tmp[w]);
+                    ++done[w];
+                }
+            }
+            catch( Exception & e )
+            {
+                std::cerr << "Error: " << e.what() << '\n';
+                res = 2;
+            }
+            fclose(tmp[w]);
+            _exit(res);
+        }
+        if ( pid[w] < 0 )
+            break;
+    }
+
+    // collect the results in order, stopping at the first error:
+    size_t res = 0;
+    bool good = true;
+    char buf[65536];
+    for ( unsigned w = 0; w < nb_workers; ++w )
+    {
+        int status = 1;
+        if ( 0 < pid[w] )
+            waitpid(pid[w], &status, 0);
+        if ( good && tmp[w] )
+        {
+            rewind(tmp[w]);
+            size_t n;
+            while ( 0 < ( n = fread(buf, 1, sizeof(buf), tmp[w]) ) )
+                out.write(buf, n);
+        }
+        if ( good )
+        {
+            res += done[w];
+            good = ( WIFEXITED(status) && 0 == WEXITSTATUS(status) );
+        }
+        if ( tmp[w] )
+            fclose(tmp[w]);
+    }
+    munmap(mem, nb_workers*sizeof(size_t));
+    out.flush();
+    return res;
+}
+
+
+#endif
+
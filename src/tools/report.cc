@@ -14,6 +14,8 @@
 #include "messages.h"
 #include "parser.h"
 #include "simul.h"
+#include "parallel_frames.h"
+#include "column_table.h"
 
 Simul simul;
 int verbose = 1;
@@ -41,6 +43,8 @@ void help(std::ostream& os)
     os << "       period=INTEGER\n";
     os << "       input=FILE_NAME\n";
     os << "       output=FILE_NAME\n";
+    os << "       threads=INTEGER\n";
+    os << "       binary=1\n";
     os << "\n";
     os << "  This tool must be invoked in a directory containing the simulation output,\n";
     os << "  and it will generate reports by calling Simul::report(). The only required\n";
@@ -50,12 +54,19 @@ void help(std::ostream& os)
     os << "  or multiple indices can be specified (the first frame has index 0).\n";
     os << "  The input trajectory file is `objects.cmo` unless otherwise specified.\n";
     os << "  The result is sent to standard output unless a file is specified as `output`\n";
+    os << "  With `threads=N`, the frames are divided among N processes, which each read\n";
+    os << "  the trajectory file independently, and the output is merged in frame order.\n";
+    os << "  With `binary=1`, the data is written in a binary columnar format (see ColumnTable),\n";
+    os << "  with one batch per frame, and a first column containing the frame index.\n";
+    os << "  This is supported for reports that list objects, such as fiber:points.\n";
     os << "  Attention: there should be no whitespace in any of the option.\n";
     os << "\n";
     os << "Examples:\n";
     os << "       report fiber:points\n";
     os << "       report fiber:points frame=10 > fibers.txt\n";
     os << "       report fiber:points frame=10,20 > fibers.txt\n";
+    os << "       report fiber:points threads=8 > fibers.txt\n";
+    os << "       report fiber:points binary=1 output=fibers.bin\n";
 }
 
 //------------------------------------------------------------------------------
@@ -111,6 +122,24 @@ void report(std::ostream& os, std::string const& what, int frm, Glossary& opt)
 }
 
 
+/// write the data of the report as one batch of a ColumnTable
+void report_table(std::ostream& os, std::string const& what, int frm, Glossary& opt)
+{
+    try
+    {
+        ColumnTable tab;
+        simul.report(tab, what, opt);
+        tab.prependColumn("frame", frm);
+        tab.write(os);
+    }
+    catch( Exception & e )
+    {
+        std::cerr << "Aborted: " << e.what() << '\n';
+        exit(EXIT_FAILURE);
+    }
+}
+
+
 //------------------------------------------------------------------------------
 
 
@@ -140,10 +169,18 @@ int main(int argc, char* argv[])
     
     unsigned frame = 0;
     unsigned period = 1;
+    unsigned threads = 1;
+    bool binary = false;
     
     arg.set(input, ".cmo") || arg.set(input, "input");;
     arg.set(verbose, "verbose");
     arg.set(period, "period");
+    arg.set(threads, "threads");
+    arg.set(binary, "binary");
+    
+    FrameFunc func = ( binary ? report_table : report );
+    if ( period < 1 )
+        period = 1;
     
     FrameReader reader;
     RNG.seedTimer();
@@ -162,7 +199,7 @@ int main(int argc, char* argv[])
     if ( arg.set(str, "output") )
     {
         try {
-            ofs.open(str.c_str());
+            ofs.open(str.c_str(), binary ? std::ios::binary : std::ios::out);
         }
         catch( ... )
         {
@@ -175,6 +212,39 @@ int main(int argc, char* argv[])
     Cytosim::silent();
     
     
+    if ( threads > 1 )
+    {
+        std::vector<int> list;
+        if ( arg.has_key("frame") )
+        {
+            unsigned s = 0;
+            while ( arg.set(frame, "frame", s) )
+            {
+                list.push_back(frame);
+                ++s;
+            }
+        }
+        else
+        {
+            int cnt = countFrames(reader);
+            for ( int f = 0; f < cnt; f += period )
+                list.push_back(f);
+        }
+        
+        size_t done = processFrames(simul, input, list, threads, func, what, arg, *osp);
+        
+        if ( done < list.size() && arg.has_key("frame") )
+        {
+            std::cerr << "Error: missing frame " << list[done] << '\n';
+            return EXIT_FAILURE;
+        }
+        
+        // options are used by the workers, and cannot be checked here:
+        if ( ofs.is_open() )
+            ofs.close();
+        return EXIT_SUCCESS;
+    }
+    
     if ( arg.has_key("frame") )
     {
         // multiple frame indices can be specified:
@@ -183,7 +253,7 @@ int main(int argc, char* argv[])
         {
             // try to load the specified frame:
             if ( 0 == reader.readFrame(simul, frame) )
-                report(*osp, what, frame, arg);
+                func(*osp, what, frame, arg);
             else
             {
                 std::cerr << "Error: missing frame " << frame << '\n';
@@ -198,7 +268,7 @@ int main(int argc, char* argv[])
         while ( 0 == reader.readNextFrame(simul) )
         {
             if ( 0 == frame % period )
-                report(*osp, what, frame, arg);
+                func(*osp, what, frame, arg);
             ++frame;
         }
     }